@@ -0,0 +1,91 @@
+// Cancel-heavy order flow: 70% of events cancel, amend or replace a
+// resting order picked at random, the rest submit new limit orders.
+// Cancels outpace new orders, so the book is seeded deep enough that it
+// still holds orders when the run ends; every cancel resolves through
+// the order id index.
+// Usage: CancelFlowBench [events]    (target: at least 1M events/s)
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "../services/OrderBook.h"
+
+int main(int argc, char* argv[]) {
+    const int events = argc > 1 ? std::atoi(argv[1]) : 5000000;
+    const Price mid = FixedPoint::fromUnits(100);
+    
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> offset(-50, 50);
+    std::uniform_int_distribution<int> quantity(1, 100);
+    
+    OrderBook book(0);
+    std::vector<OrderBook::Fill> fills;
+    fills.reserve(1024);
+    std::vector<uint64_t> live; // Ids that may still rest; stale ids just miss
+    live.reserve(static_cast<size_t>(events));
+    uint64_t nextId = 1;
+    long submits = 0;
+    long cancels = 0;
+    long amends = 0;
+    long replaces = 0;
+    long misses = 0;
+    
+    // Seed the book so the cancels have something to hit throughout
+    for (int i = 0; i < events / 2; i++) {
+        fills.clear();
+        OrderSide side = (rng() & 1) ? OrderSide::Buy : OrderSide::Sell;
+        Price away = 51 + offset(rng); // Never crosses while seeding
+        Price limit = side == OrderSide::Buy ? mid - away : mid + away;
+        book.submit(nextId, side, limit, quantity(rng), OrderBook::NONE, true, fills);
+        live.push_back(nextId++);
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < events; i++) {
+        fills.clear();
+        unsigned action = rng() % 100;
+        
+        if (action >= 70 || live.empty()) {
+            OrderSide side = (rng() & 1) ? OrderSide::Buy : OrderSide::Sell;
+            Price limit = mid + (side == OrderSide::Buy ? offset(rng) - 10 : offset(rng) + 10);
+            if (book.submit(nextId, side, limit, quantity(rng), OrderBook::NONE, true, fills) > 0) {
+                live.push_back(nextId);
+            }
+            nextId++;
+            submits++;
+            continue;
+        }
+        
+        // Swap-remove the victim so picking one stays O(1)
+        size_t pick = rng() % live.size();
+        uint64_t victim = live[pick];
+        live[pick] = live.back();
+        live.pop_back();
+        
+        bool hit;
+        if (action < 50) {
+            hit = book.cancel(victim);
+            cancels++;
+        } else if (action < 60) {
+            hit = book.amend(victim, book.getRestingQuantity(victim) / 2);
+            if (hit && book.isResting(victim)) live.push_back(victim);
+            amends++;
+        } else {
+            Price limit = mid + offset(rng);
+            int32_t left = book.replace(victim, nextId, limit, quantity(rng), fills);
+            hit = left >= 0;
+            if (left > 0) live.push_back(nextId);
+            nextId++;
+            replaces++;
+        }
+        if (!hit) misses++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::printf("CancelFlowBench: %d events (%ld submit, %ld cancel, %ld amend, %ld replace), "
+                "%ld missed, %zu resting\n", events, submits, cancels, amends, replaces, misses,
+                book.getRestingOrderCount());
+    std::printf("  %.2f s, %.0f events/s (target 1000000)\n", seconds, events / seconds);
+    return 0;
+}
@@ -0,0 +1,39 @@
+// Order book matching throughput: random limit orders around a fixed mid,
+// so roughly half cross the spread and the rest rest in the book.
+// Usage: OrderBookBench [orders]    (target: at least 1M orders/s)
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "../services/OrderBook.h"
+
+int main(int argc, char* argv[]) {
+    const int orders = argc > 1 ? std::atoi(argv[1]) : 5000000;
+    const Price mid = FixedPoint::fromUnits(100);
+    
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> offset(-50, 50);
+    std::uniform_int_distribution<int> quantity(1, 100);
+    
+    OrderBook book(0);
+    std::vector<OrderBook::Fill> fills;
+    fills.reserve(1024);
+    long fillCount = 0;
+    
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < orders; i++) {
+        fills.clear();
+        OrderSide side = (rng() & 1) ? OrderSide::Buy : OrderSide::Sell;
+        Price limit = mid + (side == OrderSide::Buy ? offset(rng) - 10 : offset(rng) + 10);
+        book.submit(static_cast<uint64_t>(i), side, limit, quantity(rng), OrderBook::NONE, true,
+                    fills);
+        fillCount += static_cast<long>(fills.size());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::printf("OrderBookBench: %d orders, %ld fills, %zu resting\n", orders, fillCount,
+                book.getRestingOrderCount());
+    std::printf("  %.2f s, %.0f orders/s (target 1000000)\n", seconds, orders / seconds);
+    return 0;
+}
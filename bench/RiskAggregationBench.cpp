@@ -0,0 +1,122 @@
+// Firm-wide risk aggregation by thread count: 100k accounts holding up to
+// 20 of 500 symbols, aggregated on 1, 2, 4, ... threads and checked
+// against the single-threaded report. Then the admin statistics load:
+// `files` saved portfolios read back in parallel through FileHandler.
+// Usage: RiskAggregationBench [accounts] [maxThreads] [files]
+//        (target: load and aggregate 100k accounts in under a second)
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../services/RiskAggregator.h"
+#include "../utils/FileHandler.h"
+
+namespace {
+    bool sameReport(const FirmRiskReport& a, const FirmRiskReport& b) {
+        if (a.grossExposure != b.grossExposure || a.netExposure != b.netExposure ||
+            a.profitLoss != b.profitLoss || a.cash != b.cash ||
+            a.symbols.size() != b.symbols.size() || a.topAccounts.size() != b.topAccounts.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < a.symbols.size(); i++) {
+            if (a.symbols[i].symbolId != b.symbols[i].symbolId ||
+                a.symbols[i].grossExposure != b.symbols[i].grossExposure) return false;
+        }
+        for (size_t i = 0; i < a.topAccounts.size(); i++) {
+            if (a.topAccounts[i].userId != b.topAccounts[i].userId) return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t accounts = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const size_t maxThreads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 32;
+    const size_t files = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 10000;
+    const int SYMBOLS = 500;
+    const int RUNS = 5;
+    
+    std::vector<SymbolId> symbols;
+    for (int i = 0; i < SYMBOLS; i++) {
+        symbols.push_back(SymbolTable::instance().intern("RSK" + std::to_string(i)));
+    }
+    std::mt19937 rng(5);
+    std::vector<Price> prices(symbols.back() + 1, 0);
+    for (SymbolId symbol : symbols) {
+        prices[symbol] = FixedPoint::fromUnits(10 + rng() % 200);
+    }
+    
+    std::vector<std::unique_ptr<Trader>> traders;
+    traders.reserve(accounts);
+    for (size_t i = 0; i < accounts; i++) {
+        traders.emplace_back(new Trader("risk" + std::to_string(i), "pw",
+                                        FixedPoint::fromUnits(1000000)));
+        Portfolio& portfolio = traders.back()->getPortfolio();
+        int held = static_cast<int>(rng() % 20);
+        for (int k = 0; k < held; k++) {
+            SymbolId symbol = symbols[rng() % SYMBOLS];
+            portfolio.buyStock(symbol, 1 + static_cast<int>(rng() % 100),
+                               prices[symbol] - FixedPoint::fromUnits(rng() % 5));
+        }
+    }
+    std::vector<const Portfolio*> portfolios;
+    for (const auto& trader : traders) {
+        portfolios.push_back(&trader->getPortfolio());
+    }
+    
+    std::printf("RiskAggregationBench: %zu accounts, %d symbols, %u hardware threads\n",
+                accounts, SYMBOLS, std::thread::hardware_concurrency());
+    
+    FirmRiskReport reference;
+    double baseline = 0;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        RiskAggregator aggregator(threads);
+        FirmRiskReport report;
+        
+        auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < RUNS; run++) {
+            aggregator.aggregate(portfolios, prices, report, 10);
+        }
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count() / RUNS;
+        
+        if (threads == 1) {
+            reference = report;
+            baseline = ms;
+        }
+        std::printf("  %2zu threads: %7.2f ms, %.2fx, %s\n", threads, ms, baseline / ms,
+                    sameReport(report, reference) ? "matches 1 thread" : "DIFFERS from 1 thread");
+    }
+    
+    // Saved portfolio load, as the statistics screen does it
+    if (files > 0) {
+        const std::string directory = "bench_data";
+        FileHandler fileHandler(directory);
+        size_t count = std::min(files, accounts);
+        std::vector<Trader*> loading;
+        for (size_t i = 0; i < count; i++) {
+            fileHandler.savePortfolio(*traders[i]);
+            loading.push_back(traders[i].get());
+        }
+        
+        std::vector<Trader*> failed;
+        auto start = std::chrono::steady_clock::now();
+        size_t read = fileHandler.readPortfolios(loading, failed);
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+        std::printf("  read %zu of %zu saved portfolios in %.2f ms (%zu failed)\n", read, count,
+                    ms, failed.size());
+        
+        for (size_t i = 0; i < count; i++) {
+            std::remove((directory + "/portfolio_" + traders[i]->getUsername() + ".txt").c_str());
+        }
+        std::remove(directory.c_str());
+    }
+    return 0;
+}
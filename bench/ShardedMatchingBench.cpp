@@ -0,0 +1,86 @@
+// Sharded matching throughput by shard count. The same random limit order
+// stream over 64 symbols is routed through 1, 2, 4, ... shards and checked
+// against one single-threaded OrderBook per symbol.
+// Usage: ShardedMatchingBench [orders] [maxShards]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "../services/ShardedMatchingEngine.h"
+
+int main(int argc, char* argv[]) {
+    const size_t orders = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4000000;
+    const size_t maxShards = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 8;
+    const int SYMBOLS = 64;
+    
+    std::vector<std::string> tickers;
+    std::vector<SymbolId> symbols;
+    for (int i = 0; i < SYMBOLS; i++) {
+        tickers.push_back("SHD" + std::to_string(i));
+        symbols.push_back(SymbolTable::instance().intern(tickers.back()));
+    }
+    
+    std::mt19937 rng(12345);
+    std::vector<OrderRecord> stream(orders, OrderRecord());
+    for (size_t i = 0; i < orders; i++) {
+        OrderRecord& order = stream[i];
+        order.orderId = i + 1;
+        order.symbolId = symbols[rng() % SYMBOLS];
+        order.side = (rng() & 1) ? OrderSide::Buy : OrderSide::Sell;
+        order.price = FixedPoint::fromUnits(100) + static_cast<Price>(rng() % 20) * 100 - 1000;
+        order.quantity = 1 + static_cast<int32_t>(rng() % 100);
+    }
+    
+    // Reference: one book per symbol on this thread
+    std::vector<std::unique_ptr<OrderBook>> reference(symbols.back() + 1);
+    for (SymbolId symbol : symbols) {
+        reference[symbol].reset(new OrderBook(symbol));
+    }
+    std::vector<OrderBook::Fill> fills;
+    uint64_t referenceTrades = 0;
+    for (const OrderRecord& order : stream) {
+        fills.clear();
+        reference[order.symbolId]->submit(order.orderId, order.side, order.price, order.quantity,
+                                          OrderBook::NONE, true, fills);
+        referenceTrades += fills.size();
+    }
+    
+    std::printf("ShardedMatchingBench: %zu orders over %d symbols, %u hardware threads\n", orders,
+                SYMBOLS, std::thread::hardware_concurrency());
+    
+    double baseline = 0;
+    bool consistent = true;
+    for (size_t shardCount = 1; shardCount <= maxShards; shardCount *= 2) {
+        ShardedMatchingEngine engine(shardCount, 65536, false);
+        for (const std::string& ticker : tickers) {
+            engine.addSymbol(Stock(ticker, ticker, FixedPoint::fromUnits(100)));
+        }
+        engine.start();
+        
+        auto start = std::chrono::steady_clock::now();
+        for (const OrderRecord& order : stream) {
+            engine.submit(order);
+        }
+        engine.waitIdle();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        engine.stop();
+        
+        bool same = engine.getTradeCount() == referenceTrades;
+        for (SymbolId symbol : symbols) {
+            const OrderBook& book = *engine.findBook(symbol);
+            same = same && book.getRestingOrderCount() == reference[symbol]->getRestingOrderCount() &&
+                   book.getBestBid() == reference[symbol]->getBestBid() &&
+                   book.getBestAsk() == reference[symbol]->getBestAsk();
+        }
+        consistent = consistent && same;
+        
+        double rate = orders / seconds;
+        if (shardCount == 1) baseline = rate;
+        std::printf("  %2zu shards: %.2f s, %.2fM orders/s, %.2fx, %s\n", shardCount, seconds,
+                    rate / 1e6, rate / baseline, same ? "matches reference" : "MISMATCH");
+    }
+    
+    return consistent ? 0 : 1;
+}
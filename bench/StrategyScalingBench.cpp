@@ -0,0 +1,103 @@
+// Strategy evaluation scaling: every registered strategy over a 50k-symbol
+// universe through StrategyEngine::runAllStrategies() on 1, 2, 4, ... 32
+// threads. Each run's signals are checked against a serial evaluate() of
+// every strategy over all rows.
+// Usage: StrategyScalingBench [symbols] [maxThreads]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../services/StrategyEngine.h"
+#include "../models/Portfolio.h"
+
+namespace {
+    struct SignalKey {
+        SymbolId symbol;
+        OrderSide side;
+        int quantity;
+        Price price;
+    };
+    
+    bool matches(const std::vector<OrderPtr>& signals, const std::vector<SignalKey>& expected) {
+        if (signals.size() != expected.size()) return false;
+        for (size_t i = 0; i < signals.size(); i++) {
+            const Order& order = *signals[i];
+            if (order.getSymbolId() != expected[i].symbol || order.getSide() != expected[i].side ||
+                order.getQuantity() != expected[i].quantity || order.getPrice() != expected[i].price) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t symbols = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 50000;
+    const size_t maxThreads = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 32;
+    const int RUNS = 20;
+    
+    // A universe with enough history for every indicator window
+    std::cout.setstate(std::ios::failbit);
+    MarketDataStore market;
+    std::mt19937 rng(9);
+    for (size_t i = 0; i < symbols; i++) {
+        std::string ticker = "U" + std::to_string(i);
+        market.addSymbol(Stock(ticker, ticker, FixedPoint::fromUnits(50 + rng() % 300)));
+    }
+    for (int step = 0; step < 25; step++) {
+        for (size_t row = 0; row < market.size(); row++) {
+            Price price = market.getLastPrice(row);
+            Price move = static_cast<Price>(static_cast<int>(rng() % 2001) - 1000) * price / 100000;
+            market.updatePrice(row, price + move);
+        }
+    }
+    Portfolio portfolio("bench", FixedPoint::fromUnits(1000000000));
+    for (int i = 0; i < 3000; i++) {
+        size_t row = rng() % market.size();
+        portfolio.buyStock(market.getSymbolId(row), 10, market.getLastPrice(row));
+    }
+    
+    // Serial reference, in strategy order then row order
+    StrategyEngine reference(1);
+    std::vector<SignalKey> expected;
+    for (const auto& strategy : reference.getStrategies()) {
+        std::vector<StrategySignal> out;
+        strategy->evaluate(market, portfolio, 0, market.size(), out);
+        for (const StrategySignal& signal : out) {
+            expected.push_back({market.getSymbolId(signal.row), signal.side, signal.quantity,
+                                signal.price});
+        }
+    }
+    std::cout.clear();
+    
+    std::printf("StrategyScalingBench: %zu symbols, %zu strategies, %zu signals, "
+                "%u hardware threads\n", market.size(), reference.getStrategies().size(),
+                expected.size(), std::thread::hardware_concurrency());
+    
+    double baseline = 0;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        StrategyEngine engine(threads);
+        std::vector<OrderPtr> signals;
+        
+        std::cout.setstate(std::ios::failbit);
+        engine.runAllStrategies(market, portfolio, signals); // Warm the pools
+        bool same = matches(signals, expected);
+        auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < RUNS; run++) {
+            engine.runAllStrategies(market, portfolio, signals);
+            same = same && matches(signals, expected);
+        }
+        double ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count() / RUNS;
+        std::cout.clear();
+        
+        if (threads == 1) baseline = ms;
+        std::printf("  %2zu threads: %7.2f ms, %.2fx, %s\n", threads, ms, baseline / ms,
+                    same ? "matches serial" : "DIFFERS from serial");
+    }
+    return 0;
+}
@@ -4,17 +4,32 @@
 #include <memory>
 #include <limits>
 #include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <algorithm>
 
 #include "models/Stock.h"
 #include "models/Order.h"
+#include "models/OrderPool.h"
 #include "models/Portfolio.h"
+#include "models/PortfolioOverlay.h"
 #include "models/User.h"
 #include "services/TradingEngine.h"
 #include "services/StrategyEngine.h"
+#include "services/RiskAggregator.h"
+#include "services/ShardedMatchingEngine.h"
+#include "services/ExecutionScheduler.h"
+#include "services/DepthLadder.h"
 #include "utils/FileHandler.h"
 #include "utils/PriceSimulator.h"
 #include "utils/Colors.h"
 #include "utils/Console.h"
+#include "utils/SymbolTable.h"
+
+// Strategy orders above the trader's cap are sliced over this many steps
+const uint64_t TWAP_STEPS = 5;
 
 // Forward declarations
 void clearScreen();
@@ -23,9 +38,15 @@ void displayWelcome();
 User* authenticateUser(FileHandler& fileHandler);
 User* registerUser(FileHandler& fileHandler);
 void handleAdminSession(Admin* admin, TradingEngine& engine, PriceSimulator& simulator, 
-                        FileHandler& fileHandler, std::vector<std::unique_ptr<User>>& users);
+                        ExecutionScheduler& scheduler, FileHandler& fileHandler,
+                        std::vector<std::unique_ptr<User>>& users);
 void handleTraderSession(Trader* trader, TradingEngine& engine, StrategyEngine& strategyEngine,
+                         PriceSimulator& simulator, ExecutionScheduler& scheduler,
                          FileHandler& fileHandler);
+void advanceSchedules(ExecutionScheduler& scheduler, uint64_t time, FileHandler& fileHandler);
+void showStopExecutions(TradingEngine& engine);
+bool parseDate(const std::string& text, bool endOfDay, int64_t& time);
+void searchFills(const Portfolio& portfolio);
 
 // Utility functions
 void clearScreen() {
@@ -57,6 +78,93 @@ void displayWelcome() {
     std::cout << Colors::BOLD_CYAN << std::string(60, '=') << Colors::RESET << std::endl;
 }
 
+// Sends every scheduled child order that came due by `time` (simulation
+// steps), journals the children and parents that are done, and reports
+// the children and any parent orders that ended
+void advanceSchedules(ExecutionScheduler& scheduler, uint64_t time, FileHandler& fileHandler) {
+    std::vector<ExecutionResult> children;
+    std::vector<ExecutionScheduler::ParentStatus> finished;
+    std::vector<OrderRecord> records;
+    
+    scheduler.advanceTo(time);
+    scheduler.drainChildResults(children);
+    scheduler.drainCompleted(finished);
+    scheduler.drainOrderRecords(records);
+    fileHandler.journalOrders(records.data(), records.size());
+    
+    if (!children.empty()) {
+        std::cout << "\n=== SCHEDULED CHILD ORDERS ===" << std::endl;
+        TradingEngine::displayExecutionResults(children);
+    }
+    if (!finished.empty()) {
+        std::cout << "\n=== FINISHED PARENT ORDERS ===" << std::endl;
+        ExecutionScheduler::displayStatuses(finished);
+    }
+}
+
+// Reports the stop orders that the last price moves triggered
+void showStopExecutions(TradingEngine& engine) {
+    std::vector<ExecutionResult> executions;
+    if (engine.drainStopExecutions(executions) == 0) return;
+    
+    std::cout << "\n=== TRIGGERED STOP ORDERS ===" << std::endl;
+    TradingEngine::displayExecutionResults(executions);
+}
+
+// YYYY-MM-DD in local time, at the day's first or last second; * is open-ended
+bool parseDate(const std::string& text, bool endOfDay, int64_t& time) {
+    if (text == "*") {
+        time = endOfDay ? std::numeric_limits<int64_t>::max() : std::numeric_limits<int64_t>::min();
+        return true;
+    }
+    
+    int year, month, day;
+    char extra;
+    if (std::sscanf(text.c_str(), "%d-%d-%d%c", &year, &month, &day, &extra) != 3) {
+        return false;
+    }
+    
+    std::tm date = std::tm();
+    date.tm_year = year - 1900;
+    date.tm_mon = month - 1;
+    date.tm_mday = endOfDay ? day + 1 : day; // mktime normalizes the day after
+    date.tm_isdst = -1;
+    time_t start = std::mktime(&date);
+    if (start == static_cast<time_t>(-1)) {
+        return false;
+    }
+    
+    time = endOfDay ? static_cast<int64_t>(start) - 1 : static_cast<int64_t>(start);
+    return true;
+}
+
+void searchFills(const Portfolio& portfolio) {
+    std::string symbolText, fromText, toText;
+    std::cout << "\nSymbol (* for all): ";
+    std::cin >> symbolText;
+    std::cout << "From date (YYYY-MM-DD, * for the first fill): ";
+    std::cin >> fromText;
+    std::cout << "To date (YYYY-MM-DD, * for the latest fill): ";
+    std::cin >> toText;
+    
+    SymbolId symbol = INVALID_SYMBOL;
+    if (symbolText != "*") {
+        symbol = SymbolTable::instance().find(symbolText);
+        if (symbol == INVALID_SYMBOL) {
+            std::cout << "No fills in " << symbolText << "." << std::endl;
+            return;
+        }
+    }
+    
+    int64_t from, to;
+    if (!parseDate(fromText, false, from) || !parseDate(toText, true, to)) {
+        std::cout << "Dates must be YYYY-MM-DD." << std::endl;
+        return;
+    }
+    
+    portfolio.displayFills(symbol, from, to);
+}
+
 // Authentication
 User* authenticateUser(FileHandler& fileHandler) {
     std::string username, password;
@@ -125,7 +233,7 @@ User* registerUser(FileHandler& fileHandler) {
         newUser = new Admin(username, password);
         Console::printSuccess("Admin account created successfully! " + Symbol::ADMIN);
     } else {
-        newUser = new Trader(username, password, 100000.0);
+        newUser = new Trader(username, password, FixedPoint::fromUnits(100000));
         Console::printSuccess("Trader account created with $100,000 initial balance! " + Symbol::MONEY_BAG);
     }
     
@@ -135,7 +243,8 @@ User* registerUser(FileHandler& fileHandler) {
 
 // Admin session handler
 void handleAdminSession(Admin* admin, TradingEngine& engine, PriceSimulator& simulator,
-                        FileHandler& fileHandler, std::vector<std::unique_ptr<User>>& users) {
+                        ExecutionScheduler& scheduler, FileHandler& fileHandler,
+                        std::vector<std::unique_ptr<User>>& users) {
     bool running = true;
     
     while (running) {
@@ -156,8 +265,7 @@ void handleAdminSession(Admin* admin, TradingEngine& engine, PriceSimulator& sim
             
             case 2: { // Add new stock
                 clearScreen();
-                std::string symbol, name;
-                double price;
+                std::string symbol, name, price;
                 
                 std::cout << "=== ADD NEW STOCK ===" << std::endl;
                 std::cout << "Symbol: ";
@@ -168,7 +276,7 @@ void handleAdminSession(Admin* admin, TradingEngine& engine, PriceSimulator& sim
                 std::cout << "Initial Price: $";
                 std::cin >> price;
                 
-                Stock newStock(symbol, name, price);
+                Stock newStock(symbol, name, FixedPoint::parse(price));
                 engine.addStock(newStock);
                 fileHandler.saveStocks(engine);
                 
@@ -184,8 +292,15 @@ void handleAdminSession(Admin* admin, TradingEngine& engine, PriceSimulator& sim
                 std::cout << "\nEnter symbol to remove: ";
                 std::cin >> symbol;
                 
-                engine.removeStock(symbol);
-                fileHandler.saveStocks(engine);
+                // Look the ticker up rather than interning it, so a typo does
+                // not add a symbol to the table
+                SymbolId symbolId = SymbolTable::instance().find(symbol);
+                if (symbolId == INVALID_SYMBOL) {
+                    std::cout << Colors::ERROR << Symbols::CROSS << " Stock " << symbol
+                              << " not found." << Colors::RESET << std::endl;
+                } else if (engine.removeStock(symbolId)) {
+                    fileHandler.saveStocks(engine);
+                }
                 
                 pauseScreen();
                 break;
@@ -203,23 +318,26 @@ void handleAdminSession(Admin* admin, TradingEngine& engine, PriceSimulator& sim
                 std::cout << "\nChoice: ";
                 std::cin >> simChoice;
                 
-                auto& stocks = const_cast<std::map<std::string, Stock>&>(engine.getAllStocks());
+                MarketDataStore& market = engine.getMarket();
                 
                 switch (simChoice) {
                     case 1:
-                        simulator.simulateMarket(stocks);
+                        simulator.simulateMarket(market);
                         break;
                     case 2:
-                        simulator.simulateBullMarket(stocks);
+                        simulator.simulateBullMarket(market);
                         break;
                     case 3:
-                        simulator.simulateBearMarket(stocks);
+                        simulator.simulateBearMarket(market);
                         break;
                     case 4:
-                        simulator.simulateVolatileMarket(stocks);
+                        simulator.simulateVolatileMarket(market);
                         break;
                 }
                 
+                // Scheduled parent orders run on the simulation clock
+                showStopExecutions(engine);
+                advanceSchedules(scheduler, simulator.getStep(), fileHandler);
                 fileHandler.saveStocks(engine);
                 pauseScreen();
                 break;
@@ -241,6 +359,33 @@ void handleAdminSession(Admin* admin, TradingEngine& engine, PriceSimulator& sim
                 }
                 
                 std::cout << std::string(50, '=') << std::endl;
+                
+                std::cout << "\nSearch a trader's fills? (Enter username or 'n' to skip): ";
+                std::string username;
+                std::cin >> username;
+                
+                if (username != "n" && username != "N") {
+                    const Trader* found = nullptr;
+                    for (const auto& user : users) {
+                        if (user->getUsername() == username && user->getRole() == "TRADER") {
+                            found = dynamic_cast<const Trader*>(user.get());
+                        }
+                    }
+                    
+                    if (!found) {
+                        std::cout << "Trader " << username << " not found." << std::endl;
+                    } else {
+                        // Loading attaches the trader's history file,
+                        // whose index the search reads
+                        Trader trader(*found);
+                        if (fileHandler.loadPortfolio(trader)) {
+                            searchFills(trader.getPortfolio());
+                        } else {
+                            std::cout << "Could not load " << username << "'s portfolio." << std::endl;
+                        }
+                    }
+                }
+                
                 pauseScreen();
                 break;
             }
@@ -260,14 +405,217 @@ void handleAdminSession(Admin* admin, TradingEngine& engine, PriceSimulator& sim
                 std::cout << "Total Users: " << users.size() << std::endl;
                 std::cout << "  - Admins: " << adminCount << std::endl;
                 std::cout << "  - Traders: " << traderCount << std::endl;
-                std::cout << "Total Stocks: " << engine.getAllStocks().size() << std::endl;
+                std::cout << "Total Stocks: " << engine.getMarket().size() << std::endl;
+                std::cout << std::string(50, '=') << std::endl;
+                
+                // Firm-wide exposure over every trader's saved portfolio,
+                // read in parallel; unreadable portfolios are left out
+                std::vector<Trader*> traders;
+                traders.reserve(traderCount);
+                for (auto& user : users) {
+                    Trader* trader = dynamic_cast<Trader*>(user.get());
+                    if (trader) traders.push_back(trader);
+                }
+                
+                auto loadStart = std::chrono::steady_clock::now();
+                std::vector<Trader*> failed;
+                size_t loaded = fileHandler.readPortfolios(traders, failed);
+                auto loadEnd = std::chrono::steady_clock::now();
+                
+                std::vector<const Portfolio*> portfolios;
+                portfolios.reserve(traders.size());
+                for (Trader* trader : traders) {
+                    if (std::find(failed.begin(), failed.end(), trader) == failed.end()) {
+                        portfolios.push_back(&trader->getPortfolio());
+                    }
+                }
+                for (Trader* trader : failed) {
+                    std::cerr << "Error: Could not read the portfolio of " << trader->getUsername()
+                              << "; left out of the report." << std::endl;
+                }
+                
+                FirmRiskReport report;
+                RiskAggregator aggregator;
+                aggregator.aggregate(portfolios, engine.getCurrentPrices(), report, 5);
+                auto aggregateEnd = std::chrono::steady_clock::now();
+                
+                std::cout << "Loaded " << loaded << " saved portfolios ("
+                          << traders.size() - loaded - failed.size() << " never saved, "
+                          << failed.size() << " unreadable) in " << std::fixed << std::setprecision(2)
+                          << std::chrono::duration<double, std::milli>(loadEnd - loadStart).count()
+                          << " ms; aggregated on " << aggregator.getThreadCount() << " threads in "
+                          << std::chrono::duration<double, std::milli>(aggregateEnd - loadEnd).count()
+                          << " ms" << std::endl;
+                RiskAggregator::displayReport(report, 5);
+                
+                pauseScreen();
+                break;
+            }
+            
+            case 7: { // View order journal
+                clearScreen();
+                std::vector<OrderRecord> journal = fileHandler.loadOrderJournal();
+                
+                std::cout << "\n=== ORDER JOURNAL ===" << std::endl;
+                std::cout << std::string(80, '=') << std::endl;
+                std::cout << "Journaled orders: " << journal.size() << std::endl;
+                
+                // Executed buy and sell volume per symbol, in first-seen order;
+                // a scheduled parent's fills are counted on its children
+                std::vector<SymbolId> seen;
+                std::vector<int64_t> bought, sold;
+                for (const OrderRecord& record : journal) {
+                    if (record.flags & ORDER_FLAG_PARENT) continue;
+                    if (record.symbolId >= bought.size()) {
+                        bought.resize(record.symbolId + 1, -1);
+                        sold.resize(record.symbolId + 1, 0);
+                    }
+                    if (bought[record.symbolId] < 0) {
+                        bought[record.symbolId] = 0;
+                        seen.push_back(record.symbolId);
+                    }
+                    int64_t& volume = record.side == OrderSide::Buy ? bought[record.symbolId]
+                                                                    : sold[record.symbolId];
+                    volume += record.filledQuantity;
+                }
+                
+                std::cout << std::string(80, '-') << std::endl;
+                std::cout << std::left << std::setw(10) << "Symbol"
+                          << std::right << std::setw(14) << "Bought" << std::setw(14) << "Sold"
+                          << std::endl;
+                for (SymbolId symbol : seen) {
+                    std::cout << std::left << std::setw(10) << SymbolTable::instance().name(symbol)
+                              << std::right << std::setw(14) << bought[symbol]
+                              << std::setw(14) << sold[symbol] << std::endl;
+                }
+                
+                const size_t recentCount = 10;
+                size_t first = journal.size() > recentCount ? journal.size() - recentCount : 0;
+                std::cout << std::string(80, '-') << std::endl;
+                std::cout << "Most recent orders:" << std::endl;
+                for (size_t i = journal.size(); i > first; i--) {
+                    Order(journal[i - 1]).display();
+                    if (journal[i - 1].flags & ORDER_FLAG_PARENT) std::cout << "  PARENT";
+                    std::cout << std::endl;
+                }
+                std::cout << std::string(80, '=') << std::endl;
+                
+                char replay;
+                std::cout << "\nReplay the journal through the sharded matching engine? (y/n): ";
+                std::cin >> replay;
+                if (replay == 'y' || replay == 'Y') {
+                    // Journaled orders meet each other in fresh books, one
+                    // shard per hardware thread; delisted symbols are skipped,
+                    // as are scheduled parents, whose children are replayed
+                    ShardedMatchingEngine matcher;
+                    const MarketDataStore& market = engine.getMarket();
+                    for (size_t row = 0; row < market.size(); row++) {
+                        matcher.addSymbol(market.toStock(row));
+                    }
+                    matcher.start();
+                    
+                    size_t routed = 0;
+                    auto start = std::chrono::steady_clock::now();
+                    for (OrderRecord record : journal) {
+                        if (record.flags & ORDER_FLAG_PARENT) continue;
+                        record.filledQuantity = 0;
+                        if (matcher.submit(record)) routed++;
+                    }
+                    matcher.waitIdle();
+                    double elapsed = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start).count();
+                    matcher.stop();
+                    
+                    std::cout << "\nReplayed " << routed << " orders (" << journal.size() - routed
+                              << " skipped) on " << matcher.getShardCount() << " shards in "
+                              << std::fixed << std::setprecision(2) << elapsed << " ms: "
+                              << matcher.getTradeCount() << " trades" << std::endl;
+                    std::cout << std::left << std::setw(10) << "Symbol"
+                              << std::right << std::setw(12) << "Best Bid" << std::setw(12)
+                              << "Best Ask" << std::setw(10) << "Resting" << std::endl;
+                    for (SymbolId symbol : seen) {
+                        const OrderBook* book = matcher.findBook(symbol);
+                        if (!book) continue;
+                        std::cout << std::left << std::setw(10) << SymbolTable::instance().name(symbol)
+                                  << std::right << std::setw(12);
+                        if (book->hasBid()) std::cout << FixedPoint::toDouble(book->getBestBid());
+                        else std::cout << "-";
+                        std::cout << std::setw(12);
+                        if (book->hasAsk()) std::cout << FixedPoint::toDouble(book->getBestAsk());
+                        else std::cout << "-";
+                        std::cout << std::setw(10) << book->getRestingOrderCount() << std::endl;
+                    }
+                }
+                
+                pauseScreen();
+                break;
+            }
+            
+            case 8: { // Risk limits
+                clearScreen();
+                std::cout << "\n=== RISK LIMITS ===" << std::endl;
                 std::cout << std::string(50, '=') << std::endl;
+                std::cout << "Defaults for every trader:" << std::endl;
+                engine.getRiskGate().getDefaultLimits().display();
+                std::cout << std::string(50, '=') << std::endl;
+                
+                std::string username;
+                std::cout << "\nTrader username (or 'n' to go back): ";
+                std::cin >> username;
+                if (username == "n" || username == "N") break;
+                
+                users = fileHandler.loadAllUsers();
+                Trader* trader = nullptr;
+                for (auto& user : users) {
+                    if (user->getUsername() == username) trader = dynamic_cast<Trader*>(user.get());
+                }
+                if (!trader) {
+                    std::cout << "Trader " << username << " not found." << std::endl;
+                    pauseScreen();
+                    break;
+                }
+                
+                const Portfolio& portfolio = trader->getPortfolio();
+                std::cout << "\nLimits for " << username
+                          << (engine.hasRiskLimits(portfolio) ? ":" : " (defaults):") << std::endl;
+                engine.getRiskLimits(portfolio).display();
+                
+                int action;
+                std::cout << "\n1. Set limits\n2. Reset to defaults\n0. Back\nChoice: ";
+                std::cin >> action;
+                
+                if (action == 1) {
+                    // Applies at once if the trader is logged in, else at login
+                    std::string notional, gross;
+                    RiskLimits limits;
+                    std::cout << "Enter 0 to turn a limit off." << std::endl;
+                    std::cout << "Max order notional: $";
+                    std::cin >> notional;
+                    std::cout << "Max position (shares): ";
+                    std::cin >> limits.maxPosition;
+                    std::cout << "Max gross exposure: $";
+                    std::cin >> gross;
+                    std::cout << "Price band (bps): ";
+                    std::cin >> limits.priceBandBps;
+                    limits.maxOrderNotional = FixedPoint::parse(notional);
+                    limits.maxGrossExposure = FixedPoint::parse(gross);
+                    
+                    engine.setRiskLimits(portfolio, limits);
+                    fileHandler.saveRiskLimits(engine);
+                    std::cout << Colors::SUCCESS << Symbols::CHECK << " Limits saved for " << username
+                              << Colors::RESET << std::endl;
+                } else if (action == 2) {
+                    engine.clearRiskLimits(portfolio);
+                    fileHandler.saveRiskLimits(engine);
+                    std::cout << Colors::SUCCESS << Symbols::CHECK << " " << username
+                              << " is back on the default limits" << Colors::RESET << std::endl;
+                }
                 
                 pauseScreen();
                 break;
             }
             
-            case 7: { // Logout
+            case 9: { // Logout
                 running = false;
                 std::cout << "\nLogging out..." << std::endl;
                 break;
@@ -282,15 +630,40 @@ void handleAdminSession(Admin* admin, TradingEngine& engine, PriceSimulator& sim
 
 // Trader session handler
 void handleTraderSession(Trader* trader, TradingEngine& engine, StrategyEngine& strategyEngine,
+                         PriceSimulator& simulator, ExecutionScheduler& scheduler,
                          FileHandler& fileHandler) {
     bool running = true;
+    std::vector<OrderPtr> signals; // Reused by every strategy run in this session
+    std::vector<ExecutionResult> results;
+    
+    // Positions are re-marked as prices move, not on every menu pass
+    engine.watchPortfolio(trader->getPortfolio());
+    
+    // Order book followed on the menu screen, kept current from depth
+    // updates rather than a new snapshot each time
+    SymbolId watchedSymbol = INVALID_SYMBOL;
+    DepthLadder watchedDepth(TradingEngine::DISPLAY_DEPTH);
+    std::vector<OrderBook::DepthUpdate> depthUpdates;
     
     while (running) {
         clearScreen();
-        trader->displayMenu();
         
-        // Update portfolio values
-        trader->getPortfolio().updatePositionValues(engine.getCurrentPrices());
+        if (watchedSymbol != INVALID_SYMBOL) {
+            depthUpdates.clear();
+            engine.drainDepthUpdates(watchedSymbol, depthUpdates);
+            size_t changes = watchedDepth.apply(depthUpdates);
+            
+            const OrderBook::DepthSnapshot& depth = watchedDepth.getDepth();
+            std::cout << "\nWatching " << SymbolTable::instance().name(watchedSymbol)
+                      << " order book (" << changes << " update(s) since the last screen)" << std::endl;
+            if (depth.bids.empty() && depth.asks.empty()) {
+                std::cout << "No resting orders." << std::endl;
+            } else {
+                TradingEngine::displayDepth(depth);
+            }
+        }
+        
+        trader->displayMenu();
         
         int choice;
         std::cout << "\nEnter choice: ";
@@ -306,7 +679,28 @@ void handleTraderSession(Trader* trader, TradingEngine& engine, StrategyEngine&
                 std::cin >> symbol;
                 
                 if (symbol != "n" && symbol != "N") {
-                    engine.displayStockDetails(symbol);
+                    SymbolId symbolId = SymbolTable::instance().find(symbol);
+                    if (symbolId != INVALID_SYMBOL) {
+                        engine.displayStockDetails(symbolId);
+                        
+                        std::cout << "\nWatch its order book on the menu screen? (y/n): ";
+                        std::string watch;
+                        std::cin >> watch;
+                        if (watch == "y" || watch == "Y") {
+                            // Subscribe first, so changes after the snapshot are kept
+                            if (watchedSymbol != INVALID_SYMBOL) {
+                                engine.unsubscribeDepth(watchedSymbol);
+                            }
+                            watchedSymbol = symbolId;
+                            engine.subscribeDepth(symbolId, TradingEngine::DISPLAY_DEPTH);
+                            
+                            OrderBook::DepthSnapshot snapshot;
+                            engine.getDepthSnapshot(symbolId, TradingEngine::DISPLAY_DEPTH, snapshot);
+                            watchedDepth.reset(snapshot);
+                        }
+                    } else {
+                        std::cout << "Stock " << symbol << " not found." << std::endl;
+                    }
                 }
                 
                 pauseScreen();
@@ -326,11 +720,13 @@ void handleTraderSession(Trader* trader, TradingEngine& engine, StrategyEngine&
                 std::cout << "Quantity: ";
                 std::cin >> quantity;
                 
-                Stock* stock = engine.getStock(symbol);
-                if (stock) {
-                    BuyOrder order(symbol, quantity, stock->getCurrentPrice());
+                SymbolId symbolId = SymbolTable::instance().find(symbol);
+                size_t row = engine.getMarket().findRow(symbolId);
+                if (row != MarketDataStore::npos) {
+                    BuyOrder order(symbolId, quantity, engine.getMarket().getLastPrice(row));
                     engine.executeOrder(&order, trader->getPortfolio());
                     fileHandler.savePortfolio(*trader);
+                    fileHandler.journalOrder(order.getRecord());
                 } else {
                     std::cout << "Stock not found!" << std::endl;
                 }
@@ -352,11 +748,13 @@ void handleTraderSession(Trader* trader, TradingEngine& engine, StrategyEngine&
                 std::cout << "Quantity: ";
                 std::cin >> quantity;
                 
-                Stock* stock = engine.getStock(symbol);
-                if (stock) {
-                    SellOrder order(symbol, quantity, stock->getCurrentPrice());
+                SymbolId symbolId = SymbolTable::instance().find(symbol);
+                size_t row = engine.getMarket().findRow(symbolId);
+                if (row != MarketDataStore::npos) {
+                    SellOrder order(symbolId, quantity, engine.getMarket().getLastPrice(row));
                     engine.executeOrder(&order, trader->getPortfolio());
                     fileHandler.savePortfolio(*trader);
+                    fileHandler.journalOrder(order.getRecord());
                 } else {
                     std::cout << "Stock not found!" << std::endl;
                 }
@@ -369,9 +767,9 @@ void handleTraderSession(Trader* trader, TradingEngine& engine, StrategyEngine&
                 clearScreen();
                 trader->getPortfolio().displayPositions();
                 
-                double totalValue = trader->getPortfolio().getTotalValue(engine.getCurrentPrices());
+                Money totalValue = trader->getPortfolio().getTotalValue();
                 std::cout << "\nTotal Portfolio Value: $" << std::fixed << std::setprecision(2) 
-                          << totalValue << std::endl;
+                          << FixedPoint::toDouble(totalValue) << std::endl;
                 
                 pauseScreen();
                 break;
@@ -380,6 +778,14 @@ void handleTraderSession(Trader* trader, TradingEngine& engine, StrategyEngine&
             case 5: { // View transaction history
                 clearScreen();
                 trader->getPortfolio().displayTransactionHistory(20);
+                
+                std::cout << "\nSearch fills by symbol and date? (y/n): ";
+                std::string search;
+                std::cin >> search;
+                if (search == "y" || search == "Y") {
+                    searchFills(trader->getPortfolio());
+                }
+                
                 pauseScreen();
                 break;
             }
@@ -388,30 +794,81 @@ void handleTraderSession(Trader* trader, TradingEngine& engine, StrategyEngine&
                 clearScreen();
                 strategyEngine.displayStrategies();
                 
+                size_t strategyCount = strategyEngine.getStrategies().size();
+                std::cout << "\n[" << (strategyCount + 1) << "] All strategies" << std::endl;
+                
                 int strategyChoice;
                 std::cout << "\nSelect strategy (0 to cancel): ";
                 std::cin >> strategyChoice;
                 
                 if (strategyChoice > 0 && 
-                    static_cast<size_t>(strategyChoice) <= strategyEngine.getStrategies().size()) {
-                    auto signals = strategyEngine.runStrategy(
-                        strategyChoice - 1, 
-                        engine.getAllStocks(), 
-                        trader->getPortfolio()
-                    );
+                    static_cast<size_t>(strategyChoice) <= strategyCount + 1) {
+                    if (static_cast<size_t>(strategyChoice) == strategyCount + 1) {
+                        strategyEngine.runAllStrategies(
+                            engine.getMarket(), 
+                            trader->getPortfolio(),
+                            signals
+                        );
+                    } else {
+                        strategyEngine.runStrategy(
+                            strategyChoice - 1, 
+                            engine.getMarket(), 
+                            trader->getPortfolio(),
+                            signals
+                        );
+                    }
                     
                     if (!signals.empty()) {
+                        // Project the batch onto a what-if view of the
+                        // portfolio before committing to it
+                        PortfolioOverlay projected(trader->getPortfolio());
+                        size_t wouldFill = engine.previewBatch(signals, projected, results);
+                        size_t wouldReject = 0;
+                        for (const ExecutionResult& result : results) {
+                            if (result.error != ExecutionError::None) wouldReject++;
+                        }
+                        
+                        std::cout << "\nIf executed now: " << wouldFill << " of " << signals.size()
+                                  << " order(s) fill, " << wouldReject << " rejected" << std::endl;
+                        std::cout << "Projected cash: $" << std::fixed << std::setprecision(2)
+                                  << FixedPoint::toDouble(projected.getCashBalance())
+                                  << "  Total value: $" << FixedPoint::toDouble(projected.getTotalValue())
+                                  << "  Realized P&L: $"
+                                  << FixedPoint::toDouble(projected.getRealizedProfitLoss()) << std::endl;
+                        
                         std::cout << "\nExecute these orders? (y/n): ";
                         char confirm;
                         std::cin >> confirm;
                         
                         if (confirm == 'y' || confirm == 'Y') {
+                            // Orders above the cap are worked as TWAP parents, one
+                            // slice per market step from the next; the rest execute now
+                            int maxChild;
+                            std::cout << "Work orders larger than how many shares as TWAP over "
+                                      << TWAP_STEPS << " market steps? (0 for none): ";
+                            std::cin >> maxChild;
+                            if (maxChild > 0) {
+                                size_t scheduled = scheduler.scheduleSignals(
+                                    signals, trader->getPortfolio(), maxChild, TWAP_STEPS, 1);
+                                if (scheduled > 0) {
+                                    std::cout << scheduled << " order(s) scheduled; see Working Orders."
+                                              << std::endl;
+                                }
+                            }
+                            
+                            engine.executeBatch(signals, trader->getPortfolio(), results);
+                            TradingEngine::displayExecutionResults(results);
+                            
+                            std::vector<OrderRecord> executed;
+                            executed.reserve(signals.size());
                             for (auto& order : signals) {
-                                engine.executeOrder(order.get(), trader->getPortfolio());
+                                executed.push_back(order->getRecord());
                             }
                             fileHandler.savePortfolio(*trader);
+                            fileHandler.journalOrders(executed.data(), executed.size());
                         }
                     }
+                    signals.clear(); // Return the slots to the pool
                 }
                 
                 pauseScreen();
@@ -422,13 +879,15 @@ void handleTraderSession(Trader* trader, TradingEngine& engine, StrategyEngine&
                 clearScreen();
                 trader->displayTraderInfo();
                 
-                double totalValue = trader->getPortfolio().getTotalValue(engine.getCurrentPrices());
-                double profitLoss = trader->getPortfolio().getTotalProfitLoss();
+                Money totalValue = trader->getPortfolio().getTotalValue();
+                Money profitLoss = trader->getPortfolio().getTotalProfitLoss();
                 
                 std::cout << "\n=== PORTFOLIO SUMMARY ===" << std::endl;
                 std::cout << "Total Value: $" << std::fixed << std::setprecision(2) 
-                          << totalValue << std::endl;
-                std::cout << "Total P&L: $" << profitLoss << std::endl;
+                          << FixedPoint::toDouble(totalValue) << std::endl;
+                std::cout << "Total P&L: $" << FixedPoint::toDouble(profitLoss) << std::endl;
+                std::cout << "Realized P&L: $" 
+                          << FixedPoint::toDouble(trader->getPortfolio().getRealizedProfitLoss()) << std::endl;
                 std::cout << "Number of Positions: " 
                           << trader->getPortfolio().getPositions().size() << std::endl;
                 std::cout << "Total Transactions: " 
@@ -438,8 +897,169 @@ void handleTraderSession(Trader* trader, TradingEngine& engine, StrategyEngine&
                 break;
             }
             
-            case 8: { // Logout
+            case 8: { // Working orders
+                clearScreen();
+                std::vector<ExecutionScheduler::ParentStatus> working;
+                scheduler.getActive(trader->getPortfolio(), working);
+                
+                std::cout << "\n=== WORKING ORDERS (market step " << simulator.getStep() << ") ==="
+                          << std::endl;
+                if (working.empty()) {
+                    std::cout << "No working parent orders." << std::endl;
+                } else {
+                    ExecutionScheduler::displayStatuses(working);
+                }
+                
+                std::cout << "\n1. Advance the market one step" << std::endl;
+                std::cout << "2. Cancel a parent order" << std::endl;
+                std::cout << "0. Back" << std::endl;
+                std::cout << "\nChoice: ";
+                int action;
+                std::cin >> action;
+                
+                if (action == 1) {
+                    simulator.simulateMarket(engine.getMarket());
+                    fileHandler.saveStocks(engine);
+                    showStopExecutions(engine);
+                    advanceSchedules(scheduler, simulator.getStep(), fileHandler);
+                    fileHandler.savePortfolio(*trader);
+                } else if (action == 2) {
+                    std::string parentText;
+                    std::cout << "Parent order id: ";
+                    std::cin >> parentText;
+                    if (parentText.compare(0, 3, "ORD") == 0) parentText.erase(0, 3);
+                    uint64_t parentId = std::strtoull(parentText.c_str(), nullptr, 10);
+                    
+                    // Only this trader's own parents can be cancelled
+                    bool owned = false;
+                    for (const ExecutionScheduler::ParentStatus& status : working) {
+                        owned = owned || status.parentId == parentId;
+                    }
+                    if (owned && scheduler.cancel(parentId)) {
+                        advanceSchedules(scheduler, simulator.getStep(), fileHandler);
+                        fileHandler.savePortfolio(*trader);
+                    } else {
+                        std::cout << "No working parent order " << parentText << "." << std::endl;
+                    }
+                }
+                
+                pauseScreen();
+                break;
+            }
+            
+            case 9: { // Stop orders
+                clearScreen();
+                std::vector<StopIndex::StopOrder> stops;
+                engine.getStopOrders(trader->getPortfolio(), stops);
+                
+                std::cout << "\n=== STOP ORDERS ===" << std::endl;
+                if (stops.empty()) {
+                    std::cout << "No stop orders." << std::endl;
+                } else {
+                    std::cout << std::left << std::setw(21) << "Order" << std::setw(12) << "Type"
+                              << std::setw(6) << "Side" << std::setw(8) << "Symbol"
+                              << std::right << std::setw(8) << "Qty" << std::setw(12) << "Stop"
+                              << std::setw(12) << "Limit" << std::endl;
+                    std::cout << std::string(79, '-') << std::endl;
+                    for (const StopIndex::StopOrder& stop : stops) {
+                        Order order(stop.order);
+                        std::cout << std::left << std::setw(21) << order.getOrderId()
+                                  << std::setw(12) << StopIndex::typeName(stop.type)
+                                  << std::setw(6) << order.getOrderType()
+                                  << std::setw(8) << order.getSymbol()
+                                  << std::right << std::setw(8) << order.getQuantity()
+                                  << std::setw(12) << std::fixed << std::setprecision(2)
+                                  << FixedPoint::toDouble(stop.stopPrice) << std::setw(12);
+                        if (stop.type == StopType::StopLimit) {
+                            std::cout << FixedPoint::toDouble(order.getPrice());
+                        } else {
+                            std::cout << "MARKET";
+                        }
+                        std::cout << std::endl;
+                    }
+                }
+                
+                std::cout << "\n1. Place stop order" << std::endl;
+                std::cout << "2. Place stop-limit order" << std::endl;
+                std::cout << "3. Place trailing stop" << std::endl;
+                std::cout << "4. Cancel a stop order" << std::endl;
+                std::cout << "0. Back" << std::endl;
+                std::cout << "\nChoice: ";
+                int action;
+                std::cin >> action;
+                
+                if (action >= 1 && action <= 3) {
+                    std::string symbol, sideText, stopText, limitText;
+                    int quantity;
+                    std::cout << "Symbol: ";
+                    std::cin >> symbol;
+                    std::cout << "Side (buy/sell): ";
+                    std::cin >> sideText;
+                    std::cout << "Quantity: ";
+                    std::cin >> quantity;
+                    std::cout << (action == 3 ? "Trail amount: $" : "Stop price: $");
+                    std::cin >> stopText;
+                    if (action == 2) {
+                        std::cout << "Limit price: $";
+                        std::cin >> limitText;
+                    }
+                    
+                    SymbolId symbolId = SymbolTable::instance().find(symbol);
+                    size_t row = engine.getMarket().findRow(symbolId);
+                    OrderSide side = (sideText == "sell" || sideText == "s") ? OrderSide::Sell
+                                                                            : OrderSide::Buy;
+                    if (row == MarketDataStore::npos) {
+                        std::cout << "Stock not found!" << std::endl;
+                    } else if (quantity <= 0) {
+                        std::cout << "Quantity must be positive." << std::endl;
+                    } else {
+                        // Only a stop-limit keeps its price; the others fill at market
+                        Price price = (action == 2) ? FixedPoint::parse(limitText)
+                                                    : engine.getMarket().getLastPrice(row);
+                        Order order(side, symbolId, quantity, price);
+                        if (action == 3) {
+                            engine.placeTrailingStop(&order, trader->getPortfolio(),
+                                                     FixedPoint::parse(stopText));
+                        } else {
+                            engine.placeStopOrder(&order, trader->getPortfolio(),
+                                                  action == 2 ? StopType::StopLimit : StopType::Stop,
+                                                  FixedPoint::parse(stopText));
+                        }
+                    }
+                } else if (action == 4) {
+                    std::string orderText;
+                    std::cout << "Stop order id: ";
+                    std::cin >> orderText;
+                    
+                    bool cancelled = false;
+                    for (const StopIndex::StopOrder& stop : stops) {
+                        if (Order(stop.order).getOrderId() == orderText || 
+                            std::to_string(stop.order.orderId) == orderText) {
+                            cancelled = engine.cancelStopOrder(stop.order.symbolId, stop.order.orderId,
+                                                               trader->getPortfolio());
+                        }
+                    }
+                    std::cout << (cancelled ? "Stop order cancelled." : "No such stop order.")
+                              << std::endl;
+                }
+                
+                pauseScreen();
+                break;
+            }
+            
+            case 10: { // Logout
                 running = false;
+                
+                // Nothing may keep working for a portfolio that is going away
+                size_t cancelled = scheduler.cancelPortfolio(trader->getPortfolio());
+                if (cancelled > 0) {
+                    std::cout << "Cancelled " << cancelled << " working parent order(s)." << std::endl;
+                    advanceSchedules(scheduler, simulator.getStep(), fileHandler);
+                }
+                engine.detachAccount(trader->getPortfolio());
+                if (watchedSymbol != INVALID_SYMBOL) {
+                    engine.unsubscribeDepth(watchedSymbol);
+                }
                 fileHandler.savePortfolio(*trader);
                 std::cout << "\nLogging out and saving portfolio..." << std::endl;
                 break;
@@ -459,9 +1079,11 @@ int main() {
     TradingEngine engine;
     StrategyEngine strategyEngine;
     PriceSimulator simulator(0.02, 0.0001);
+    ExecutionScheduler scheduler(engine, simulator.getStep());
     
     // Load stocks from file
     fileHandler.loadStocks(engine);
+    fileHandler.loadRiskLimits(engine);
     
     // Main application loop
     bool running = true;
@@ -487,10 +1109,11 @@ int main() {
                 if (currentUser) {
                     if (currentUser->getRole() == "ADMIN") {
                         Admin* admin = dynamic_cast<Admin*>(currentUser);
-                        handleAdminSession(admin, engine, simulator, fileHandler, users);
+                        handleAdminSession(admin, engine, simulator, scheduler, fileHandler, users);
                     } else if (currentUser->getRole() == "TRADER") {
                         Trader* trader = dynamic_cast<Trader*>(currentUser);
-                        handleTraderSession(trader, engine, strategyEngine, fileHandler);
+                        handleTraderSession(trader, engine, strategyEngine, simulator, scheduler,
+                                            fileHandler);
                     }
                     
                     delete currentUser;
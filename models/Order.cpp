@@ -1,128 +1,137 @@
 #include "Order.h"
+#include "../utils/OrderIdGenerator.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
-#include <random>
+#include <cstdio>
+#include <cstdlib>
 
 // Base Order implementation
-Order::Order(const std::string& symbol, int quantity, double price)
-    : symbol(symbol), quantity(quantity), price(price), 
-      timestamp(std::time(nullptr)), status("PENDING") {
-    orderId = generateOrderId();
-}
-
-std::string Order::generateOrderId() {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(10000, 99999);
-    
-    std::ostringstream oss;
-    oss << "ORD" << dis(gen);
-    return oss.str();
-}
+Order::Order(OrderSide side, SymbolId symbolId, int quantity, Price price) {
+    record.orderId = OrderIdGenerator::instance().next();
+    record.price = price;
+    record.timestamp = std::time(nullptr);
+    record.symbolId = symbolId;
+    record.quantity = quantity;
+    record.filledQuantity = 0;
+    record.side = side;
+    record.status = OrderStatus::Pending;
+    record.flags = 0;
+    record.reserved = 0;
+}
+
+Order::Order(const OrderRecord& record)
+    : record(record) {}
 
 void Order::display() const {
-    std::cout << std::left << std::setw(10) << orderId
+    std::cout << std::left << std::setw(21) << getOrderId()
               << std::setw(8) << getOrderType()
-              << std::setw(8) << symbol
-              << std::right << std::setw(8) << quantity
-              << std::setw(12) << std::fixed << std::setprecision(2) << price
-              << std::setw(12) << getTotalValue()
-              << "  " << std::left << std::setw(10) << status;
+              << std::setw(8) << getSymbol()
+              << std::right << std::setw(8) << record.quantity
+              << std::setw(12) << std::fixed << std::setprecision(2) 
+              << FixedPoint::toDouble(record.price)
+              << std::setw(12) << FixedPoint::toDouble(getTotalValue())
+              << "  " << std::left << std::setw(10) << getStatusName();
+}
+
+uint64_t Order::getId() const {
+    return record.orderId;
 }
 
 std::string Order::getOrderId() const {
-    return orderId;
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "ORD%llu",
+                  static_cast<unsigned long long>(record.orderId));
+    return std::string(buffer);
 }
 
-std::string Order::getSymbol() const {
-    return symbol;
+OrderSide Order::getSide() const {
+    return record.side;
 }
 
-int Order::getQuantity() const {
-    return quantity;
+bool Order::isBuy() const {
+    return record.side == OrderSide::Buy;
 }
 
-double Order::getPrice() const {
-    return price;
+const char* Order::getOrderType() const {
+    return sideName(record.side);
 }
 
-double Order::getTotalValue() const {
-    return quantity * price;
+SymbolId Order::getSymbolId() const {
+    return record.symbolId;
 }
 
-std::string Order::getStatus() const {
-    return status;
+const std::string& Order::getSymbol() const {
+    return SymbolTable::instance().name(record.symbolId);
 }
 
-time_t Order::getTimestamp() const {
-    return timestamp;
+int Order::getQuantity() const {
+    return record.quantity;
 }
 
-void Order::setStatus(const std::string& newStatus) {
-    status = newStatus;
+int Order::getFilledQuantity() const {
+    return record.filledQuantity;
 }
 
-std::string Order::serialize() const {
-    std::ostringstream oss;
-    oss << orderId << "|" << symbol << "|" << quantity << "|" 
-        << price << "|" << timestamp << "|" << status;
-    return oss.str();
+Price Order::getPrice() const {
+    return record.price;
 }
 
-// BuyOrder implementation
-BuyOrder::BuyOrder(const std::string& symbol, int quantity, double price)
-    : Order(symbol, quantity, price) {}
+Money Order::getTotalValue() const {
+    return FixedPoint::notional(record.price, record.quantity);
+}
 
-std::string BuyOrder::getOrderType() const {
-    return "BUY";
+OrderStatus Order::getStatus() const {
+    return record.status;
 }
 
-void BuyOrder::display() const {
-    Order::display();
+const char* Order::getStatusName() const {
+    return statusName(record.status);
 }
 
-std::string BuyOrder::serialize() const {
-    return "BUY|" + Order::serialize();
+time_t Order::getTimestamp() const {
+    return static_cast<time_t>(record.timestamp);
 }
 
-BuyOrder BuyOrder::deserialize(const std::string& data) {
-    std::istringstream iss(data);
-    std::string type, orderId, symbol, qtyStr, priceStr, timeStr, status;
-    
-    std::getline(iss, type, '|');
-    std::getline(iss, orderId, '|');
-    std::getline(iss, symbol, '|');
-    std::getline(iss, qtyStr, '|');
-    std::getline(iss, priceStr, '|');
-    std::getline(iss, timeStr, '|');
-    std::getline(iss, status);
-    
-    BuyOrder order(symbol, std::stoi(qtyStr), std::stod(priceStr));
-    order.orderId = orderId;
-    order.timestamp = std::stol(timeStr);
-    order.status = status;
-    
-    return order;
+const OrderRecord& Order::getRecord() const {
+    return record;
 }
 
-// SellOrder implementation
-SellOrder::SellOrder(const std::string& symbol, int quantity, double price)
-    : Order(symbol, quantity, price) {}
+void Order::setStatus(OrderStatus newStatus) {
+    record.status = newStatus;
+}
 
-std::string SellOrder::getOrderType() const {
-    return "SELL";
+void Order::addFill(int quantity) {
+    record.filledQuantity += quantity;
 }
 
-void SellOrder::display() const {
-    Order::display();
+const char* Order::sideName(OrderSide side) {
+    return side == OrderSide::Buy ? "BUY" : "SELL";
 }
 
-std::string SellOrder::serialize() const {
-    return "SELL|" + Order::serialize();
+const char* Order::statusName(OrderStatus status) {
+    switch (status) {
+        case OrderStatus::Executed: return "EXECUTED";
+        case OrderStatus::Cancelled: return "CANCELLED";
+        default: return "PENDING";
+    }
 }
 
-SellOrder SellOrder::deserialize(const std::string& data) {
+OrderStatus Order::parseStatus(const std::string& name) {
+    if (name == "EXECUTED") return OrderStatus::Executed;
+    if (name == "CANCELLED") return OrderStatus::Cancelled;
+    return OrderStatus::Pending;
+}
+
+std::string Order::serialize() const {
+    std::ostringstream oss;
+    oss << getOrderType() << "|" << getOrderId() << "|" << getSymbol() << "|" 
+        << record.quantity << "|" << FixedPoint::toString(record.price) << "|" 
+        << record.timestamp << "|" << getStatusName();
+    return oss.str();
+}
+
+Order Order::deserialize(const std::string& data) {
     std::istringstream iss(data);
     std::string type, orderId, symbol, qtyStr, priceStr, timeStr, status;
     
@@ -134,10 +143,22 @@ SellOrder SellOrder::deserialize(const std::string& data) {
     std::getline(iss, timeStr, '|');
     std::getline(iss, status);
     
-    SellOrder order(symbol, std::stoi(qtyStr), std::stod(priceStr));
-    order.orderId = orderId;
-    order.timestamp = std::stol(timeStr);
-    order.status = status;
+    OrderSide side = (type == "SELL") ? OrderSide::Sell : OrderSide::Buy;
+    Order order(side, SymbolTable::instance().intern(symbol), std::stoi(qtyStr),
+                FixedPoint::parse(priceStr));
+    if (orderId.compare(0, 3, "ORD") == 0) {
+        order.record.orderId = std::strtoull(orderId.c_str() + 3, nullptr, 10);
+    }
+    order.record.timestamp = std::stoll(timeStr);
+    order.record.status = parseStatus(status);
     
     return order;
 }
+
+// BuyOrder implementation
+BuyOrder::BuyOrder(SymbolId symbolId, int quantity, Price price)
+    : Order(OrderSide::Buy, symbolId, quantity, price) {}
+
+// SellOrder implementation
+SellOrder::SellOrder(SymbolId symbolId, int quantity, Price price)
+    : Order(OrderSide::Sell, symbolId, quantity, price) {}
@@ -3,73 +3,98 @@
 
 #include <string>
 #include <ctime>
+#include <cstdint>
+#include <type_traits>
+#include "../utils/SymbolTable.h"
+#include "../utils/FixedPoint.h"
 
-// Abstract base class demonstrating Abstraction and Polymorphism
+enum class OrderSide : uint8_t {
+    Buy,
+    Sell
+};
+
+enum class OrderStatus : uint8_t {
+    Pending,
+    Executed,
+    Cancelled
+};
+
+// Fixed-layout order state. Trivially copyable and no larger than a cache
+// line, so it can be queued by value and journaled as raw bytes.
+struct OrderRecord {
+    uint64_t orderId;
+    Price price;             // Limit price
+    int64_t timestamp;
+    SymbolId symbolId;
+    int32_t quantity;
+    int32_t filledQuantity;
+    OrderSide side;
+    OrderStatus status;
+    uint8_t flags;           // ORDER_FLAG_* bits
+    uint8_t reserved;
+};
+
+// A parent worked by the ExecutionScheduler; its child orders carry the fills
+const uint8_t ORDER_FLAG_PARENT = 0x01;
+
+static_assert(sizeof(OrderRecord) <= 64, "OrderRecord must fit in one cache line");
+static_assert(std::is_trivially_copyable<OrderRecord>::value,
+              "OrderRecord must be trivially copyable");
+static_assert(std::is_standard_layout<OrderRecord>::value,
+              "OrderRecord must have a fixed layout for journaling");
+
+// A single order, wrapping its OrderRecord. The side is a plain tag, so
+// executing an order needs neither RTTI nor virtual dispatch.
 class Order {
 protected:
-    std::string orderId;
-    std::string symbol;
-    int quantity;
-    double price;
-    time_t timestamp;
-    std::string status; // "PENDING", "EXECUTED", "CANCELLED"
+    OrderRecord record;
 
 public:
     // Constructor
-    Order(const std::string& symbol, int quantity, double price);
+    Order(OrderSide side, SymbolId symbolId, int quantity, Price price);
+    explicit Order(const OrderRecord& record);
     
-    // Virtual destructor for proper cleanup
-    virtual ~Order() = default;
-    
-    // Pure virtual function - makes this an abstract class
-    virtual std::string getOrderType() const = 0;
-    
-    // Virtual function for polymorphism
-    virtual void display() const;
+    void display() const;
     
     // Getters
-    std::string getOrderId() const;
-    std::string getSymbol() const;
+    uint64_t getId() const;
+    std::string getOrderId() const; // "ORD" + id, rendered on demand
+    OrderSide getSide() const;
+    bool isBuy() const;
+    const char* getOrderType() const; // "BUY" or "SELL"
+    SymbolId getSymbolId() const;
+    const std::string& getSymbol() const; // Ticker text for display
     int getQuantity() const;
-    double getPrice() const;
-    double getTotalValue() const;
-    std::string getStatus() const;
+    int getFilledQuantity() const;
+    Price getPrice() const;
+    Money getTotalValue() const;
+    OrderStatus getStatus() const;
+    const char* getStatusName() const; // "PENDING", "EXECUTED", "CANCELLED"
     time_t getTimestamp() const;
+    const OrderRecord& getRecord() const;
     
     // Setters
-    void setStatus(const std::string& newStatus);
+    void setStatus(OrderStatus newStatus);
+    void addFill(int quantity);
     
-    // Serialization
-    virtual std::string serialize() const;
+    static const char* sideName(OrderSide side);
+    static const char* statusName(OrderStatus status);
+    static OrderStatus parseStatus(const std::string& name);
     
-protected:
-    std::string generateOrderId();
+    // Serialization: "BUY|id|symbol|qty|price|time|status"
+    std::string serialize() const;
+    static Order deserialize(const std::string& data);
 };
 
-// Derived class demonstrating Inheritance
+// Thin adapters that fix the side, kept for the menu code
 class BuyOrder : public Order {
 public:
-    BuyOrder(const std::string& symbol, int quantity, double price);
-    
-    // Override virtual function
-    std::string getOrderType() const override;
-    void display() const override;
-    
-    std::string serialize() const override;
-    static BuyOrder deserialize(const std::string& data);
+    BuyOrder(SymbolId symbolId, int quantity, Price price);
 };
 
-// Another derived class demonstrating Inheritance
 class SellOrder : public Order {
 public:
-    SellOrder(const std::string& symbol, int quantity, double price);
-    
-    // Override virtual function
-    std::string getOrderType() const override;
-    void display() const override;
-    
-    std::string serialize() const override;
-    static SellOrder deserialize(const std::string& data);
+    SellOrder(SymbolId symbolId, int quantity, Price price);
 };
 
 #endif
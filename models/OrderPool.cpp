@@ -0,0 +1,79 @@
+#include "OrderPool.h"
+#include <new>
+
+const size_t OrderPool::SLOTS_PER_BLOCK;
+const size_t OrderPool::SLOT_SIZE;
+
+void OrderPool::Deleter::operator()(Order* order) const {
+    if (pool) {
+        pool->release(order);
+    }
+}
+
+OrderPool::OrderPool(size_t initialSlots)
+    : freeList(nullptr), slotCount(0), liveCount(0) {
+    reserve(initialSlots);
+}
+
+OrderPool::OrderPtr OrderPool::create(OrderSide side, SymbolId symbolId, int quantity,
+                                      Price price) {
+    void* slot = acquire();
+    return OrderPtr(new (slot) Order(side, symbolId, quantity, price), Deleter(this));
+}
+
+OrderPool::OrderPtr OrderPool::createBuy(SymbolId symbolId, int quantity, Price price) {
+    return create(OrderSide::Buy, symbolId, quantity, price);
+}
+
+OrderPool::OrderPtr OrderPool::createSell(SymbolId symbolId, int quantity, Price price) {
+    return create(OrderSide::Sell, symbolId, quantity, price);
+}
+
+void* OrderPool::acquire() {
+    if (!freeList) {
+        grow(slotCount > 0 ? slotCount : SLOTS_PER_BLOCK);
+    }
+    
+    Slot* slot = freeList;
+    freeList = slot->next;
+    liveCount++;
+    return &slot->storage;
+}
+
+void OrderPool::release(Order* order) {
+    order->~Order();
+    
+    Slot* slot = reinterpret_cast<Slot*>(order);
+    slot->next = freeList;
+    freeList = slot;
+    liveCount--;
+}
+
+void OrderPool::grow(size_t slots) {
+    if (slots == 0) return;
+    
+    std::unique_ptr<Slot[]> block(new Slot[slots]);
+    
+    // Thread the new slots onto the front of the free list
+    for (size_t i = 0; i < slots; i++) {
+        block[i].next = (i + 1 < slots) ? &block[i + 1] : freeList;
+    }
+    freeList = &block[0];
+    
+    blocks.push_back(std::move(block));
+    slotCount += slots;
+}
+
+void OrderPool::reserve(size_t slots) {
+    if (slots > slotCount) {
+        grow(slots - slotCount);
+    }
+}
+
+size_t OrderPool::capacity() const {
+    return slotCount;
+}
+
+size_t OrderPool::inUse() const {
+    return liveCount;
+}
@@ -0,0 +1,65 @@
+#ifndef ORDER_POOL_H
+#define ORDER_POOL_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <type_traits>
+#include "Order.h"
+
+// Recycling arena for orders. Every order occupies one fixed-size slot;
+// released slots go onto a free list and are reused, so once the pool has
+// grown to the working set no order costs a heap allocation.
+// The pool must outlive every order it hands out.
+class OrderPool {
+public:
+    // Returns an order's slot to the pool that created it
+    struct Deleter {
+        OrderPool* pool;
+        
+        Deleter(OrderPool* pool = nullptr) : pool(pool) {}
+        void operator()(Order* order) const;
+    };
+    
+    typedef std::unique_ptr<Order, Deleter> OrderPtr;
+    
+    static const size_t SLOTS_PER_BLOCK = 64;
+    static const size_t SLOT_SIZE = sizeof(Order);
+
+private:
+    union Slot {
+        Slot* next; // Free list link while the slot is unused
+        std::aligned_storage<SLOT_SIZE, alignof(Order)>::type storage;
+    };
+    
+    std::vector<std::unique_ptr<Slot[]>> blocks;
+    Slot* freeList;
+    size_t slotCount;
+    size_t liveCount;
+    
+    void* acquire();
+    void release(Order* order);
+    void grow(size_t slots);
+
+public:
+    explicit OrderPool(size_t initialSlots = SLOTS_PER_BLOCK);
+    
+    OrderPool(const OrderPool&) = delete;
+    OrderPool& operator=(const OrderPool&) = delete;
+    
+    // Order construction
+    OrderPtr create(OrderSide side, SymbolId symbolId, int quantity, Price price);
+    OrderPtr createBuy(SymbolId symbolId, int quantity, Price price);
+    OrderPtr createSell(SymbolId symbolId, int quantity, Price price);
+    
+    // Make sure at least `slots` orders can be live without growing
+    void reserve(size_t slots);
+    
+    // Statistics
+    size_t capacity() const;
+    size_t inUse() const;
+};
+
+typedef OrderPool::OrderPtr OrderPtr;
+
+#endif
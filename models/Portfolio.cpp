@@ -4,152 +4,214 @@
 #include <iomanip>
 #include <sstream>
 #include <ctime>
+#include <algorithm>
 
-// Transaction implementation
-std::string Transaction::serialize() const {
-    std::ostringstream oss;
-    oss << type << "|" << symbol << "|" << quantity << "|" 
-        << price << "|" << timestamp;
-    return oss.str();
-}
-
-Transaction Transaction::deserialize(const std::string& data) {
-    std::istringstream iss(data);
-    std::string type, symbol, qtyStr, priceStr, timeStr;
-    
-    std::getline(iss, type, '|');
-    std::getline(iss, symbol, '|');
-    std::getline(iss, qtyStr, '|');
-    std::getline(iss, priceStr, '|');
-    std::getline(iss, timeStr);
-    
-    Transaction txn(type, symbol, std::stoi(qtyStr), std::stod(priceStr));
-    txn.timestamp = std::stol(timeStr);
-    
-    return txn;
-}
+const uint32_t Portfolio::NO_ACCOUNT;
 
 // Portfolio implementation
-Portfolio::Portfolio(const std::string& userId, double initialBalance)
-    : userId(userId), cashBalance(initialBalance) {}
+Portfolio::Portfolio(const std::string& userId, Money initialBalance)
+    : userId(userId), cashBalance(initialBalance), lotMethod(LotMethod::Fifo),
+      realizedProfitLoss(0), reservedCash(0), accountId(NO_ACCOUNT), marketValue(0),
+      totalProfitLoss(0) {}
 
 std::string Portfolio::getUserId() const {
     return userId;
 }
 
-double Portfolio::getCashBalance() const {
+Money Portfolio::getCashBalance() const {
     return cashBalance;
 }
 
-const std::map<std::string, Position>& Portfolio::getPositions() const {
+const PositionTable& Portfolio::getPositions() const {
     return positions;
 }
 
-const std::vector<Transaction>& Portfolio::getTransactionHistory() const {
+const TransactionLog& Portfolio::getTransactionHistory() const {
     return transactionHistory;
 }
 
-bool Portfolio::buyStock(const std::string& symbol, int quantity, double price) {
-    double totalCost = quantity * price;
-    
-    if (totalCost > cashBalance) {
-        std::cout << "Insufficient funds. Required: $" << std::fixed 
-                  << std::setprecision(2) << totalCost 
-                  << ", Available: $" << cashBalance << std::endl;
+bool Portfolio::attachHistoryFile(const std::string& path) {
+    return transactionHistory.attachSpillFile(path);
+}
+
+bool Portfolio::canBuy(int quantity, Price price) const {
+    return FixedPoint::notional(price, quantity) <= getAvailableCash();
+}
+
+bool Portfolio::canSell(SymbolId symbol, int quantity) const {
+    return checkSell(positions.find(symbol), quantity);
+}
+
+bool Portfolio::checkSell(const Position* pos, int quantity) const {
+    return pos && pos->quantity - pos->reserved >= quantity;
+}
+
+bool Portfolio::buyStock(SymbolId symbol, int quantity, Price price) {
+    if (!canBuy(quantity, price)) {
         return false;
     }
     
+    Money totalCost = FixedPoint::notional(price, quantity);
+    
     // Deduct cash
     cashBalance -= totalCost;
     
-    // Update or create position
-    if (positions.find(symbol) != positions.end()) {
-        Position& pos = positions[symbol];
-        double totalCost = (pos.quantity * pos.averagePrice) + (quantity * price);
-        pos.quantity += quantity;
-        pos.averagePrice = totalCost / pos.quantity;
+    // Update or create position; the fill becomes its newest lot
+    bool inserted;
+    Position& pos = positions.upsert(symbol, inserted);
+    if (inserted) {
+        pos = Position(symbol, quantity, price);
+        pos.lots = taxLots.open();
     } else {
-        positions[symbol] = Position(symbol, quantity, price);
+        removeFromTotals(pos);
+        pos.quantity += quantity;
     }
+    taxLots.add(pos.lots, price, quantity);
+    pos.averagePrice = FixedPoint::divide(taxLots.getCost(pos.lots), pos.quantity);
+    addToTotals(pos);
     
     // Record transaction
-    transactionHistory.push_back(Transaction("BUY", symbol, quantity, price));
+    transactionHistory.append(Transaction(OrderSide::Buy, symbol, quantity, price));
     
     return true;
 }
 
-bool Portfolio::sellStock(const std::string& symbol, int quantity, double price) {
-    if (positions.find(symbol) == positions.end()) {
-        std::cout << "You don't own any shares of " << symbol << std::endl;
-        return false;
-    }
-    
-    Position& pos = positions[symbol];
-    
-    if (pos.quantity < quantity) {
-        std::cout << "Insufficient shares. You own " << pos.quantity 
-                  << " shares of " << symbol << std::endl;
+bool Portfolio::sellStock(SymbolId symbol, int quantity, Price price) {
+    Position* pos = positions.find(symbol);
+    if (!checkSell(pos, quantity)) {
         return false;
     }
     
     // Credit cash
-    double totalValue = quantity * price;
-    cashBalance += totalValue;
+    Money proceeds = FixedPoint::notional(price, quantity);
+    cashBalance += proceeds;
     
-    // Update position
-    pos.quantity -= quantity;
+    // Update position, realizing P&L against the lots the sale consumes
+    removeFromTotals(*pos);
+    realizedProfitLoss += proceeds - taxLots.consume(pos->lots, quantity, lotMethod);
+    pos->quantity -= quantity;
     
     // Remove position if quantity is zero
-    if (pos.quantity == 0) {
-        positions.erase(symbol);
+    if (pos->quantity == 0) {
+        taxLots.close(pos->lots);
+        positions.erase(pos);
+    } else {
+        pos->averagePrice = FixedPoint::divide(taxLots.getCost(pos->lots), pos->quantity);
+        addToTotals(*pos);
     }
     
     // Record transaction
-    transactionHistory.push_back(Transaction("SELL", symbol, quantity, price));
+    transactionHistory.append(Transaction(OrderSide::Sell, symbol, quantity, price));
     
     return true;
 }
 
-void Portfolio::updatePositionValues(const std::map<std::string, double>& currentPrices) {
-    for (auto& pair : positions) {
-        Position& pos = pair.second;
-        
-        if (currentPrices.find(pos.symbol) != currentPrices.end()) {
-            double currentPrice = currentPrices.at(pos.symbol);
-            pos.currentValue = pos.quantity * currentPrice;
-            pos.profitLoss = pos.currentValue - (pos.quantity * pos.averagePrice);
-        }
+void Portfolio::reserveCash(Money amount) {
+    reservedCash += amount;
+}
+
+void Portfolio::releaseCash(Money amount) {
+    reservedCash -= std::min(amount, reservedCash);
+}
+
+void Portfolio::reserveShares(SymbolId symbol, int quantity) {
+    Position* pos = positions.find(symbol);
+    if (pos) pos->reserved += quantity;
+}
+
+void Portfolio::releaseShares(SymbolId symbol, int quantity) {
+    Position* pos = positions.find(symbol);
+    if (pos) pos->reserved -= std::min(quantity, pos->reserved);
+}
+
+Money Portfolio::getReservedCash() const {
+    return reservedCash;
+}
+
+Money Portfolio::getAvailableCash() const {
+    return cashBalance - reservedCash;
+}
+
+int Portfolio::getAvailableShares(SymbolId symbol) const {
+    const Position* pos = positions.find(symbol);
+    return pos ? pos->quantity - pos->reserved : 0;
+}
+
+uint32_t Portfolio::getAccountId() const {
+    return accountId;
+}
+
+void Portfolio::setAccountId(uint32_t id) {
+    accountId = id;
+}
+
+void Portfolio::addToTotals(const Position& pos) {
+    marketValue += pos.currentValue();
+    totalProfitLoss += pos.profitLoss();
+}
+
+void Portfolio::removeFromTotals(const Position& pos) {
+    marketValue -= pos.currentValue();
+    totalProfitLoss -= pos.profitLoss();
+}
+
+bool Portfolio::markPrice(SymbolId symbol, Price price) {
+    Position* pos = positions.find(symbol);
+    if (!pos) return false;
+    
+    if (price > 0 && price != pos->marketPrice) {
+        removeFromTotals(*pos);
+        pos->marketPrice = price;
+        addToTotals(*pos);
     }
+    return true;
 }
 
-double Portfolio::getTotalValue(const std::map<std::string, double>& currentPrices) const {
-    double total = cashBalance;
-    
-    for (const auto& pair : positions) {
-        const Position& pos = pair.second;
-        if (currentPrices.find(pos.symbol) != currentPrices.end()) {
-            total += pos.quantity * currentPrices.at(pos.symbol);
+void Portfolio::updatePositionValues(const std::vector<Price>& currentPrices) {
+    for (Position& pos : positions) {
+        if (pos.symbolId < currentPrices.size() && currentPrices[pos.symbolId] > 0) {
+            removeFromTotals(pos);
+            pos.marketPrice = currentPrices[pos.symbolId];
+            addToTotals(pos);
         }
     }
-    
-    return total;
 }
 
-double Portfolio::getTotalProfitLoss() const {
-    double total = 0.0;
-    
-    for (const auto& pair : positions) {
-        total += pair.second.profitLoss;
-    }
-    
-    return total;
+Money Portfolio::getTotalValue() const {
+    return cashBalance + marketValue;
 }
 
-Position* Portfolio::getPosition(const std::string& symbol) {
-    if (positions.find(symbol) != positions.end()) {
-        return &positions[symbol];
-    }
-    return nullptr;
+Money Portfolio::getMarketValue() const {
+    return marketValue;
+}
+
+Money Portfolio::getTotalProfitLoss() const {
+    return totalProfitLoss;
+}
+
+Money Portfolio::getRealizedProfitLoss() const {
+    return realizedProfitLoss;
+}
+
+void Portfolio::setLotMethod(LotMethod method) {
+    lotMethod = method;
+}
+
+LotMethod Portfolio::getLotMethod() const {
+    return lotMethod;
+}
+
+size_t Portfolio::getLots(SymbolId symbol, std::vector<TaxLot>& lots) const {
+    const Position* pos = positions.find(symbol);
+    return pos ? taxLots.getLots(pos->lots, lots) : 0;
+}
+
+Position* Portfolio::getPosition(SymbolId symbol) {
+    return positions.find(symbol);
+}
+
+const Position* Portfolio::getPosition(SymbolId symbol) const {
+    return positions.find(symbol);
 }
 
 void Portfolio::displayPositions() const {
@@ -170,33 +232,37 @@ void Portfolio::displayPositions() const {
               << std::setw(12) << "P&L %" << Colors::RESET << std::endl;
     std::cout << Colors::DIM << std::string(90, '-') << Colors::RESET << std::endl;
     
-    for (const auto& pair : positions) {
-        const Position& pos = pair.second;
-        double plPercent = (pos.averagePrice > 0) ? 
-            (pos.profitLoss / (pos.quantity * pos.averagePrice)) * 100.0 : 0.0;
+    for (const Position& pos : positions) {
+        Money costBasis = pos.costBasis();
+        Money positionPL = pos.profitLoss();
+        double plPercent = (costBasis > 0) ? 
+            (static_cast<double>(positionPL) / costBasis) * 100.0 : 0.0;
+        double profitLoss = FixedPoint::toDouble(positionPL);
         
-        std::cout << Colors::BOLD_CYAN << std::left << std::setw(10) << pos.symbol << Colors::RESET
+        std::cout << Colors::BOLD_CYAN << std::left << std::setw(10) 
+                  << SymbolTable::instance().name(pos.symbolId) << Colors::RESET
                   << std::right << std::setw(10) << pos.quantity
-                  << std::setw(15) << std::fixed << std::setprecision(2) << pos.averagePrice
-                  << std::setw(15) << pos.currentValue;
+                  << std::setw(15) << std::fixed << std::setprecision(2) 
+                  << FixedPoint::toDouble(pos.averagePrice)
+                  << std::setw(15) << FixedPoint::toDouble(pos.currentValue());
         
         // Color code P&L
-        if (pos.profitLoss > 0) {
-            std::cout << Colors::PROFIT << std::setw(15) << Symbols::ARROW_UP << " " << pos.profitLoss
+        if (positionPL > 0) {
+            std::cout << Colors::PROFIT << std::setw(15) << Symbols::ARROW_UP << " " << profitLoss
                       << std::setw(10) << plPercent << "%" << Colors::RESET << std::endl;
-        } else if (pos.profitLoss < 0) {
-            std::cout << Colors::LOSS << std::setw(15) << Symbols::ARROW_DOWN << " " << pos.profitLoss
+        } else if (positionPL < 0) {
+            std::cout << Colors::LOSS << std::setw(15) << Symbols::ARROW_DOWN << " " << profitLoss
                       << std::setw(10) << plPercent << "%" << Colors::RESET << std::endl;
         } else {
-            std::cout << Colors::DIM << std::setw(15) << pos.profitLoss
+            std::cout << Colors::DIM << std::setw(15) << profitLoss
                       << std::setw(11) << plPercent << "%" << Colors::RESET << std::endl;
         }
     }
     
     std::cout << Colors::HEADER << std::string(90, '=') << Colors::RESET << std::endl;
-    std::cout << Colors::INFO << "Cash Balance: " << Colors::BOLD_WHITE << "$" << std::fixed << std::setprecision(2) << cashBalance << Colors::RESET << std::endl;
+    std::cout << Colors::INFO << "Cash Balance: " << Colors::BOLD_WHITE << "$" << std::fixed << std::setprecision(2) << FixedPoint::toDouble(cashBalance) << Colors::RESET << std::endl;
     
-    double totalPL = getTotalProfitLoss();
+    double totalPL = FixedPoint::toDouble(getTotalProfitLoss());
     if (totalPL > 0) {
         std::cout << Colors::PROFIT << "Total P&L: " << Symbols::ARROW_UP << " $" << totalPL << Colors::RESET << std::endl;
     } else if (totalPL < 0) {
@@ -204,18 +270,20 @@ void Portfolio::displayPositions() const {
     } else {
         std::cout << Colors::INFO << "Total P&L: $" << totalPL << Colors::RESET << std::endl;
     }
+    
+    double realizedPL = FixedPoint::toDouble(realizedProfitLoss);
+    std::cout << (realizedPL > 0 ? Colors::PROFIT : (realizedPL < 0 ? Colors::LOSS : Colors::INFO))
+              << "Realized P&L (" << TaxLotBook::methodName(lotMethod) << "): $" << realizedPL
+              << Colors::RESET << std::endl;
 }
 
-void Portfolio::displayTransactionHistory(int limit) const {
-    if (transactionHistory.empty()) {
-        std::cout << "No transaction history." << std::endl;
-        return;
-    }
+namespace {
     
+void printTransactionHeader(const std::string& title) {
     std::cout << "\n" << std::string(80, '=') << std::endl;
-    std::cout << "TRANSACTION HISTORY (Last " << limit << ")" << std::endl;
+    std::cout << title << std::endl;
     std::cout << std::string(80, '=') << std::endl;
-    
+        
     std::cout << std::left << std::setw(20) << "Time"
               << std::setw(8) << "Type"
               << std::setw(10) << "Symbol"
@@ -223,20 +291,60 @@ void Portfolio::displayTransactionHistory(int limit) const {
               << std::setw(12) << "Price"
               << std::setw(15) << "Total" << std::endl;
     std::cout << std::string(80, '-') << std::endl;
+}
     
-    int start = std::max(0, static_cast<int>(transactionHistory.size()) - limit);
-    
-    for (int i = transactionHistory.size() - 1; i >= start; i--) {
-        const Transaction& txn = transactionHistory[i];
-        char timeStr[20];
-        std::strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", std::localtime(&txn.timestamp));
+void printTransaction(const Transaction& txn) {
+    time_t timestamp = static_cast<time_t>(txn.timestamp);
+    char timeStr[20];
+    std::strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", std::localtime(&timestamp));
         
-        std::cout << std::left << std::setw(20) << timeStr
-                  << std::setw(8) << txn.type
-                  << std::setw(10) << txn.symbol
-                  << std::right << std::setw(10) << txn.quantity
-                  << std::setw(12) << std::fixed << std::setprecision(2) << txn.price
-                  << std::setw(15) << (txn.quantity * txn.price) << std::endl;
+    std::cout << std::left << std::setw(20) << timeStr
+              << std::setw(8) << txn.getType()
+              << std::setw(10) << SymbolTable::instance().name(txn.symbolId)
+              << std::right << std::setw(10) << txn.quantity
+              << std::setw(12) << std::fixed << std::setprecision(2) 
+              << FixedPoint::toDouble(txn.price)
+              << std::setw(15) << FixedPoint::toDouble(FixedPoint::notional(txn.price, txn.quantity)) 
+              << std::endl;
+}
+    
+}
+
+void Portfolio::displayTransactionHistory(int limit) const {
+    if (transactionHistory.empty()) {
+        std::cout << "No transaction history." << std::endl;
+        return;
+    }
+    
+    printTransactionHeader("TRANSACTION HISTORY (Last " + std::to_string(limit) + ")");
+    
+    // Only the requested tail is read, from disk if it has been spilled
+    size_t count = std::min(static_cast<size_t>(std::max(limit, 0)), transactionHistory.size());
+    std::vector<Transaction> recent;
+    recent.reserve(count);
+    transactionHistory.read(transactionHistory.size() - count, count, recent);
+    
+    for (auto it = recent.rbegin(); it != recent.rend(); ++it) {
+        printTransaction(*it);
+    }
+    
+    std::cout << std::string(80, '=') << std::endl;
+}
+
+void Portfolio::displayFills(SymbolId symbol, int64_t from, int64_t to) const {
+    // Served from the history's symbol and time indexes, oldest first
+    std::vector<Transaction> fills;
+    transactionHistory.query(symbol, from, to, fills);
+    
+    std::string title = "FILLS IN " +
+        (symbol == INVALID_SYMBOL ? std::string("ALL SYMBOLS") : SymbolTable::instance().name(symbol));
+    printTransactionHeader(title + " (" + std::to_string(fills.size()) + ")");
+    
+    for (const Transaction& txn : fills) {
+        printTransaction(txn);
+    }
+    if (fills.empty()) {
+        std::cout << "No fills in that range." << std::endl;
     }
     
     std::cout << std::string(80, '=') << std::endl;
@@ -244,18 +352,33 @@ void Portfolio::displayTransactionHistory(int limit) const {
 
 std::string Portfolio::serialize() const {
     std::ostringstream oss;
-    oss << userId << "|" << cashBalance << "|";
+    oss << userId << "|" << FixedPoint::toString(cashBalance) << ","
+        << FixedPoint::toString(realizedProfitLoss) << "," << TaxLotBook::methodName(lotMethod) << "|";
     
-    // Serialize positions
+    // Serialize positions, each with its lots as quantity@price, oldest first
     oss << positions.size() << "|";
-    for (const auto& pair : positions) {
-        const Position& pos = pair.second;
-        oss << pos.symbol << "," << pos.quantity << "," << pos.averagePrice << ";";
+    std::vector<TaxLot> lots;
+    for (const Position& pos : positions) {
+        oss << SymbolTable::instance().name(pos.symbolId) << "," << pos.quantity << "," 
+            << FixedPoint::toString(pos.averagePrice) << ",";
+        
+        lots.clear();
+        taxLots.getLots(pos.lots, lots);
+        for (size_t i = 0; i < lots.size(); i++) {
+            oss << (i > 0 ? "/" : "") << lots[i].quantity << "@" << FixedPoint::toString(lots[i].price);
+        }
+        oss << ";";
     }
     
-    // Serialize transactions
-    oss << "|" << transactionHistory.size() << "|";
-    for (const auto& txn : transactionHistory) {
+    // Serialize the transactions not already spilled to the history file
+    size_t spilled = transactionHistory.getSpilledSize();
+    std::vector<Transaction> unspilled;
+    transactionHistory.read(spilled, transactionHistory.size() - spilled, unspilled);
+    
+    // The spilled segment count goes with the count, so a load can tell
+    // the saved history apart from segments spilled after this save
+    oss << "|" << unspilled.size() << "," << spilled / TransactionLog::SEGMENT_SIZE << "|";
+    for (const auto& txn : unspilled) {
         oss << txn.serialize() << ";";
     }
     
@@ -273,7 +396,21 @@ Portfolio Portfolio::deserialize(const std::string& data) {
     std::getline(iss, txnCountStr, '|');
     std::getline(iss, txnData);
     
-    Portfolio portfolio(userId, std::stod(balanceStr));
+    // Balance, then realized P&L and lot method when saved by a version
+    // that tracks lots
+    std::istringstream balanceStream(balanceStr);
+    std::string cashStr, realizedStr, methodStr;
+    std::getline(balanceStream, cashStr, ',');
+    std::getline(balanceStream, realizedStr, ',');
+    std::getline(balanceStream, methodStr);
+    
+    Portfolio portfolio(userId, FixedPoint::parse(cashStr));
+    if (!realizedStr.empty()) {
+        portfolio.realizedProfitLoss = FixedPoint::parse(realizedStr);
+    }
+    if (methodStr == "LIFO") {
+        portfolio.lotMethod = LotMethod::Lifo;
+    }
     
     // Deserialize positions
     int posCount = std::stoi(posCountStr);
@@ -284,23 +421,61 @@ Portfolio Portfolio::deserialize(const std::string& data) {
         if (posItem.empty()) continue;
         
         std::istringstream posItemStream(posItem);
-        std::string symbol, qtyStr, priceStr;
+        std::string symbol, qtyStr, priceStr, lotData;
         
         std::getline(posItemStream, symbol, ',');
         std::getline(posItemStream, qtyStr, ',');
-        std::getline(posItemStream, priceStr);
+        std::getline(posItemStream, priceStr, ',');
+        std::getline(posItemStream, lotData);
         
-        portfolio.positions[symbol] = Position(symbol, std::stoi(qtyStr), std::stod(priceStr));
+        SymbolId symbolId = SymbolTable::instance().intern(symbol);
+        bool inserted;
+        Position& pos = portfolio.positions.upsert(symbolId, inserted);
+        if (!inserted) {
+            portfolio.removeFromTotals(pos);
+            portfolio.taxLots.close(pos.lots);
+        }
+        pos = Position(symbolId, std::stoi(qtyStr), FixedPoint::parse(priceStr));
+        pos.lots = portfolio.taxLots.open();
+        
+        // Lots must account for the whole position; otherwise (including
+        // files saved before lots were tracked) it is one lot at cost
+        std::istringstream lotStream(lotData);
+        std::string lotItem;
+        int lotQuantity = 0;
+        while (std::getline(lotStream, lotItem, '/')) {
+            size_t at = lotItem.find('@');
+            if (at == std::string::npos) break;
+            int quantity = std::stoi(lotItem.substr(0, at));
+            portfolio.taxLots.add(pos.lots, FixedPoint::parse(lotItem.substr(at + 1)), quantity);
+            lotQuantity += quantity;
+        }
+        if (lotQuantity != pos.quantity) {
+            portfolio.taxLots.close(pos.lots);
+            pos.lots = portfolio.taxLots.open();
+            portfolio.taxLots.add(pos.lots, pos.averagePrice, pos.quantity);
+        }
+        
+        portfolio.addToTotals(pos); // Marked at cost until the first price
+    }
+    
+    // Deserialize transactions, after the spilled segment count when
+    // saved by a version that records it
+    std::istringstream countStream(txnCountStr);
+    std::string inlineStr, spilledStr;
+    std::getline(countStream, inlineStr, ',');
+    std::getline(countStream, spilledStr);
+    if (!spilledStr.empty()) {
+        portfolio.transactionHistory.setSavedSpillCount(std::stoul(spilledStr));
     }
     
-    // Deserialize transactions
-    int txnCount = std::stoi(txnCountStr);
+    int txnCount = std::stoi(inlineStr);
     std::istringstream txnStream(txnData);
     std::string txnItem;
     
     for (int i = 0; i < txnCount && std::getline(txnStream, txnItem, ';'); i++) {
         if (txnItem.empty()) continue;
-        portfolio.transactionHistory.push_back(Transaction::deserialize(txnItem));
+        portfolio.transactionHistory.append(Transaction::deserialize(txnItem));
     }
     
     return portfolio;
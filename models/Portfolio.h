@@ -2,71 +2,106 @@
 #define PORTFOLIO_H
 
 #include <string>
-#include <map>
 #include <vector>
 #include "Order.h"
-
-// Structure to hold position information
-struct Position {
-    std::string symbol;
-    int quantity;
-    double averagePrice;
-    double currentValue;
-    double profitLoss;
-    
-    Position() : quantity(0), averagePrice(0.0), currentValue(0.0), profitLoss(0.0) {}
-    Position(const std::string& sym, int qty, double avgPrice)
-        : symbol(sym), quantity(qty), averagePrice(avgPrice), 
-          currentValue(0.0), profitLoss(0.0) {}
-};
-
-// Transaction record for history
-struct Transaction {
-    std::string type; // "BUY" or "SELL"
-    std::string symbol;
-    int quantity;
-    double price;
-    time_t timestamp;
-    
-    Transaction(const std::string& t, const std::string& s, int q, double p)
-        : type(t), symbol(s), quantity(q), price(p), timestamp(std::time(nullptr)) {}
-    
-    std::string serialize() const;
-    static Transaction deserialize(const std::string& data);
-};
+#include "PositionTable.h"
+#include "TransactionLog.h"
+#include "TaxLotBook.h"
+#include "PortfolioView.h"
+#include "../utils/SymbolTable.h"
+#include "../utils/FixedPoint.h"
 
 // Portfolio class demonstrating Composition (has-a relationships)
-class Portfolio {
+class Portfolio : public PortfolioView {
 private:
     std::string userId;
-    double cashBalance;
-    std::map<std::string, Position> positions; // symbol -> Position
-    std::vector<Transaction> transactionHistory;
+    Money cashBalance;
+    PositionTable positions; // SymbolId -> Position
+    TransactionLog transactionHistory;
+    TaxLotBook taxLots; // One lot queue per position
+    LotMethod lotMethod;
+    Money realizedProfitLoss;
+    Money reservedCash; // Committed to resting buy orders
+    uint32_t accountId; // Owner id in the engine this is attached to
+    
+    // Running sums of currentValue() and profitLoss() over all positions:
+    // a position is taken out before it changes and added back after
+    Money marketValue;
+    Money totalProfitLoss;
+    
+    void addToTotals(const Position& pos);
+    void removeFromTotals(const Position& pos);
+    bool checkSell(const Position* pos, int quantity) const;
 
 public:
     // Constructor
-    Portfolio(const std::string& userId, double initialBalance = 100000.0);
+    Portfolio(const std::string& userId, Money initialBalance = FixedPoint::fromUnits(100000));
     
     // Getters
     std::string getUserId() const;
-    double getCashBalance() const;
-    const std::map<std::string, Position>& getPositions() const;
-    const std::vector<Transaction>& getTransactionHistory() const;
+    Money getCashBalance() const override;
+    const PositionTable& getPositions() const;
+    const TransactionLog& getTransactionHistory() const;
+    
+    // Spill sealed history segments to `path` (see TransactionLog); once
+    // attached, serialize() writes only the history not yet on disk
+    bool attachHistoryFile(const std::string& path);
     
     // Portfolio operations
-    bool buyStock(const std::string& symbol, int quantity, double price);
-    bool sellStock(const std::string& symbol, int quantity, double price);
-    void updatePositionValues(const std::map<std::string, double>& currentPrices);
+    // Prices are indexed by SymbolId; unlisted symbols hold 0. None of
+    // these write to the console; a false return means the cash or
+    // shares are not available, and callers report it as they see fit.
+    bool canBuy(int quantity, Price price) const;
+    bool canSell(SymbolId symbol, int quantity) const;
+    bool buyStock(SymbolId symbol, int quantity, Price price);
+    bool sellStock(SymbolId symbol, int quantity, Price price);
+    
+    // Reservations for resting limit orders. A resting buy holds its
+    // notional and a resting sell its shares, so a maker can always settle
+    // a fill; canBuy() and canSell() see only what is not reserved. The
+    // caller releases a reservation before settling the fill it covers.
+    void reserveCash(Money amount);
+    void releaseCash(Money amount);
+    void reserveShares(SymbolId symbol, int quantity);
+    void releaseShares(SymbolId symbol, int quantity);
+    Money getReservedCash() const;
+    Money getAvailableCash() const;
+    int getAvailableShares(SymbolId symbol) const;
     
-    // Portfolio metrics
-    double getTotalValue(const std::map<std::string, double>& currentPrices) const;
-    double getTotalProfitLoss() const;
-    Position* getPosition(const std::string& symbol);
+    // Owner id given by the TradingEngine the portfolio is attached to, so
+    // the engine finds its account without a search; NO_ACCOUNT when
+    // detached. A portfolio is attached to one engine at a time.
+    static const uint32_t NO_ACCOUNT = static_cast<uint32_t>(-1);
+    uint32_t getAccountId() const;
+    void setAccountId(uint32_t id);
+    
+    // Mark-to-market. A new position is marked at its trade price until the
+    // first markPrice(); markPrice() returns false when the symbol is not
+    // held. updatePositionValues() re-marks every position at once.
+    bool markPrice(SymbolId symbol, Price price);
+    void updatePositionValues(const std::vector<Price>& currentPrices);
+    
+    // Portfolio metrics, read from the running totals. getTotalProfitLoss()
+    // is unrealized; sales realize P&L against the lots they consume.
+    Money getTotalValue() const override;
+    Money getMarketValue() const override;
+    Money getTotalProfitLoss() const override;
+    Money getRealizedProfitLoss() const;
+    Position* getPosition(SymbolId symbol);
+    const Position* getPosition(SymbolId symbol) const override;
+    
+    // Tax lots; the method applies to later sales
+    void setLotMethod(LotMethod method);
+    LotMethod getLotMethod() const;
+    size_t getLots(SymbolId symbol, std::vector<TaxLot>& lots) const; // Oldest first
     
     // Display
     void displayPositions() const;
     void displayTransactionHistory(int limit = 10) const;
     
+    // Fills in `symbol` (INVALID_SYMBOL for all) with from <= time <= to
+    void displayFills(SymbolId symbol, int64_t from, int64_t to) const;
+    
     // Serialization
     std::string serialize() const;
     static Portfolio deserialize(const std::string& data);
@@ -0,0 +1,138 @@
+#include "PortfolioOverlay.h"
+#include <vector>
+
+PortfolioOverlay::PortfolioOverlay(const Portfolio& base)
+    : base(&base), cashBalance(base.getCashBalance()), marketValue(base.getMarketValue()),
+      totalProfitLoss(base.getTotalProfitLoss()),
+      realizedProfitLoss(base.getRealizedProfitLoss()) {}
+
+const Portfolio& PortfolioOverlay::getBase() const {
+    return *base;
+}
+
+size_t PortfolioOverlay::getChangedCount() const {
+    return changed.size();
+}
+
+Money PortfolioOverlay::getRealizedProfitLoss() const {
+    return realizedProfitLoss;
+}
+
+Money PortfolioOverlay::getAvailableCash() const {
+    return cashBalance - base->getReservedCash();
+}
+
+Position* PortfolioOverlay::modify(SymbolId symbol) {
+    Position* pos = changed.find(symbol);
+    if (pos) {
+        return pos->quantity > 0 ? pos : nullptr;
+    }
+    
+    const Position* held = base->getPosition(symbol);
+    if (!held) return nullptr;
+    
+    bool inserted;
+    Position& copy = changed.upsert(symbol, inserted);
+    copy = *held;
+    
+    std::vector<TaxLot> lots;
+    base->getLots(symbol, lots);
+    copy.lots = taxLots.open();
+    for (const TaxLot& lot : lots) {
+        taxLots.add(copy.lots, lot.price, lot.quantity);
+    }
+    return &copy;
+}
+
+bool PortfolioOverlay::buyStock(SymbolId symbol, int quantity, Price price) {
+    Money totalCost = FixedPoint::notional(price, quantity);
+    if (quantity <= 0 || totalCost > getAvailableCash()) {
+        return false;
+    }
+    cashBalance -= totalCost;
+    
+    // The fill becomes the position's newest lot, as in the base
+    Position* pos = modify(symbol);
+    if (pos) {
+        marketValue -= pos->currentValue();
+        totalProfitLoss -= pos->profitLoss();
+        pos->quantity += quantity;
+    } else {
+        // New here, or closed earlier in this overlay
+        bool inserted;
+        pos = &changed.upsert(symbol, inserted);
+        *pos = Position(symbol, quantity, price);
+        pos->lots = taxLots.open();
+    }
+    taxLots.add(pos->lots, price, quantity);
+    pos->averagePrice = FixedPoint::divide(taxLots.getCost(pos->lots), pos->quantity);
+    
+    marketValue += pos->currentValue();
+    totalProfitLoss += pos->profitLoss();
+    return true;
+}
+
+bool PortfolioOverlay::sellStock(SymbolId symbol, int quantity, Price price) {
+    const Position* held = getPosition(symbol);
+    if (quantity <= 0 || !held || held->quantity - held->reserved < quantity) {
+        return false;
+    }
+    Money proceeds = FixedPoint::notional(price, quantity);
+    cashBalance += proceeds;
+    
+    // Realized against the lots the sale consumes; closed positions stay
+    // as quantity 0 entries, hiding the base's
+    Position* pos = modify(symbol);
+    marketValue -= pos->currentValue();
+    totalProfitLoss -= pos->profitLoss();
+    realizedProfitLoss += proceeds - taxLots.consume(pos->lots, quantity, base->getLotMethod());
+    pos->quantity -= quantity;
+    if (pos->quantity == 0) {
+        taxLots.close(pos->lots);
+        pos->lots = TaxLotBook::NONE;
+    } else {
+        pos->averagePrice = FixedPoint::divide(taxLots.getCost(pos->lots), pos->quantity);
+    }
+    marketValue += pos->currentValue();
+    totalProfitLoss += pos->profitLoss();
+    return true;
+}
+
+bool PortfolioOverlay::markPrice(SymbolId symbol, Price price) {
+    const Position* held = getPosition(symbol);
+    if (!held) return false;
+    
+    if (price > 0 && price != held->marketPrice) {
+        Position* pos = modify(symbol);
+        marketValue -= pos->currentValue();
+        totalProfitLoss -= pos->profitLoss();
+        pos->marketPrice = price;
+        marketValue += pos->currentValue();
+        totalProfitLoss += pos->profitLoss();
+    }
+    return true;
+}
+
+Money PortfolioOverlay::getCashBalance() const {
+    return cashBalance;
+}
+
+const Position* PortfolioOverlay::getPosition(SymbolId symbol) const {
+    const Position* pos = changed.find(symbol);
+    if (pos) {
+        return pos->quantity > 0 ? pos : nullptr;
+    }
+    return base->getPosition(symbol);
+}
+
+Money PortfolioOverlay::getTotalValue() const {
+    return cashBalance + marketValue;
+}
+
+Money PortfolioOverlay::getMarketValue() const {
+    return marketValue;
+}
+
+Money PortfolioOverlay::getTotalProfitLoss() const {
+    return totalProfitLoss;
+}
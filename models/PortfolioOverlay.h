@@ -0,0 +1,59 @@
+#ifndef PORTFOLIO_OVERLAY_H
+#define PORTFOLIO_OVERLAY_H
+
+#include <cstddef>
+#include "Portfolio.h"
+#include "PortfolioView.h"
+#include "PositionTable.h"
+#include "TaxLotBook.h"
+
+// A what-if variant of a portfolio: hypothetical fills and marks layered
+// over a base Portfolio without copying it. The overlay holds only the
+// cash balance, the running totals and the positions it has changed,
+// with their tax lots, so creating one is O(1) and copying one to branch
+// a scenario costs O(positions and lots changed); the base's other
+// positions and its transaction history are shared, never copied.
+//
+// Fills follow Portfolio's rules, including cash and shares committed to
+// resting orders, but fail silently, since many variants are tried at
+// once. A position's lots are copied from the base on its first change,
+// so a sale consumes them in the base's lot method and leaves the same
+// average price and realized P&L the base would have.
+//
+// The base must outlive the overlay and must not change while it is in
+// use; build a new overlay after the base trades.
+class PortfolioOverlay : public PortfolioView {
+private:
+    const Portfolio* base;
+    Money cashBalance;
+    PositionTable changed; // Positions that differ from the base; quantity 0 once closed
+    TaxLotBook taxLots;    // Lots of the changed positions
+    Money marketValue;
+    Money totalProfitLoss;
+    Money realizedProfitLoss;
+    
+    Position* modify(SymbolId symbol); // Copies the base position on first write; nullptr when not held
+
+public:
+    explicit PortfolioOverlay(const Portfolio& base);
+    
+    const Portfolio& getBase() const;
+    size_t getChangedCount() const;
+    Money getRealizedProfitLoss() const; // Including the base's
+    Money getAvailableCash() const;      // Less the base's resting buys
+    
+    // Hypothetical operations; false (and no change) when the base rules
+    // would reject them
+    bool buyStock(SymbolId symbol, int quantity, Price price);
+    bool sellStock(SymbolId symbol, int quantity, Price price);
+    bool markPrice(SymbolId symbol, Price price);
+    
+    // PortfolioView
+    Money getCashBalance() const override;
+    const Position* getPosition(SymbolId symbol) const override;
+    Money getTotalValue() const override;
+    Money getMarketValue() const override;
+    Money getTotalProfitLoss() const override;
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef PORTFOLIO_VIEW_H
+#define PORTFOLIO_VIEW_H
+
+#include "PositionTable.h"
+#include "../utils/SymbolTable.h"
+#include "../utils/FixedPoint.h"
+
+// Read-only view of an account's holdings, shared by a live Portfolio and
+// the what-if PortfolioOverlay built on top of one. Strategies and other
+// evaluators that only read holdings take a PortfolioView, so they run
+// unchanged against either.
+class PortfolioView {
+public:
+    virtual ~PortfolioView() = default;
+    
+    virtual Money getCashBalance() const = 0;
+    virtual const Position* getPosition(SymbolId symbol) const = 0; // nullptr when not held
+    
+    // Valuation at the last marks; profit and loss is unrealized
+    virtual Money getTotalValue() const = 0;
+    virtual Money getMarketValue() const = 0;
+    virtual Money getTotalProfitLoss() const = 0;
+};
+
+#endif
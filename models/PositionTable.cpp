@@ -0,0 +1,143 @@
+#include "PositionTable.h"
+
+const uint32_t PositionTable::EMPTY;
+const size_t PositionTable::MIN_SLOTS;
+
+PositionTable::PositionTable() : mask(0), shift(32) {}
+
+size_t PositionTable::homeSlot(SymbolId symbol) const {
+    // Fibonacci hashing: the top bits of the product spread the dense,
+    // sequential symbol ids across the index
+    return static_cast<uint32_t>(symbol * 2654435769u) >> shift;
+}
+
+size_t PositionTable::probe(SymbolId symbol) const {
+    size_t slot = homeSlot(symbol);
+    while (slots[slot] != EMPTY && entries[slots[slot]].symbolId != symbol) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void PositionTable::rehash(size_t slotCount) {
+    slots.assign(slotCount, EMPTY);
+    mask = slotCount - 1;
+    shift = 32;
+    for (size_t n = slotCount; n > 1; n >>= 1) {
+        shift--;
+    }
+    
+    for (size_t i = 0; i < entries.size(); i++) {
+        size_t slot = probe(entries[i].symbolId);
+        slots[slot] = static_cast<uint32_t>(i);
+        entrySlots[i] = static_cast<uint32_t>(slot);
+    }
+}
+
+Position* PositionTable::find(SymbolId symbol) {
+    if (entries.empty()) return nullptr;
+    uint32_t entry = slots[probe(symbol)];
+    return entry != EMPTY ? &entries[entry] : nullptr;
+}
+
+const Position* PositionTable::find(SymbolId symbol) const {
+    if (entries.empty()) return nullptr;
+    uint32_t entry = slots[probe(symbol)];
+    return entry != EMPTY ? &entries[entry] : nullptr;
+}
+
+Position& PositionTable::upsert(SymbolId symbol, bool& inserted) {
+    // Keep the load factor at or below one half
+    if ((entries.size() + 1) * 2 > slots.size()) {
+        rehash(slots.empty() ? MIN_SLOTS : slots.size() * 2);
+    }
+    
+    size_t slot = probe(symbol);
+    inserted = (slots[slot] == EMPTY);
+    if (inserted) {
+        slots[slot] = static_cast<uint32_t>(entries.size());
+        entrySlots.push_back(static_cast<uint32_t>(slot));
+        entries.push_back(Position());
+        entries.back().symbolId = symbol;
+    }
+    return entries[slots[slot]];
+}
+
+void PositionTable::erase(Position* position) {
+    size_t entry = static_cast<size_t>(position - entries.data());
+    size_t hole = entrySlots[entry];
+    
+    // Backward-shift deletion: pull later members of the probe chain into
+    // the hole when the hole lies between their home slot and their slot
+    size_t next = (hole + 1) & mask;
+    while (slots[next] != EMPTY) {
+        size_t home = homeSlot(entries[slots[next]].symbolId);
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            slots[hole] = slots[next];
+            entrySlots[slots[hole]] = static_cast<uint32_t>(hole);
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+    slots[hole] = EMPTY;
+    
+    // Keep the entries dense: the last one moves into the gap
+    size_t last = entries.size() - 1;
+    if (entry != last) {
+        entries[entry] = entries[last];
+        entrySlots[entry] = entrySlots[last];
+        slots[entrySlots[entry]] = static_cast<uint32_t>(entry);
+    }
+    entries.pop_back();
+    entrySlots.pop_back();
+}
+
+bool PositionTable::erase(SymbolId symbol) {
+    Position* position = find(symbol);
+    if (!position) return false;
+    erase(position);
+    return true;
+}
+
+void PositionTable::clear() {
+    entries.clear();
+    entrySlots.clear();
+    slots.assign(slots.size(), EMPTY);
+}
+
+void PositionTable::reserve(size_t positions) {
+    size_t slotCount = slots.empty() ? MIN_SLOTS : slots.size();
+    while (slotCount < positions * 2) {
+        slotCount *= 2;
+    }
+    
+    entries.reserve(positions);
+    entrySlots.reserve(positions);
+    if (slotCount != slots.size()) {
+        rehash(slotCount);
+    }
+}
+
+size_t PositionTable::size() const {
+    return entries.size();
+}
+
+bool PositionTable::empty() const {
+    return entries.empty();
+}
+
+PositionTable::iterator PositionTable::begin() {
+    return entries.begin();
+}
+
+PositionTable::iterator PositionTable::end() {
+    return entries.end();
+}
+
+PositionTable::const_iterator PositionTable::begin() const {
+    return entries.begin();
+}
+
+PositionTable::const_iterator PositionTable::end() const {
+    return entries.end();
+}
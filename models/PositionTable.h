@@ -0,0 +1,86 @@
+#ifndef POSITION_TABLE_H
+#define POSITION_TABLE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "../utils/SymbolTable.h"
+#include "../utils/FixedPoint.h"
+
+// Structure to hold position information, packed to 32 bytes
+// Prices and amounts are fixed-point ticks (see FixedPoint.h)
+struct Position {
+    SymbolId symbolId;
+    int32_t quantity;
+    Price averagePrice;
+    Price marketPrice; // Last mark
+    uint32_t lots;     // Tax lot queue in the owning portfolio's TaxLotBook
+    int32_t reserved;  // Shares committed to resting sell orders
+    
+    Position() : symbolId(INVALID_SYMBOL), quantity(0), averagePrice(0), marketPrice(0),
+                 lots(static_cast<uint32_t>(-1)), reserved(0) {}
+    Position(SymbolId sym, int qty, Price avgPrice)
+        : symbolId(sym), quantity(qty), averagePrice(avgPrice), marketPrice(avgPrice),
+          lots(static_cast<uint32_t>(-1)), reserved(0) {}
+    
+    // Valuation at the last mark
+    Money costBasis() const { return FixedPoint::notional(averagePrice, quantity); }
+    Money currentValue() const { return FixedPoint::notional(marketPrice, quantity); }
+    Money profitLoss() const { return currentValue() - costBasis(); }
+};
+
+// Flat position store keyed by SymbolId. Positions sit densely in one
+// vector, so iterating a portfolio is a linear sweep; a linear-probing
+// index of 32-bit slots maps each symbol to its entry. Lookups and upserts
+// are one probe sequence, and erasing through a found entry needs none:
+// each entry remembers its slot, and deletion shifts the probe chain back
+// instead of leaving tombstones.
+//
+// upsert() and erase() may move entries, invalidating pointers into the
+// table. Iteration order is insertion order, perturbed by erases.
+class PositionTable {
+public:
+    typedef std::vector<Position>::iterator iterator;
+    typedef std::vector<Position>::const_iterator const_iterator;
+    
+    static const uint32_t EMPTY = static_cast<uint32_t>(-1);
+    static const size_t MIN_SLOTS = 16;
+
+private:
+    std::vector<Position> entries;
+    std::vector<uint32_t> entrySlots; // Entry -> its slot in the index
+    std::vector<uint32_t> slots;      // Index: entry number or EMPTY
+    size_t mask;
+    unsigned shift; // 32 - log2(slot count)
+    
+    size_t homeSlot(SymbolId symbol) const;
+    size_t probe(SymbolId symbol) const; // Slot holding `symbol`, or the empty slot ending its chain
+    void rehash(size_t slotCount);
+
+public:
+    PositionTable();
+    
+    // Lookup
+    Position* find(SymbolId symbol);
+    const Position* find(SymbolId symbol) const;
+    
+    // Find or insert in a single probe; a new entry is default-constructed
+    // with its symbolId set and `inserted` is true
+    Position& upsert(SymbolId symbol, bool& inserted);
+    
+    // Removal
+    void erase(Position* position); // Must point into this table
+    bool erase(SymbolId symbol);
+    void clear();
+    void reserve(size_t positions);
+    
+    size_t size() const;
+    bool empty() const;
+    
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+};
+
+#endif
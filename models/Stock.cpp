@@ -5,13 +5,31 @@
 #include <sstream>
 #include <numeric>
 #include <algorithm>
+#include <cmath>
 
-Stock::Stock() : symbol(""), name(""), currentPrice(0.0), lastUpdate(std::time(nullptr)) {
+const size_t Stock::DEFAULT_HISTORY_DEPTH;
+
+namespace {
+    // Periods used by the stock details screen and the default strategies
+    const int DEFAULT_WINDOWS[] = {5, 10, 20};
+}
+
+Stock::Stock() 
+    : symbol(""), name(""), currentPrice(0), priceHistory(DEFAULT_HISTORY_DEPTH),
+      lastUpdate(std::time(nullptr)) {
+    for (int period : DEFAULT_WINDOWS) {
+        registerWindow(period);
+    }
 }
 
-Stock::Stock(const std::string& symbol, const std::string& name, double initialPrice)
-    : symbol(symbol), name(name), currentPrice(initialPrice), lastUpdate(std::time(nullptr)) {
-    priceHistory.push_back(initialPrice);
+Stock::Stock(const std::string& symbol, const std::string& name, Price initialPrice,
+             size_t historyDepth)
+    : symbol(symbol), name(name), currentPrice(initialPrice), priceHistory(historyDepth),
+      lastUpdate(std::time(nullptr)) {
+    for (int period : DEFAULT_WINDOWS) {
+        registerWindow(period);
+    }
+    addPriceToHistory(FixedPoint::toDouble(initialPrice));
 }
 
 std::string Stock::getSymbol() const {
@@ -22,35 +40,96 @@ std::string Stock::getName() const {
     return name;
 }
 
-double Stock::getCurrentPrice() const {
+Price Stock::getCurrentPrice() const {
     return currentPrice;
 }
 
-const std::vector<double>& Stock::getPriceHistory() const {
-    return priceHistory;
+PriceHistoryView Stock::getPriceHistory() const {
+    return priceHistory.view();
+}
+
+size_t Stock::getHistoryDepth() const {
+    return priceHistory.capacity();
 }
 
 time_t Stock::getLastUpdate() const {
     return lastUpdate;
 }
 
-void Stock::setCurrentPrice(double price) {
+void Stock::setCurrentPrice(Price price) {
     currentPrice = price;
     lastUpdate = std::time(nullptr);
-    addPriceToHistory(price);
+    addPriceToHistory(FixedPoint::toDouble(price));
 }
 
 void Stock::addPriceToHistory(double price) {
+    PriceHistoryView history = priceHistory.view();
+    bool rebuildDue = false;
+    
+    for (auto& window : windows) {
+        window.push(price, history);
+        rebuildDue = rebuildDue || window.needsRebuild();
+    }
+    
+    // Ring buffer overwrites the oldest price once the depth is reached
     priceHistory.push_back(price);
-    // Keep only last 100 prices to save memory
-    if (priceHistory.size() > 100) {
-        priceHistory.erase(priceHistory.begin());
+    
+    if (rebuildDue) {
+        rebuildWindows();
+    }
+}
+
+void Stock::setHistoryDepth(size_t depth) {
+    priceHistory.setCapacity(depth);
+    
+    for (auto& window : windows) {
+        window.setDepth(priceHistory.capacity());
+    }
+    rebuildWindows();
+}
+
+void Stock::loadHistory(const PriceHistoryView& history) {
+    priceHistory.clear();
+    for (double price : history) {
+        priceHistory.push_back(price);
+    }
+    rebuildWindows();
+}
+
+std::vector<int> Stock::getDefaultWindows() {
+    return std::vector<int>(std::begin(DEFAULT_WINDOWS), std::end(DEFAULT_WINDOWS));
+}
+
+void Stock::registerWindow(int period) {
+    if (period <= 0 || findWindow(period)) return;
+    
+    windows.push_back(RollingWindow(period, priceHistory.capacity()));
+    windows.back().rebuild(priceHistory.view());
+}
+
+const RollingWindow* Stock::findWindow(int period) const {
+    for (const auto& window : windows) {
+        if (window.period == period) return &window;
+    }
+    return nullptr;
+}
+
+void Stock::rebuildWindows() {
+    PriceHistoryView history = priceHistory.view();
+    for (auto& window : windows) {
+        window.rebuild(history);
     }
 }
 
 double Stock::getMovingAverage(int period) const {
     if (priceHistory.empty()) return 0.0;
     
+    const RollingWindow* window = findWindow(period);
+    if (window) {
+        return window->mean(priceHistory.size());
+    }
+    
+    // Unregistered period: sum the window directly
     int count = std::min(period, static_cast<int>(priceHistory.size()));
     double sum = 0.0;
     
@@ -61,29 +140,50 @@ double Stock::getMovingAverage(int period) const {
     return sum / count;
 }
 
-double Stock::getPriceChange() const {
-    if (priceHistory.size() < 2) return 0.0;
-    return currentPrice - priceHistory[priceHistory.size() - 2];
+double Stock::getVariance(int period) const {
+    if (priceHistory.empty()) return 0.0;
+    
+    const RollingWindow* window = findWindow(period);
+    if (window) {
+        return window->variance(priceHistory.size());
+    }
+    
+    RollingWindow scratch(period, priceHistory.capacity());
+    scratch.rebuild(priceHistory.view());
+    return scratch.variance(priceHistory.size());
+}
+
+double Stock::getStdDev(int period) const {
+    return std::sqrt(getVariance(period));
+}
+
+Price Stock::getPriceChange() const {
+    if (priceHistory.size() < 2) return 0;
+    return currentPrice - FixedPoint::toTicks(priceHistory[priceHistory.size() - 2]);
 }
 
 double Stock::getPriceChangePercent() const {
     if (priceHistory.size() < 2 || priceHistory[priceHistory.size() - 2] == 0) return 0.0;
-    return (getPriceChange() / priceHistory[priceHistory.size() - 2]) * 100.0;
+    return (FixedPoint::toDouble(getPriceChange()) / priceHistory[priceHistory.size() - 2]) * 100.0;
 }
 
 void Stock::display() const {
-    double change = getPriceChange();
-    double changePercent = getPriceChangePercent();
+    displayQuote(symbol, name, currentPrice, getPriceChange(), getPriceChangePercent());
+}
+
+void Stock::displayQuote(const std::string& symbol, const std::string& name,
+                         Price currentPrice, Price priceChange, double changePercent) {
+    double change = FixedPoint::toDouble(priceChange);
     
     std::cout << Colors::BOLD_CYAN << std::left << std::setw(8) << symbol << Colors::RESET
               << std::setw(20) << name
-              << Colors::BOLD_WHITE << std::right << std::setw(10) << std::fixed << std::setprecision(2) << currentPrice << Colors::RESET;
+              << Colors::BOLD_WHITE << std::right << std::setw(10) << std::fixed << std::setprecision(2) << FixedPoint::toDouble(currentPrice) << Colors::RESET;
     
     // Color code the change
-    if (change > 0) {
+    if (priceChange > 0) {
         std::cout << Colors::PROFIT << std::setw(12) << Symbols::ARROW_UP << " " << change
                   << std::setw(9) << changePercent << "%" << Colors::RESET;
-    } else if (change < 0) {
+    } else if (priceChange < 0) {
         std::cout << Colors::LOSS << std::setw(12) << Symbols::ARROW_DOWN << " " << change
                   << std::setw(9) << changePercent << "%" << Colors::RESET;
     } else {
@@ -94,12 +194,12 @@ void Stock::display() const {
 
 std::string Stock::serialize() const {
     std::ostringstream oss;
-    oss << symbol << "|" << name << "|" << currentPrice << "|";
+    oss << symbol << "|" << name << "|" << FixedPoint::toString(currentPrice) << "|";
     
-    // Serialize price history
-    for (size_t i = 0; i < priceHistory.size(); i++) {
-        oss << priceHistory[i];
-        if (i < priceHistory.size() - 1) oss << ",";
+    // Serialize price history (oldest first) as exact tick decimals
+    for (PriceHistoryView::const_iterator it = priceHistory.begin(); it != priceHistory.end(); ++it) {
+        if (it != priceHistory.begin()) oss << ",";
+        oss << FixedPoint::toString(FixedPoint::toTicks(*it));
     }
     
     return oss.str();
@@ -114,17 +214,17 @@ Stock Stock::deserialize(const std::string& data) {
     std::getline(iss, priceStr, '|');
     std::getline(iss, historyStr);
     
-    double price = std::stod(priceStr);
-    Stock stock(symbol, name, price);
+    Stock stock(symbol, name, FixedPoint::parse(priceStr));
     
     // Deserialize price history
     stock.priceHistory.clear();
+    stock.rebuildWindows();
     std::istringstream historyStream(historyStr);
     std::string priceItem;
     
     while (std::getline(historyStream, priceItem, ',')) {
         if (!priceItem.empty()) {
-            stock.priceHistory.push_back(std::stod(priceItem));
+            stock.addPriceToHistory(FixedPoint::toDouble(FixedPoint::parse(priceItem)));
         }
     }
     
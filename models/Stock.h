@@ -4,38 +4,66 @@
 #include <string>
 #include <vector>
 #include <ctime>
+#include <cstddef>
+#include "../utils/RingBuffer.h"
+#include "../utils/RollingWindow.h"
+#include "../utils/FixedPoint.h"
+
+// Read-only, non-copying view of a stock's price history (oldest -> newest).
+// History feeds the indicators, so it is kept in floating point.
+typedef RingView<double> PriceHistoryView;
 
 class Stock {
+public:
+    // Number of prices kept per symbol unless configured otherwise
+    static const size_t DEFAULT_HISTORY_DEPTH = 100;
+
 private:
     std::string symbol;
     std::string name;
-    double currentPrice;
-    std::vector<double> priceHistory;
+    Price currentPrice;
+    RingBuffer<double> priceHistory;
+    std::vector<RollingWindow> windows; // Incrementally maintained indicators
     time_t lastUpdate;
+    
+    const RollingWindow* findWindow(int period) const;
+    void rebuildWindows();
 
 public:
     // Constructors
     Stock(); // Default constructor for std::map
-    Stock(const std::string& symbol, const std::string& name, double initialPrice);
+    Stock(const std::string& symbol, const std::string& name, Price initialPrice,
+          size_t historyDepth = DEFAULT_HISTORY_DEPTH);
     
     // Getters (Encapsulation)
     std::string getSymbol() const;
     std::string getName() const;
-    double getCurrentPrice() const;
-    const std::vector<double>& getPriceHistory() const;
+    Price getCurrentPrice() const;
+    PriceHistoryView getPriceHistory() const;
+    size_t getHistoryDepth() const;
     time_t getLastUpdate() const;
     
     // Setters
-    void setCurrentPrice(double price);
+    void setCurrentPrice(Price price);
     void addPriceToHistory(double price);
+    void setHistoryDepth(size_t depth);
+    void loadHistory(const PriceHistoryView& history);
+    
+    // Indicator windows: registered periods answer queries in O(1)
+    void registerWindow(int period);
+    static std::vector<int> getDefaultWindows();
     
     // Business methods
     double getMovingAverage(int period) const;
-    double getPriceChange() const;
+    double getVariance(int period) const;
+    double getStdDev(int period) const;
+    Price getPriceChange() const;
     double getPriceChangePercent() const;
     
     // Display
     void display() const;
+    static void displayQuote(const std::string& symbol, const std::string& name,
+                             Price price, Price change, double changePercent);
     
     // Serialization
     std::string serialize() const;
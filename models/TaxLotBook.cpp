@@ -0,0 +1,129 @@
+#include "TaxLotBook.h"
+#include <algorithm>
+
+const uint32_t TaxLotBook::NONE;
+const size_t TaxLotBook::MIN_CAPACITY;
+const size_t TaxLotBook::RETAINED_CAPACITY;
+
+TaxLot& TaxLotBook::at(Queue& queue, size_t i) {
+    size_t pos = queue.head + i;
+    if (pos >= queue.ring.size()) pos -= queue.ring.size();
+    return queue.ring[pos];
+}
+
+const TaxLot& TaxLotBook::at(const Queue& queue, size_t i) {
+    size_t pos = queue.head + i;
+    if (pos >= queue.ring.size()) pos -= queue.ring.size();
+    return queue.ring[pos];
+}
+
+void TaxLotBook::grow(Queue& queue) {
+    std::vector<TaxLot> resized(std::max(MIN_CAPACITY, queue.ring.size() * 2));
+    for (size_t i = 0; i < queue.count; i++) {
+        resized[i] = at(queue, i);
+    }
+    queue.ring.swap(resized);
+    queue.head = 0;
+}
+
+uint32_t TaxLotBook::open() {
+    uint32_t queue;
+    if (!freeQueues.empty()) {
+        queue = freeQueues.back();
+        freeQueues.pop_back();
+    } else {
+        queues.push_back(Queue());
+        queue = static_cast<uint32_t>(queues.size() - 1);
+    }
+    
+    Queue& state = queues[queue];
+    state.head = 0;
+    state.count = 0;
+    state.cost = 0;
+    return queue;
+}
+
+void TaxLotBook::close(uint32_t queue) {
+    Queue& state = queues[queue];
+    if (state.ring.size() > RETAINED_CAPACITY) {
+        std::vector<TaxLot>().swap(state.ring);
+    }
+    state.count = 0;
+    state.cost = 0;
+    freeQueues.push_back(queue);
+}
+
+void TaxLotBook::clear() {
+    queues.clear();
+    freeQueues.clear();
+}
+
+void TaxLotBook::add(uint32_t queue, Price price, int32_t quantity) {
+    Queue& state = queues[queue];
+    state.cost += FixedPoint::notional(price, quantity);
+    
+    // Repeated buys at one price extend the newest lot
+    if (state.count > 0) {
+        TaxLot& newest = at(state, state.count - 1);
+        if (newest.price == price) {
+            newest.quantity += quantity;
+            return;
+        }
+    }
+    
+    if (state.count == state.ring.size()) {
+        grow(state);
+    }
+    TaxLot& lot = at(state, state.count);
+    lot.price = price;
+    lot.quantity = quantity;
+    state.count++;
+}
+
+Money TaxLotBook::consume(uint32_t queue, int32_t quantity, LotMethod method) {
+    Queue& state = queues[queue];
+    Money consumed = 0;
+    
+    while (quantity > 0 && state.count > 0) {
+        bool oldest = (method == LotMethod::Fifo);
+        TaxLot& lot = oldest ? at(state, 0) : at(state, state.count - 1);
+        int32_t taken = std::min(quantity, lot.quantity);
+        
+        consumed += FixedPoint::notional(lot.price, taken);
+        lot.quantity -= taken;
+        quantity -= taken;
+        
+        if (lot.quantity == 0) {
+            if (oldest) {
+                state.head = (state.head + 1 == state.ring.size()) ? 0 : state.head + 1;
+            }
+            state.count--;
+        }
+    }
+    
+    if (state.count == 0) {
+        state.head = 0;
+    }
+    state.cost -= consumed;
+    return consumed;
+}
+
+Money TaxLotBook::getCost(uint32_t queue) const {
+    return queues[queue].cost;
+}
+
+size_t TaxLotBook::getLotCount(uint32_t queue) const {
+    return queues[queue].count;
+}
+
+size_t TaxLotBook::getLots(uint32_t queue, std::vector<TaxLot>& lots) const {
+    const Queue& state = queues[queue];
+    for (size_t i = 0; i < state.count; i++) {
+        lots.push_back(at(state, i));
+    }
+    return state.count;
+}
+
+const char* TaxLotBook::methodName(LotMethod method) {
+    return method == LotMethod::Lifo ? "LIFO" : "FIFO";
+}
@@ -0,0 +1,67 @@
+#ifndef TAX_LOT_BOOK_H
+#define TAX_LOT_BOOK_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "../utils/FixedPoint.h"
+
+// Shares bought in one fill (or consecutive fills at the same price)
+struct TaxLot {
+    Price price;
+    int32_t quantity;
+};
+
+// Which lots a sale consumes first
+enum class LotMethod : uint8_t {
+    Fifo, // Oldest lots first
+    Lifo  // Newest lots first
+};
+
+// The tax lots of every position in one portfolio. Each position owns a
+// queue: a growable ring of lots, oldest to newest, plus its exact cost.
+// Buys append at the newest end; a sale consumes whole and partial lots
+// from either end, so it costs O(lots consumed). Consecutive buys at the
+// same price share a lot, and closed queues are recycled through a free
+// list, so intraday churn reuses the same ring slots instead of growing.
+class TaxLotBook {
+public:
+    static const uint32_t NONE = static_cast<uint32_t>(-1);
+    static const size_t MIN_CAPACITY = 4;
+    static const size_t RETAINED_CAPACITY = 64; // Larger rings are freed on close
+
+private:
+    struct Queue {
+        std::vector<TaxLot> ring;
+        uint32_t head;  // Physical index of the oldest lot
+        uint32_t count;
+        Money cost;     // Sum of price x quantity over the lots
+    };
+    
+    std::vector<Queue> queues;
+    std::vector<uint32_t> freeQueues;
+    
+    static TaxLot& at(Queue& queue, size_t i);
+    static const TaxLot& at(const Queue& queue, size_t i);
+    static void grow(Queue& queue);
+
+public:
+    // Queue lifetime
+    uint32_t open();
+    void close(uint32_t queue);
+    void clear();
+    
+    // Add shares at `price` as the newest lot
+    void add(uint32_t queue, Price price, int32_t quantity);
+    
+    // Remove `quantity` shares in `method` order; returns their cost
+    Money consume(uint32_t queue, int32_t quantity, LotMethod method);
+    
+    Money getCost(uint32_t queue) const;
+    size_t getLotCount(uint32_t queue) const;
+    size_t getLots(uint32_t queue, std::vector<TaxLot>& lots) const; // Oldest first
+    
+    static const char* methodName(LotMethod method);
+};
+
+#endif
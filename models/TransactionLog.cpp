@@ -0,0 +1,729 @@
+#include "TransactionLog.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+
+const size_t TransactionLog::SEGMENT_SIZE;
+const size_t TransactionLog::SEGMENT_BYTES;
+const size_t TransactionLog::UNKNOWN_COUNT;
+
+// Transaction implementation
+const char* Transaction::getType() const {
+    return Order::sideName(side);
+}
+
+std::string Transaction::serialize() const {
+    std::ostringstream oss;
+    oss << getType() << "|" << SymbolTable::instance().name(symbolId) << "|" << quantity << "|"
+        << FixedPoint::toString(price) << "|" << timestamp;
+    return oss.str();
+}
+
+Transaction Transaction::deserialize(const std::string& data) {
+    std::istringstream iss(data);
+    std::string type, symbol, qtyStr, priceStr, timeStr;
+    
+    std::getline(iss, type, '|');
+    std::getline(iss, symbol, '|');
+    std::getline(iss, qtyStr, '|');
+    std::getline(iss, priceStr, '|');
+    std::getline(iss, timeStr);
+    
+    Transaction txn(type == "SELL" ? OrderSide::Sell : OrderSide::Buy,
+                    SymbolTable::instance().intern(symbol), std::stoi(qtyStr),
+                    FixedPoint::parse(priceStr));
+    txn.timestamp = std::stoll(timeStr);
+    
+    return txn;
+}
+
+// TransactionLog implementation
+namespace {
+    
+std::string symbolsPath(const std::string& spillPath) {
+    return spillPath + ".symbols";
+}
+    
+std::string indexPath(const std::string& spillPath) {
+    return spillPath + ".idx";
+}
+    
+// Open for update without truncating, creating the file if needed
+bool openForUpdate(std::fstream& file, const std::string& path) {
+    file.open(path, std::ios::binary | std::ios::in | std::ios::out);
+    if (!file.is_open()) {
+        file.open(path, std::ios::binary | std::ios::out);
+    }
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open transaction log " << path
+                  << " for writing." << std::endl;
+        return false;
+    }
+    return true;
+}
+    
+}
+
+TransactionLog::TransactionLog()
+    : spilledCount(0), spillOwner(false), savedSpillCount(UNKNOWN_COUNT), indexEnd(0),
+      latestTime(0), timeOrdered(true) {}
+
+TransactionLog::TransactionLog(const TransactionLog& other)
+    : sealed(other.sealed), head(other.head), spilledCount(other.spilledCount),
+      spillPath(other.spillPath), spillOwner(false), savedSpillCount(other.savedSpillCount),
+      fileSymbols(other.fileSymbols), fileIndex(other.fileIndex),
+      blockOffsets(other.blockOffsets), indexEnd(other.indexEnd), postings(other.postings),
+      spilledSegments(other.spilledSegments), segmentTimes(other.segmentTimes), latestTime(other.latestTime),
+      timeOrdered(other.timeOrdered) {}
+
+TransactionLog& TransactionLog::operator=(const TransactionLog& other) {
+    if (this != &other) {
+        sealed = other.sealed;
+        head = other.head;
+        spilledCount = other.spilledCount;
+        spillPath = other.spillPath;
+        spillOwner = false;
+        savedSpillCount = other.savedSpillCount;
+        fileSymbols = other.fileSymbols;
+        fileIndex = other.fileIndex;
+        blockOffsets = other.blockOffsets;
+        indexEnd = other.indexEnd;
+        postings = other.postings;
+        spilledSegments = other.spilledSegments;
+        segmentTimes = other.segmentTimes;
+        latestTime = other.latestTime;
+        timeOrdered = other.timeOrdered;
+    }
+    return *this;
+}
+
+void TransactionLog::append(const Transaction& txn) {
+    indexRecord(txn, size());
+    head.push_back(txn);
+    if (head.size() == SEGMENT_SIZE) {
+        seal();
+    }
+}
+
+void TransactionLog::seal() {
+    segmentTimes.push_back(timeRange(head));
+    sealed.push_back(std::make_shared<const std::vector<Transaction>>(head));
+    head.clear();
+    
+    if (spillOwner) {
+        spill();
+    }
+}
+
+bool TransactionLog::spill() {
+    if (spilledCount == sealed.size()) return true;
+    
+    // Records go out with ticker list indices; new tickers are listed
+    // before any segment that uses them
+    std::vector<std::vector<Transaction>> mapped;
+    for (size_t segment = spilledCount; segment < sealed.size(); segment++) {
+        mapped.push_back(*sealed[segment]);
+        for (Transaction& txn : mapped.back()) {
+            if (!mapFileSymbol(txn.symbolId, txn.symbolId)) return false;
+        }
+    }
+    
+    // Write at the segment boundary rather than appending, so a segment
+    // torn by an interrupted write is overwritten
+    std::fstream file;
+    if (!openForUpdate(file, spillPath)) return false;
+    file.seekp(static_cast<std::streamoff>(spilledCount * SEGMENT_BYTES));
+    for (const std::vector<Transaction>& records : mapped) {
+        file.write(reinterpret_cast<const char*>(records.data()), SEGMENT_BYTES);
+    }
+    file.close();
+    
+    if (!file) {
+        std::cerr << "Error: Could not write transaction log " << spillPath << std::endl;
+        return false;
+    }
+    
+    // Index blocks follow their segments; a segment whose block is lost
+    // is indexed again on the next attach
+    std::fstream index;
+    if (!openForUpdate(index, indexPath(spillPath))) return false;
+    index.seekp(static_cast<std::streamoff>(indexEnd));
+    std::vector<char> block;
+    uint64_t end = indexEnd;
+    std::vector<uint64_t> offsets;
+    for (size_t i = 0; i < mapped.size(); i++) {
+        encodeBlock(mapped[i], fileSymbols.size(), block);
+        index.write(block.data(), block.size());
+        BlockHeader header;
+        std::memcpy(&header, block.data(), sizeof(BlockHeader));
+        noteSpilledSymbols(spilledCount + i,
+                           reinterpret_cast<const BlockEntry*>(block.data() + sizeof(BlockHeader)),
+                           header.symbolCount);
+        offsets.push_back(end);
+        end += block.size();
+    }
+    index.close();
+    
+    if (!index) {
+        std::cerr << "Error: Could not write transaction log index " << indexPath(spillPath)
+                  << std::endl;
+        return false;
+    }
+    blockOffsets.insert(blockOffsets.end(), offsets.begin(), offsets.end());
+    indexEnd = end;
+    
+    // Written segments are dropped from memory, with their postings
+    for (size_t segment = spilledCount; segment < sealed.size(); segment++) {
+        sealed[segment].reset();
+    }
+    spilledCount = sealed.size();
+    
+    uint32_t boundary = static_cast<uint32_t>(getSpilledSize());
+    for (std::vector<uint32_t>& list : postings) {
+        list.erase(list.begin(), std::lower_bound(list.begin(), list.end(), boundary));
+    }
+    return true;
+}
+
+bool TransactionLog::readSpilled(size_t segment, size_t offset, size_t count,
+                                 std::vector<Transaction>& out) const {
+    std::ifstream file(spillPath, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open transaction log " << spillPath
+                  << " for reading." << std::endl;
+        return false;
+    }
+    
+    size_t start = out.size();
+    out.resize(start + count);
+    file.seekg(static_cast<std::streamoff>(segment * SEGMENT_BYTES + offset * sizeof(Transaction)));
+    if (!file.read(reinterpret_cast<char*>(&out[start]), count * sizeof(Transaction))) {
+        out.resize(start);
+        return false;
+    }
+    for (size_t i = start; i < out.size(); i++) {
+        out[i].symbolId = fromFileSymbol(out[i].symbolId);
+    }
+    return true;
+}
+
+bool TransactionLog::loadFileSymbols(const std::string& path) {
+    fileSymbols.clear();
+    fileIndex.clear();
+    
+    std::ifstream file(symbolsPath(path));
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        SymbolId id = SymbolTable::instance().intern(line);
+        if (id >= fileIndex.size()) {
+            fileIndex.resize(id + 1, 0);
+        }
+        fileSymbols.push_back(id);
+        fileIndex[id] = static_cast<uint32_t>(fileSymbols.size());
+    }
+    return true;
+}
+
+bool TransactionLog::mapFileSymbol(SymbolId symbol, uint32_t& index) {
+    if (symbol >= fileIndex.size()) {
+        fileIndex.resize(symbol + 1, 0);
+    }
+    if (fileIndex[symbol] == 0) {
+        std::ofstream file(symbolsPath(spillPath), std::ios::app);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open transaction log symbols for writing." << std::endl;
+            return false;
+        }
+        file << SymbolTable::instance().name(symbol) << std::endl;
+        if (!file) {
+            std::cerr << "Error: Could not write transaction log symbols." << std::endl;
+            return false;
+        }
+        fileSymbols.push_back(symbol);
+        fileIndex[symbol] = static_cast<uint32_t>(fileSymbols.size());
+    }
+    
+    index = fileIndex[symbol] - 1;
+    return true;
+}
+
+SymbolId TransactionLog::fromFileSymbol(uint32_t index) const {
+    return index < fileSymbols.size() ? fileSymbols[index] : INVALID_SYMBOL;
+}
+
+void TransactionLog::encodeBlock(const std::vector<Transaction>& records, size_t symbols,
+                                 std::vector<char>& block) {
+    // Counting sort of segment offsets by ticker list index; records
+    // outside the list are left out of the postings
+    std::vector<uint32_t> counts(symbols, 0);
+    for (const Transaction& txn : records) {
+        if (txn.symbolId < symbols) counts[txn.symbolId]++;
+    }
+    
+    BlockHeader header;
+    TimeRange range = timeRange(records);
+    header.earliest = range.earliest;
+    header.latest = range.latest;
+    header.symbolCount = 0;
+    header.ordered = 1;
+    
+    std::vector<BlockEntry> entries;
+    std::vector<size_t> starts(symbols, 0);
+    size_t listed = 0;
+    for (size_t symbol = 0; symbol < symbols; symbol++) {
+        if (counts[symbol] == 0) continue;
+        BlockEntry entry = {static_cast<uint32_t>(symbol), counts[symbol]};
+        entries.push_back(entry);
+        starts[symbol] = listed;
+        listed += counts[symbol];
+    }
+    header.symbolCount = static_cast<uint32_t>(entries.size());
+    
+    std::vector<uint16_t> offsets(listed);
+    for (size_t i = 0; i < records.size(); i++) {
+        if (i > 0 && records[i].timestamp < records[i - 1].timestamp) {
+            header.ordered = 0;
+        }
+        if (records[i].symbolId < symbols) {
+            offsets[starts[records[i].symbolId]++] = static_cast<uint16_t>(i);
+        }
+    }
+    
+    block.resize(sizeof(BlockHeader) + entries.size() * sizeof(BlockEntry) +
+                 offsets.size() * sizeof(uint16_t));
+    char* out = block.data();
+    std::memcpy(out, &header, sizeof(BlockHeader));
+    out += sizeof(BlockHeader);
+    std::memcpy(out, entries.data(), entries.size() * sizeof(BlockEntry));
+    out += entries.size() * sizeof(BlockEntry);
+    std::memcpy(out, offsets.data(), offsets.size() * sizeof(uint16_t));
+}
+
+void TransactionLog::noteSpilledSymbols(size_t segment, const BlockEntry* entries,
+                                        size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        SymbolId symbol = fromFileSymbol(entries[i].symbol);
+        if (symbol == INVALID_SYMBOL) continue;
+        if (symbol >= spilledSegments.size()) {
+            spilledSegments.resize(symbol + 1);
+        }
+        
+        // A retried spill notes its segments again
+        std::vector<uint32_t>& list = spilledSegments[symbol];
+        if (list.empty() || list.back() < segment) {
+            list.push_back(static_cast<uint32_t>(segment));
+        }
+    }
+}
+
+size_t TransactionLog::loadBlocks(const std::string& path, size_t segments,
+                                  std::vector<BlockHeader>& headers) {
+    blockOffsets.clear();
+    spilledSegments.clear();
+    indexEnd = 0;
+    
+    std::ifstream file(indexPath(path), std::ios::binary);
+    if (!file.is_open()) {
+        return 0;
+    }
+    
+    // Only headers and entries are read; a torn final block ends the
+    // list and is indexed again
+    std::vector<BlockEntry> entries;
+    while (blockOffsets.size() < segments) {
+        BlockHeader header;
+        file.seekg(static_cast<std::streamoff>(indexEnd));
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(BlockHeader)) ||
+            header.symbolCount > fileSymbols.size()) {
+            break;
+        }
+        entries.resize(header.symbolCount);
+        if (!file.read(reinterpret_cast<char*>(entries.data()),
+                       entries.size() * sizeof(BlockEntry))) {
+            break;
+        }
+        
+        size_t listed = 0;
+        for (const BlockEntry& entry : entries) {
+            listed += entry.count;
+        }
+        uint64_t size = sizeof(BlockHeader) + entries.size() * sizeof(BlockEntry) +
+                        listed * sizeof(uint16_t);
+        if (listed > SEGMENT_SIZE || !file.seekg(static_cast<std::streamoff>(indexEnd + size - 1)) ||
+            file.get() == std::char_traits<char>::eof()) {
+            break;
+        }
+        
+        noteSpilledSymbols(blockOffsets.size(), entries.data(), entries.size());
+        headers.push_back(header);
+        blockOffsets.push_back(indexEnd);
+        indexEnd += size;
+    }
+    return blockOffsets.size();
+}
+
+bool TransactionLog::indexSpilled(size_t segment, std::vector<BlockHeader>& headers) {
+    // Read raw, keeping the ticker list indices the block is keyed on
+    std::ifstream file(spillPath, std::ios::binary);
+    std::vector<Transaction> records(SEGMENT_SIZE);
+    file.seekg(static_cast<std::streamoff>(segment * SEGMENT_BYTES));
+    if (!file.read(reinterpret_cast<char*>(records.data()), SEGMENT_BYTES)) {
+        std::cerr << "Error: Could not index transaction log " << spillPath << std::endl;
+        return false;
+    }
+    
+    std::vector<char> block;
+    encodeBlock(records, fileSymbols.size(), block);
+    
+    std::fstream index;
+    if (!openForUpdate(index, indexPath(spillPath))) return false;
+    index.seekp(static_cast<std::streamoff>(indexEnd));
+    index.write(block.data(), block.size());
+    index.close();
+    if (!index) {
+        std::cerr << "Error: Could not write transaction log index " << indexPath(spillPath)
+                  << std::endl;
+        return false;
+    }
+    
+    BlockHeader header;
+    std::memcpy(&header, block.data(), sizeof(BlockHeader));
+    noteSpilledSymbols(segment, reinterpret_cast<const BlockEntry*>(block.data() + sizeof(BlockHeader)),
+                       header.symbolCount);
+    headers.push_back(header);
+    blockOffsets.push_back(indexEnd);
+    indexEnd += block.size();
+    return true;
+}
+
+size_t TransactionLog::size() const {
+    return sealed.size() * SEGMENT_SIZE + head.size();
+}
+
+bool TransactionLog::empty() const {
+    return size() == 0;
+}
+
+size_t TransactionLog::read(size_t first, size_t count, std::vector<Transaction>& out) const {
+    size_t total = size();
+    if (first >= total) return 0;
+    if (count > total - first) count = total - first;
+    
+    size_t copied = 0;
+    while (copied < count) {
+        size_t index = first + copied;
+        size_t segment = index / SEGMENT_SIZE;
+        size_t offset = index % SEGMENT_SIZE;
+        size_t run = std::min(count - copied, SEGMENT_SIZE - offset);
+        
+        if (segment == sealed.size()) {
+            out.insert(out.end(), head.begin() + offset, head.begin() + offset + run);
+        } else if (sealed[segment]) {
+            const std::vector<Transaction>& records = *sealed[segment];
+            out.insert(out.end(), records.begin() + offset, records.begin() + offset + run);
+        } else if (!readSpilled(segment, offset, run, out)) {
+            break;
+        }
+        copied += run;
+    }
+    
+    return copied;
+}
+
+bool TransactionLog::attachSpillFile(const std::string& path) {
+    if (spillOwner && path == spillPath) return true;
+    if (spilledCount > 0 && path != spillPath) {
+        std::cerr << "Error: Transaction log is already spilled to " << spillPath << std::endl;
+        return false;
+    }
+    
+    if (spilledCount > 0) {
+        // A copy taking over the file it already reads from
+        spillOwner = true;
+        return spill();
+    }
+    
+    // Whole segments already in the file precede the loaded history
+    size_t existing = 0;
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (file.is_open()) {
+            existing = static_cast<size_t>(file.tellg()) / SEGMENT_BYTES;
+        }
+    }
+    
+    // Segments spilled after the last save are not part of the saved
+    // history; its inline records already hold them
+    if (savedSpillCount != UNKNOWN_COUNT) {
+        if (existing < savedSpillCount) {
+            std::cerr << "Error: Transaction log " << path << " is missing "
+                      << (savedSpillCount - existing) << " saved segment(s)." << std::endl;
+            return false;
+        }
+        existing = savedSpillCount;
+    }
+    
+    if (!loadFileSymbols(path) && existing > 0) {
+        std::cerr << "Error: Transaction log " << path << " has no symbol list." << std::endl;
+        return false;
+    }
+    
+    std::vector<BlockHeader> headers;
+    loadBlocks(path, existing, headers);
+    
+    sealed.insert(sealed.begin(), existing, SegmentPtr());
+    TimeRange unknown = {0, 0};
+    segmentTimes.insert(segmentTimes.begin(), existing, unknown);
+    spilledCount = existing;
+    spillPath = path;
+    spillOwner = true;
+    
+    // Segments whose blocks never made it to the index file are indexed
+    // from the spill file once, and their blocks written
+    for (size_t segment = headers.size(); segment < existing; segment++) {
+        if (!indexSpilled(segment, headers)) return false;
+    }
+    
+    // Time order over the spilled segments comes from their block
+    // headers; resident records are indexed after them
+    timeOrdered = true;
+    latestTime = 0;
+    for (size_t segment = 0; segment < existing; segment++) {
+        segmentTimes[segment].earliest = headers[segment].earliest;
+        segmentTimes[segment].latest = headers[segment].latest;
+        timeOrdered = timeOrdered && headers[segment].ordered;
+        if (segment > 0 && segmentTimes[segment].earliest < latestTime) {
+            timeOrdered = false;
+        }
+        latestTime = segmentTimes[segment].latest;
+    }
+    indexResident();
+    
+    return spill();
+}
+
+void TransactionLog::setSavedSpillCount(size_t segments) {
+    savedSpillCount = segments;
+}
+
+size_t TransactionLog::getSpilledSize() const {
+    return spilledCount * SEGMENT_SIZE;
+}
+
+size_t TransactionLog::getSegmentCount() const {
+    return sealed.size() + (head.empty() ? 0 : 1);
+}
+
+void TransactionLog::indexRecord(const Transaction& txn, size_t index) {
+    if (txn.symbolId >= postings.size()) {
+        postings.resize(txn.symbolId + 1);
+    }
+    postings[txn.symbolId].push_back(static_cast<uint32_t>(index));
+    
+    if (index > 0 && txn.timestamp < latestTime) {
+        timeOrdered = false;
+    }
+    latestTime = txn.timestamp;
+}
+
+void TransactionLog::indexResident() {
+    postings.clear();
+    
+    for (size_t segment = spilledCount; segment < sealed.size(); segment++) {
+        const std::vector<Transaction>& records = *sealed[segment];
+        for (size_t i = 0; i < records.size(); i++) {
+            indexRecord(records[i], segment * SEGMENT_SIZE + i);
+        }
+    }
+    for (size_t i = 0; i < head.size(); i++) {
+        indexRecord(head[i], sealed.size() * SEGMENT_SIZE + i);
+    }
+}
+
+TransactionLog::TimeRange TransactionLog::timeRange(const std::vector<Transaction>& records) {
+    TimeRange range = {0, 0};
+    if (records.empty()) return range;
+    
+    range.earliest = range.latest = records[0].timestamp;
+    for (const Transaction& txn : records) {
+        range.earliest = std::min(range.earliest, txn.timestamp);
+        range.latest = std::max(range.latest, txn.timestamp);
+    }
+    return range;
+}
+
+bool TransactionLog::fetch(size_t index, std::ifstream& file, Transaction& txn) const {
+    size_t segment = index / SEGMENT_SIZE;
+    size_t offset = index % SEGMENT_SIZE;
+    
+    if (segment == sealed.size()) {
+        txn = head[offset];
+        return true;
+    }
+    if (sealed[segment]) {
+        txn = (*sealed[segment])[offset];
+        return true;
+    }
+    
+    if (!file.is_open()) {
+        file.open(spillPath, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open transaction log " << spillPath
+                      << " for reading." << std::endl;
+            return false;
+        }
+    }
+    file.seekg(static_cast<std::streamoff>(index * sizeof(Transaction)));
+    if (!file.read(reinterpret_cast<char*>(&txn), sizeof(Transaction))) {
+        return false;
+    }
+    txn.symbolId = fromFileSymbol(txn.symbolId);
+    return true;
+}
+
+size_t TransactionLog::lowerBound(int64_t time, std::ifstream& file) const {
+    // The first segment ending at or after `time`, then a binary search
+    // within it; timestamps are in order, so segment ranges are too
+    size_t segment = std::lower_bound(segmentTimes.begin(), segmentTimes.end(), time,
+                                      [](const TimeRange& range, int64_t t) {
+                                          return range.latest < t;
+                                      }) - segmentTimes.begin();
+    
+    size_t low = segment * SEGMENT_SIZE;
+    size_t high = std::min(low + SEGMENT_SIZE, size());
+    Transaction txn;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (!fetch(mid, file, txn)) break;
+        if (txn.timestamp < time) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+size_t TransactionLog::scanRange(SymbolId symbol, int64_t from, int64_t to,
+                                 std::vector<Transaction>& out) const {
+    size_t found = 0;
+    std::vector<Transaction> buffer;
+    
+    for (size_t segment = 0; segment <= sealed.size(); segment++) {
+        if (segment < sealed.size() &&
+            (segmentTimes[segment].latest < from || segmentTimes[segment].earliest > to)) {
+            continue;
+        }
+        
+        buffer.clear();
+        read(segment * SEGMENT_SIZE, SEGMENT_SIZE, buffer);
+        for (const Transaction& txn : buffer) {
+            if (txn.timestamp < from || txn.timestamp > to) continue;
+            if (symbol != INVALID_SYMBOL && txn.symbolId != symbol) continue;
+            out.push_back(txn);
+            found++;
+        }
+    }
+    return found;
+}
+
+size_t TransactionLog::querySpilled(size_t segment, uint32_t fileSymbol, size_t begin,
+                                    size_t end, std::ifstream& file, std::ifstream& index,
+                                    std::vector<Transaction>& out) const {
+    if (!index.is_open()) {
+        index.open(indexPath(spillPath), std::ios::binary);
+        if (!index.is_open()) {
+            std::cerr << "Error: Could not open transaction log index " << indexPath(spillPath)
+                      << " for reading." << std::endl;
+            return 0;
+        }
+    }
+    
+    // The block's entries locate the symbol's offsets within it
+    BlockHeader header;
+    index.seekg(static_cast<std::streamoff>(blockOffsets[segment]));
+    if (!index.read(reinterpret_cast<char*>(&header), sizeof(BlockHeader))) return 0;
+    std::vector<BlockEntry> entries(header.symbolCount);
+    if (!index.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(BlockEntry))) {
+        return 0;
+    }
+    
+    auto entry = std::lower_bound(entries.begin(), entries.end(), fileSymbol,
+                                  [](const BlockEntry& e, uint32_t symbol) {
+                                      return e.symbol < symbol;
+                                  });
+    if (entry == entries.end() || entry->symbol != fileSymbol) return 0;
+    
+    size_t skipped = 0;
+    for (auto it = entries.begin(); it != entry; ++it) {
+        skipped += it->count;
+    }
+    std::vector<uint16_t> offsets(entry->count);
+    index.seekg(static_cast<std::streamoff>(blockOffsets[segment] + sizeof(BlockHeader) +
+                                            entries.size() * sizeof(BlockEntry) +
+                                            skipped * sizeof(uint16_t)));
+    if (!index.read(reinterpret_cast<char*>(offsets.data()), offsets.size() * sizeof(uint16_t))) {
+        return 0;
+    }
+    
+    size_t found = 0;
+    Transaction txn;
+    for (uint16_t offset : offsets) {
+        size_t position = segment * SEGMENT_SIZE + offset;
+        if (position < begin) continue;
+        if (position >= end) break;
+        if (!fetch(position, file, txn)) break;
+        out.push_back(txn);
+        found++;
+    }
+    return found;
+}
+
+size_t TransactionLog::query(SymbolId symbol, int64_t from, int64_t to,
+                             std::vector<Transaction>& out) const {
+    if (from > to || empty()) return 0;
+    if (!timeOrdered) {
+        return scanRange(symbol, from, to, out);
+    }
+    
+    std::ifstream file;
+    size_t begin = lowerBound(from, file);
+    size_t end = (to == INT64_MAX) ? size() : lowerBound(to + 1, file);
+    
+    if (symbol == INVALID_SYMBOL) {
+        return read(begin, end - begin, out);
+    }
+    
+    // Spilled segments holding the symbol through their index blocks,
+    // then the resident postings
+    size_t found = 0;
+    size_t boundary = getSpilledSize();
+    if (begin < boundary && symbol < spilledSegments.size()) {
+        const std::vector<uint32_t>& segments = spilledSegments[symbol];
+        std::ifstream index;
+        for (auto it = std::lower_bound(segments.begin(), segments.end(), begin / SEGMENT_SIZE);
+             it != segments.end() && *it * SEGMENT_SIZE < end; ++it) {
+            found += querySpilled(*it, fileIndex[symbol] - 1, begin, end, file, index, out);
+        }
+    }
+    if (symbol >= postings.size()) return found;
+    
+    const std::vector<uint32_t>& list = postings[symbol];
+    auto first = std::lower_bound(list.begin(), list.end(), std::max(begin, boundary));
+    auto last = std::lower_bound(first, list.end(), end);
+    
+    Transaction txn;
+    for (auto it = first; it != last; ++it) {
+        if (!fetch(*it, file, txn)) break;
+        out.push_back(txn);
+        found++;
+    }
+    return found;
+}
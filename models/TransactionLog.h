@@ -0,0 +1,175 @@
+#ifndef TRANSACTION_LOG_H
+#define TRANSACTION_LOG_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iosfwd>
+#include <ctime>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+#include "Order.h"
+#include "../utils/SymbolTable.h"
+#include "../utils/FixedPoint.h"
+
+// Transaction record for history. Fixed layout with no implicit padding,
+// so sealed segments are written to and read from disk as raw bytes and
+// identical histories give identical files.
+struct Transaction {
+    Price price;
+    int64_t timestamp;
+    SymbolId symbolId;
+    int32_t quantity;
+    OrderSide side;
+    uint8_t reserved[7]; // Always zero
+    
+    Transaction()
+        : price(0), timestamp(0), symbolId(INVALID_SYMBOL), quantity(0), side(OrderSide::Buy),
+          reserved() {}
+    Transaction(OrderSide t, SymbolId s, int q, Price p)
+        : price(p), timestamp(std::time(nullptr)), symbolId(s), quantity(q), side(t),
+          reserved() {}
+    
+    const char* getType() const; // "BUY" or "SELL"
+    
+    std::string serialize() const;
+    static Transaction deserialize(const std::string& data);
+};
+
+static_assert(std::is_trivially_copyable<Transaction>::value,
+              "Transaction must be trivially copyable");
+static_assert(std::is_standard_layout<Transaction>::value,
+              "Transaction must have a fixed layout for spilling");
+static_assert(sizeof(Transaction) == 32, "Transaction must have no padding bytes");
+
+// Append-only transaction history in fixed-size segments. A segment is
+// sealed once it holds SEGMENT_SIZE records and never changes again; with
+// a spill file attached, sealed segments are written to it and dropped
+// from memory. Copies share sealed segments and may read the original's
+// spill file, but never write to it. query() finds records by symbol and
+// time range from per-symbol indexes instead of scanning.
+class TransactionLog {
+public:
+    static const size_t SEGMENT_SIZE = 4096;
+    static const size_t SEGMENT_BYTES = SEGMENT_SIZE * sizeof(Transaction);
+    static const size_t UNKNOWN_COUNT = static_cast<size_t>(-1);
+
+private:
+    typedef std::shared_ptr<const std::vector<Transaction>> SegmentPtr;
+    
+    struct TimeRange {
+        int64_t earliest;
+        int64_t latest;
+    };
+    
+    // The index file (<path>.idx) holds one block per spilled segment,
+    // written with it: this header, `symbolCount` entries in ascending
+    // symbol order, then each entry's segment offsets in ascending order.
+    // Attaching reads the headers and entries, never the offsets.
+    struct BlockHeader {
+        int64_t earliest;
+        int64_t latest;
+        uint32_t symbolCount;
+        uint32_t ordered;   // Timestamps never decrease within the segment
+    };
+    
+    struct BlockEntry {
+        uint32_t symbol;    // Index into the spill file's ticker list
+        uint32_t count;
+    };
+    
+    std::vector<SegmentPtr> sealed; // Null once spilled
+    std::vector<Transaction> head;  // Open segment
+    size_t spilledCount;            // sealed[0, spilledCount) live in the spill file
+    std::string spillPath;
+    bool spillOwner;                // Only the log that attached the file writes to it
+    size_t savedSpillCount;         // Segments on disk as of the last save, if known
+    
+    // SymbolIds only hold within one process, so spilled records carry an
+    // index into a ticker list beside the spill file (<path>.symbols),
+    // appended to before any segment that needs a new entry
+    std::vector<SymbolId> fileSymbols;  // Ticker list index -> SymbolId
+    std::vector<uint32_t> fileIndex;    // SymbolId -> ticker list index + 1, 0 when not listed
+    std::vector<uint64_t> blockOffsets; // Spilled segment -> its block in the index file
+    uint64_t indexEnd;
+    
+    // Query indexes. While timestamps never decrease, a query binary
+    // searches the segment times and the two end segments, then reads the
+    // blocks of the spilled segments holding the symbol and walks its
+    // resident postings: O(log n + s + results) for s such segments in
+    // range. Once the clock steps back, queries scan the segments whose
+    // times overlap the range.
+    std::vector<std::vector<uint32_t>> postings;        // SymbolId -> resident log indices, ascending
+    std::vector<std::vector<uint32_t>> spilledSegments; // SymbolId -> spilled segments holding it, ascending
+    std::vector<TimeRange> segmentTimes;                // Parallel to sealed
+    int64_t latestTime;
+    bool timeOrdered;                            // No timestamp precedes the one before it
+    
+    void seal();
+    bool spill();
+    bool readSpilled(size_t segment, size_t offset, size_t count,
+                     std::vector<Transaction>& out) const;
+    
+    // Spill file ticker list
+    bool loadFileSymbols(const std::string& path);
+    bool mapFileSymbol(SymbolId symbol, uint32_t& index);
+    SymbolId fromFileSymbol(uint32_t index) const;
+    
+    // Index blocks. Records passed to encodeBlock carry ticker list indices.
+    static void encodeBlock(const std::vector<Transaction>& records, size_t symbols,
+                            std::vector<char>& block);
+    void noteSpilledSymbols(size_t segment, const BlockEntry* entries, size_t count);
+    size_t loadBlocks(const std::string& path, size_t segments, std::vector<BlockHeader>& headers);
+    bool indexSpilled(size_t segment, std::vector<BlockHeader>& headers);
+    
+    void indexRecord(const Transaction& txn, size_t index);
+    void indexResident();
+    static TimeRange timeRange(const std::vector<Transaction>& records);
+    
+    // Record `index`, from memory or through `file`, opened on first use
+    bool fetch(size_t index, std::ifstream& file, Transaction& txn) const;
+    size_t lowerBound(int64_t time, std::ifstream& file) const; // First index at or after `time`
+    size_t querySpilled(size_t segment, uint32_t fileSymbol, size_t begin, size_t end,
+                        std::ifstream& file, std::ifstream& index,
+                        std::vector<Transaction>& out) const;
+    size_t scanRange(SymbolId symbol, int64_t from, int64_t to, std::vector<Transaction>& out) const;
+
+public:
+    TransactionLog();
+    TransactionLog(const TransactionLog& other);
+    TransactionLog& operator=(const TransactionLog& other);
+    
+    // O(1) amortized; sealing a segment writes it out once
+    void append(const Transaction& txn);
+    
+    size_t size() const;
+    bool empty() const;
+    
+    // Append transactions [first, first + count) to `out` in order;
+    // returns how many were read
+    size_t read(size_t first, size_t count, std::vector<Transaction>& out) const;
+    
+    // Append the transactions in `symbol` (INVALID_SYMBOL for every
+    // symbol) with from <= timestamp <= to to `out`, oldest first;
+    // returns how many were found
+    size_t query(SymbolId symbol, int64_t from, int64_t to, std::vector<Transaction>& out) const;
+    
+    // Spill sealed segments to `path`. Segments already in the file come
+    // first in the log, ahead of everything appended or loaded so far.
+    // With a saved spill count, only that many are taken from the file.
+    bool attachSpillFile(const std::string& path);
+    
+    // Segments the spill file held when the loaded history was saved.
+    // A crash between a spill and the next save leaves newer segments in
+    // the file whose records the save still carries inline; attaching
+    // ignores them, and the next spill overwrites them.
+    void setSavedSpillCount(size_t segments);
+    
+    // Transactions before this index are on disk; the rest is what a
+    // save has to write
+    size_t getSpilledSize() const;
+    size_t getSegmentCount() const;
+};
+
+#endif
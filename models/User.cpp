@@ -40,7 +40,9 @@ void Admin::displayMenu() const {
     Console::printMenuOption(4, "Simulate Price Changes", Symbol::FIRE);
     Console::printMenuOption(5, "View All Users", Symbol::USER);
     Console::printMenuOption(6, "System Statistics", "📊");
-    Console::printMenuOption(7, "Logout", "🚪");
+    Console::printMenuOption(7, "View Order Journal", "📜");
+    Console::printMenuOption(8, "Risk Limits", "🔒");
+    Console::printMenuOption(9, "Logout", "🚪");
     
     Console::printDivider("═", 50);
 }
@@ -68,7 +70,7 @@ Admin Admin::deserialize(const std::string& data) {
 }
 
 // Trader implementation
-Trader::Trader(const std::string& username, const std::string& password, double initialBalance)
+Trader::Trader(const std::string& username, const std::string& password, Money initialBalance)
     : User(username, password, "TRADER"), portfolio(username, initialBalance) {}
 
 void Trader::displayMenu() const {
@@ -85,7 +87,9 @@ void Trader::displayMenu() const {
     Console::printMenuOption(5, "View Transaction History", "📜");
     Console::printMenuOption(6, "Run Trading Strategy", Symbol::TARGET);
     Console::printMenuOption(7, "Account Summary", "📊");
-    Console::printMenuOption(8, "Logout", "🚪");
+    Console::printMenuOption(8, "Working Orders", "⏱");
+    Console::printMenuOption(9, "Stop Orders", "🛑");
+    Console::printMenuOption(10, "Logout", "🚪");
     
     Console::printDivider("═", 50);
 }
@@ -102,7 +106,7 @@ void Trader::displayTraderInfo() const {
     std::cout << "\n=== Trader Account ===" << std::endl;
     std::cout << "Username: " << username << std::endl;
     std::cout << "Role: " << role << std::endl;
-    std::cout << "Cash Balance: $" << portfolio.getCashBalance() << std::endl;
+    std::cout << "Cash Balance: $" << FixedPoint::toDouble(portfolio.getCashBalance()) << std::endl;
 }
 
 std::string Trader::serialize() const {
@@ -121,7 +125,7 @@ Trader Trader::deserialize(const std::string& data) {
     // Get remaining data for portfolio
     std::getline(iss, portfolioData);
     
-    Trader trader(username, password, 0.0);
+    Trader trader(username, password, 0);
     trader.portfolio = Portfolio::deserialize(portfolioData);
     
     return trader;
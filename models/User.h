@@ -55,7 +55,7 @@ private:
 public:
     // Constructor
     Trader(const std::string& username, const std::string& password, 
-           double initialBalance = 100000.0);
+           Money initialBalance = FixedPoint::fromUnits(100000));
     
     // Override abstract method
     void displayMenu() const override;
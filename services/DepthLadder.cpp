@@ -0,0 +1,59 @@
+#include "DepthLadder.h"
+
+DepthLadder::DepthLadder(size_t levels)
+    : levels(levels) {
+    depth.sequence = 0;
+}
+
+void DepthLadder::reset(const OrderBook::DepthSnapshot& snapshot) {
+    depth = snapshot;
+    if (depth.bids.size() > levels) depth.bids.resize(levels);
+    if (depth.asks.size() > levels) depth.asks.resize(levels);
+}
+
+size_t DepthLadder::apply(const std::vector<OrderBook::DepthUpdate>& updates) {
+    size_t applied = 0;
+    for (const OrderBook::DepthUpdate& update : updates) {
+        if (update.sequence <= depth.sequence) continue;
+        depth.sequence = update.sequence;
+        
+        std::vector<OrderBook::DepthLevel>& side =
+            (update.side == OrderSide::Buy) ? depth.bids : depth.asks;
+        if (update.level.price == 0) {
+            side.clear(); // Resync: the side's top levels follow
+        } else {
+            applyLevel(side, update.side, update.level);
+        }
+        applied++;
+    }
+    return applied;
+}
+
+void DepthLadder::applyLevel(std::vector<OrderBook::DepthLevel>& side, OrderSide sideType,
+                             const OrderBook::DepthLevel& level) {
+    // Best first: bids descending, asks ascending
+    size_t i = 0;
+    while (i < side.size() && (sideType == OrderSide::Buy ? side[i].price > level.price
+                                                          : side[i].price < level.price)) {
+        i++;
+    }
+    
+    bool present = i < side.size() && side[i].price == level.price;
+    if (level.quantity == 0) {
+        if (present) side.erase(side.begin() + i);
+    } else if (present) {
+        side[i] = level;
+    } else {
+        side.insert(side.begin() + i, level);
+    }
+    
+    if (side.size() > levels) side.resize(levels);
+}
+
+size_t DepthLadder::getLevels() const {
+    return levels;
+}
+
+const OrderBook::DepthSnapshot& DepthLadder::getDepth() const {
+    return depth;
+}
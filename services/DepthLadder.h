@@ -0,0 +1,34 @@
+#ifndef DEPTH_LADDER_H
+#define DEPTH_LADDER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "OrderBook.h"
+
+// A subscriber's copy of the top levels of one order book: reset from a
+// snapshot, then kept current by applying the updates drained after it
+// instead of taking a new snapshot. Updates at or below the ladder's
+// sequence are already reflected and skipped. Levels beyond the followed
+// depth are trimmed after each update, matching what the book sends.
+class DepthLadder {
+private:
+    size_t levels;
+    OrderBook::DepthSnapshot depth;
+    
+    void applyLevel(std::vector<OrderBook::DepthLevel>& side, OrderSide sideType,
+                    const OrderBook::DepthLevel& level);
+
+public:
+    explicit DepthLadder(size_t levels);
+    
+    void reset(const OrderBook::DepthSnapshot& snapshot);
+    
+    // Returns how many updates were newer than the ladder
+    size_t apply(const std::vector<OrderBook::DepthUpdate>& updates);
+    
+    size_t getLevels() const;
+    const OrderBook::DepthSnapshot& getDepth() const; // Best first
+};
+
+#endif
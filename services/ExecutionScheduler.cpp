@@ -0,0 +1,476 @@
+#include "ExecutionScheduler.h"
+#include "../utils/OrderIdGenerator.h"
+#include "../utils/Colors.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+#include <ctime>
+
+ExecutionScheduler::ExecutionScheduler(TradingEngine& engine, uint64_t startTime)
+    : engine(engine), wheel(startTime) {}
+
+bool ExecutionScheduler::validate(SymbolId symbol, int quantity) const {
+    if (!engine.stockExists(symbol)) {
+        std::cout << "Stock " << SymbolTable::instance().name(symbol) << " does not exist." << std::endl;
+        return false;
+    }
+    if (quantity <= 0) {
+        std::cout << "Quantity must be positive." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+uint64_t ExecutionScheduler::addParent(Portfolio& portfolio, OrderSide side, SymbolId symbol,
+                                       int quantity, Price limit, ExecutionAlgo algo,
+                                       uint64_t interval) {
+    uint32_t index;
+    if (!freeParents.empty()) {
+        index = freeParents.back();
+        freeParents.pop_back();
+    } else {
+        parents.push_back(Parent());
+        index = static_cast<uint32_t>(parents.size() - 1);
+    }
+    
+    Parent& parent = parents[index];
+    parent.status.parentId = OrderIdGenerator::instance().next();
+    parent.status.symbolId = symbol;
+    parent.status.quantity = quantity;
+    parent.status.filledQuantity = 0;
+    parent.status.workingQuantity = 0;
+    parent.status.unfilledQuantity = 0;
+    parent.status.slicesSent = 0;
+    parent.status.side = side;
+    parent.status.algo = algo;
+    parent.status.error = ExecutionError::None;
+    parent.status.active = true;
+    parent.portfolio = &portfolio;
+    parent.limit = limit;
+    parent.interval = interval;
+    parent.childId = 0;
+    parent.childResting = 0;
+    parent.carry = 0;
+    parent.displayQuantity = 0;
+    parent.slices.clear();
+    parent.nextSlice = 0;
+    parent.finalSent = false;
+    
+    parent.record = OrderRecord();
+    parent.record.orderId = parent.status.parentId;
+    parent.record.price = limit;
+    parent.record.timestamp = std::time(nullptr);
+    parent.record.symbolId = symbol;
+    parent.record.quantity = quantity;
+    parent.record.side = side;
+    parent.record.status = OrderStatus::Pending;
+    parent.record.flags = ORDER_FLAG_PARENT;
+    
+    // Due immediately: the first child goes out on the next advance
+    parent.timerId = wheel.schedule(wheel.getTime(), index);
+    parentIndex[parent.status.parentId] = index;
+    return parent.status.parentId;
+}
+
+uint64_t ExecutionScheduler::submitTwap(Portfolio& portfolio, OrderSide side, SymbolId symbol,
+                                        int quantity, Price limit, uint64_t duration,
+                                        uint64_t interval) {
+    if (!validate(symbol, quantity)) return 0;
+    if (interval == 0) {
+        std::cout << "Interval must be positive." << std::endl;
+        return 0;
+    }
+    
+    uint64_t count = std::max<uint64_t>(1, duration / interval);
+    count = std::min<uint64_t>(count, static_cast<uint64_t>(quantity));
+    
+    uint64_t id = addParent(portfolio, side, symbol, quantity, limit, ExecutionAlgo::Twap, interval);
+    Parent& parent = parents[parentIndex[id]];
+    for (uint64_t i = 0; i < count; i++) {
+        parent.slices.push_back(static_cast<int32_t>(quantity * (i + 1) / count - quantity * i / count));
+    }
+    return id;
+}
+
+uint64_t ExecutionScheduler::submitVwap(Portfolio& portfolio, OrderSide side, SymbolId symbol,
+                                        int quantity, Price limit, uint64_t duration,
+                                        const std::vector<double>& volumeProfile) {
+    if (!validate(symbol, quantity)) return 0;
+    
+    std::vector<double> profile = volumeProfile.empty() ? defaultVolumeProfile(10) : volumeProfile;
+    double total = 0.0;
+    for (double weight : profile) {
+        total += std::max(weight, 0.0);
+    }
+    if (total <= 0.0) {
+        std::cout << "Volume profile must have a positive weight." << std::endl;
+        return 0;
+    }
+    
+    uint64_t interval = std::max<uint64_t>(1, duration / profile.size());
+    uint64_t id = addParent(portfolio, side, symbol, quantity, limit, ExecutionAlgo::Vwap, interval);
+    Parent& parent = parents[parentIndex[id]];
+    
+    // Round the cumulative target so the slices always sum to the parent
+    double cumulative = 0.0;
+    int32_t previous = 0;
+    for (double weight : profile) {
+        cumulative += std::max(weight, 0.0);
+        int32_t target = static_cast<int32_t>(std::llround(quantity * cumulative / total));
+        parent.slices.push_back(target - previous);
+        previous = target;
+    }
+    return id;
+}
+
+uint64_t ExecutionScheduler::submitIceberg(Portfolio& portfolio, OrderSide side, SymbolId symbol,
+                                           int quantity, Price limit, int displayQuantity,
+                                           uint64_t refreshInterval) {
+    if (!validate(symbol, quantity)) return 0;
+    if (limit <= 0) {
+        std::cout << "Iceberg orders need a limit price." << std::endl;
+        return 0;
+    }
+    if (displayQuantity <= 0) {
+        std::cout << "Display quantity must be positive." << std::endl;
+        return 0;
+    }
+    
+    uint64_t id = addParent(portfolio, side, symbol, quantity, limit, ExecutionAlgo::Iceberg,
+                            std::max<uint64_t>(1, refreshInterval));
+    parents[parentIndex[id]].displayQuantity = std::min(displayQuantity, quantity);
+    return id;
+}
+
+size_t ExecutionScheduler::scheduleSignals(std::vector<OrderPtr>& signals, Portfolio& portfolio,
+                                           int maxChildQuantity, uint64_t duration,
+                                           uint64_t interval) {
+    size_t scheduled = 0;
+    size_t kept = 0;
+    
+    for (size_t i = 0; i < signals.size(); i++) {
+        const Order& order = *signals[i];
+        if (order.getQuantity() > maxChildQuantity &&
+            submitTwap(portfolio, order.getSide(), order.getSymbolId(), order.getQuantity(), 0,
+                       duration, interval) != 0) {
+            scheduled++;
+            continue;
+        }
+        if (kept != i) signals[kept] = std::move(signals[i]);
+        kept++;
+    }
+    
+    signals.resize(kept);
+    return scheduled;
+}
+
+bool ExecutionScheduler::cancel(uint64_t parentId) {
+    std::unordered_map<uint64_t, uint32_t>::iterator it = parentIndex.find(parentId);
+    if (it == parentIndex.end()) return false;
+    
+    finish(it->second);
+    return true;
+}
+
+size_t ExecutionScheduler::cancelPortfolio(Portfolio& portfolio) {
+    size_t cancelled = 0;
+    for (uint32_t index = 0; index < parents.size(); index++) {
+        if (!parents[index].status.active || parents[index].portfolio != &portfolio) continue;
+        
+        finish(index);
+        cancelled++;
+    }
+    return cancelled;
+}
+
+void ExecutionScheduler::reclaim(Parent& parent, bool cancelResting) {
+    if (parent.childId == 0) return;
+    
+    SymbolId symbol = parent.status.symbolId;
+    const OrderBook* book = engine.findBook(symbol);
+    int32_t resting = book ? book->getRestingQuantity(parent.childId) : 0;
+    
+    // Whatever left the book since the last look traded
+    parent.status.filledQuantity += parent.childResting - resting;
+    parent.child.filledQuantity += parent.childResting - resting;
+    parent.childResting = resting;
+    parent.status.workingQuantity = resting;
+    
+    if (resting > 0 && cancelResting) {
+        engine.cancelOrder(symbol, parent.childId, *parent.portfolio);
+        parent.carry += resting;
+        parent.child.status = OrderStatus::Cancelled;
+        resting = 0;
+    }
+    
+    if (resting == 0) {
+        if (parent.child.status == OrderStatus::Pending) {
+            parent.child.status = OrderStatus::Executed;
+        }
+        orderRecords.push_back(parent.child);
+        parent.childId = 0;
+        parent.childResting = 0;
+        parent.status.workingQuantity = 0;
+    }
+}
+
+int32_t ExecutionScheduler::nextChildQuantity(Parent& parent, bool& done) {
+    done = false;
+    
+    if (parent.status.algo == ExecutionAlgo::Iceberg) {
+        // Only one peak is visible at a time
+        if (parent.childId != 0) return 0;
+        
+        int32_t remaining = parent.status.quantity - parent.status.filledQuantity;
+        if (remaining <= 0) {
+            done = true;
+            return 0;
+        }
+        return std::min(parent.displayQuantity, remaining);
+    }
+    
+    // Quantity carried past the last slice gets one final child
+    if (parent.nextSlice >= parent.slices.size()) {
+        if (parent.carry > 0 && !parent.finalSent) {
+            parent.finalSent = true;
+            int32_t quantity = parent.carry;
+            parent.carry = 0;
+            return quantity;
+        }
+        done = true;
+        return 0;
+    }
+    
+    int32_t quantity = parent.slices[parent.nextSlice++] + parent.carry;
+    parent.carry = 0;
+    return quantity;
+}
+
+void ExecutionScheduler::finish(uint32_t index) {
+    Parent& parent = parents[index];
+    if (!parent.status.active) return;
+    
+    if (parent.timerId != 0) {
+        wheel.cancel(parent.timerId);
+        parent.timerId = 0;
+    }
+    reclaim(parent, true);
+    
+    parent.status.active = false;
+    parent.status.workingQuantity = 0;
+    parent.status.unfilledQuantity = parent.status.quantity - parent.status.filledQuantity;
+    completed.push_back(parent.status);
+    
+    parent.record.filledQuantity = parent.status.filledQuantity;
+    parent.record.status = parent.status.unfilledQuantity == 0 ? OrderStatus::Executed
+                                                               : OrderStatus::Cancelled;
+    orderRecords.push_back(parent.record);
+    parentIndex.erase(parent.status.parentId);
+    freeParents.push_back(index);
+}
+
+size_t ExecutionScheduler::advanceTo(uint64_t time) {
+    dueParents.clear();
+    wheel.advance(time, dueParents);
+    
+    for (uint32_t index : dueParents) {
+        Parent& parent = parents[index];
+        if (!parent.status.active) continue;
+        parent.timerId = 0;
+        
+        const MarketDataStore& market = engine.getMarket();
+        size_t row = market.findRow(parent.status.symbolId);
+        if (row == MarketDataStore::npos) {
+            parent.status.error = ExecutionError::UnknownSymbol;
+            finish(index);
+            continue;
+        }
+        
+        reclaim(parent, parent.status.algo != ExecutionAlgo::Iceberg);
+        
+        bool done;
+        int32_t quantity = nextChildQuantity(parent, done);
+        if (done) {
+            finish(index);
+            continue;
+        }
+        
+        if (quantity > 0) {
+            Price price = parent.limit > 0 ? parent.limit : market.getLastPrice(row);
+            children.push_back(childPool.create(parent.status.side, parent.status.symbolId,
+                                                quantity, price));
+            childParents.push_back(index);
+        }
+        parent.timerId = wheel.schedule(time + parent.interval, index);
+    }
+    
+    size_t sent = children.size();
+    sendChildren();
+    return sent;
+}
+
+void ExecutionScheduler::sendChildren() {
+    if (children.empty()) return;
+    
+    // One batch per portfolio so cash and shares are validated together
+    batchOrder.resize(children.size());
+    for (size_t i = 0; i < batchOrder.size(); i++) {
+        batchOrder[i] = i;
+    }
+    std::stable_sort(batchOrder.begin(), batchOrder.end(), [this](size_t a, size_t b) {
+        return std::less<Portfolio*>()(parents[childParents[a]].portfolio,
+                                       parents[childParents[b]].portfolio);
+    });
+    
+    size_t start = 0;
+    while (start < batchOrder.size()) {
+        Portfolio* portfolio = parents[childParents[batchOrder[start]]].portfolio;
+        size_t end = start;
+        batch.clear();
+        while (end < batchOrder.size() && parents[childParents[batchOrder[end]]].portfolio == portfolio) {
+            batch.push_back(std::move(children[batchOrder[end]]));
+            end++;
+        }
+        
+        engine.executeBatch(batch, *portfolio, batchResults);
+        
+        for (size_t i = 0; i < batchResults.size(); i++) {
+            const ExecutionResult& result = batchResults[i];
+            uint32_t index = childParents[batchOrder[start + i]];
+            Parent& parent = parents[index];
+            childResults.push_back(result);
+            parent.status.filledQuantity += result.filledQuantity;
+            
+            if (result.restingQuantity > 0) {
+                parent.child = batch[i]->getRecord();
+            } else {
+                orderRecords.push_back(batch[i]->getRecord());
+            }
+            
+            // A rejected child ends the parent; one cancelled after a
+            // partial fill leaves the rest to the next slice
+            if (result.error != ExecutionError::None && result.filledQuantity == 0) {
+                parent.status.error = result.error;
+                finish(index);
+                continue;
+            }
+            
+            parent.status.slicesSent++;
+            parent.carry += batch[i]->getQuantity() - result.filledQuantity - result.restingQuantity;
+            if (result.restingQuantity > 0) {
+                parent.childId = result.orderId;
+                parent.childResting = result.restingQuantity;
+                parent.status.workingQuantity = result.restingQuantity;
+            }
+        }
+        start = end;
+    }
+    
+    batch.clear();
+    children.clear();
+    childParents.clear();
+}
+
+uint64_t ExecutionScheduler::getTime() const {
+    return wheel.getTime();
+}
+
+bool ExecutionScheduler::getStatus(uint64_t parentId, ParentStatus& status) const {
+    std::unordered_map<uint64_t, uint32_t>::const_iterator it = parentIndex.find(parentId);
+    if (it == parentIndex.end()) return false;
+    
+    status = parents[it->second].status;
+    return true;
+}
+
+size_t ExecutionScheduler::getActiveCount() const {
+    return parentIndex.size();
+}
+
+size_t ExecutionScheduler::getActive(const Portfolio& portfolio,
+                                     std::vector<ParentStatus>& statuses) const {
+    size_t found = 0;
+    for (const Parent& parent : parents) {
+        if (!parent.status.active || parent.portfolio != &portfolio) continue;
+        
+        statuses.push_back(parent.status);
+        found++;
+    }
+    return found;
+}
+
+size_t ExecutionScheduler::drainChildResults(std::vector<ExecutionResult>& results) {
+    size_t drained = childResults.size();
+    results.insert(results.end(), childResults.begin(), childResults.end());
+    childResults.clear();
+    return drained;
+}
+
+size_t ExecutionScheduler::drainCompleted(std::vector<ParentStatus>& statuses) {
+    size_t drained = completed.size();
+    statuses.insert(statuses.end(), completed.begin(), completed.end());
+    completed.clear();
+    return drained;
+}
+
+size_t ExecutionScheduler::drainOrderRecords(std::vector<OrderRecord>& records) {
+    size_t drained = orderRecords.size();
+    records.insert(records.end(), orderRecords.begin(), orderRecords.end());
+    orderRecords.clear();
+    return drained;
+}
+
+std::vector<double> ExecutionScheduler::defaultVolumeProfile(size_t buckets) {
+    std::vector<double> profile;
+    for (size_t i = 0; i < buckets; i++) {
+        double x = (i + 0.5) / buckets - 0.5;
+        profile.push_back(1.0 + 4.0 * x * x);
+    }
+    return profile;
+}
+
+const char* ExecutionScheduler::algoName(ExecutionAlgo algo) {
+    switch (algo) {
+        case ExecutionAlgo::Twap: return "TWAP";
+        case ExecutionAlgo::Vwap: return "VWAP";
+        case ExecutionAlgo::Iceberg: return "ICEBERG";
+    }
+    return "UNKNOWN";
+}
+
+void ExecutionScheduler::displayStatuses(const std::vector<ParentStatus>& statuses) {
+    std::cout << std::left << std::setw(21) << "Parent" << std::setw(9) << "Algo"
+              << std::setw(6) << "Side" << std::setw(8) << "Symbol"
+              << std::right << std::setw(16) << "Filled" << std::setw(8) << "Slices"
+              << "  " << std::left << "State" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+    
+    for (const ParentStatus& status : statuses) {
+        std::cout << std::left << std::setw(21) << ("ORD" + std::to_string(status.parentId))
+                  << std::setw(9) << algoName(status.algo)
+                  << std::setw(6) << Order::sideName(status.side)
+                  << std::setw(8) << SymbolTable::instance().name(status.symbolId)
+                  << std::right << std::setw(16)
+                  << (std::to_string(status.filledQuantity) + "/" + std::to_string(status.quantity))
+                  << std::setw(8) << status.slicesSent << "  " << std::left;
+        
+        if (status.error != ExecutionError::None) {
+            std::cout << Colors::ERROR << TradingEngine::executionErrorName(status.error)
+                      << Colors::RESET;
+        } else if (status.active) {
+            std::cout << Colors::INFO << "WORKING";
+            if (status.workingQuantity > 0) std::cout << " " << status.workingQuantity << " resting";
+            std::cout << Colors::RESET;
+        } else if (status.unfilledQuantity > 0) {
+            std::cout << Colors::WARNING << "ENDED " << status.unfilledQuantity << " UNFILLED"
+                      << Colors::RESET;
+        } else {
+            std::cout << Colors::SUCCESS << "COMPLETE" << Colors::RESET;
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+}
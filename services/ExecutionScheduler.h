@@ -0,0 +1,138 @@
+#ifndef EXECUTION_SCHEDULER_H
+#define EXECUTION_SCHEDULER_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include "../models/Order.h"
+#include "../models/OrderPool.h"
+#include "../models/Portfolio.h"
+#include "../utils/TimerWheel.h"
+#include "TradingEngine.h"
+
+// How a parent order is worked
+enum class ExecutionAlgo : uint8_t {
+    Twap,    // Equal slices at a fixed interval
+    Vwap,    // Slices sized by a volume profile
+    Iceberg  // Only `displayQuantity` rests at a time, refilled when it trades
+};
+
+// Works large parent orders as a stream of child orders. Every parent
+// waits on one shared timer wheel, so any number of them run from the
+// caller's thread; the caller drives the clock with advanceTo() in
+// whatever unit the intervals use (e.g. simulation steps or seconds).
+// Children go through TradingEngine::executeBatch, one batch per
+// portfolio per tick. Unfilled child quantity, whether pulled from the
+// book or cancelled short of a marketable fill, is rolled into the next
+// slice; after the last slice it goes out once more as a final child,
+// and whatever that leaves is reported as the parent's unfilled quantity
+// when it ends.
+class ExecutionScheduler {
+public:
+    // Progress of one parent order
+    struct ParentStatus {
+        uint64_t parentId;
+        SymbolId symbolId;
+        int32_t quantity;
+        int32_t filledQuantity;
+        int32_t workingQuantity; // Child quantity resting in the book
+        uint32_t slicesSent;
+        OrderSide side;
+        ExecutionAlgo algo;
+        int32_t unfilledQuantity; // Left over when the parent ended, 0 while active
+        ExecutionError error;    // Why a child was rejected, ending the parent
+        bool active;
+    };
+
+private:
+    struct Parent {
+        ParentStatus status;
+        OrderRecord record;          // Journaled when the parent ends
+        OrderRecord child;           // Resting child, journaled once it leaves the book
+        Portfolio* portfolio;
+        Price limit;                 // 0 follows the last price
+        uint64_t interval;
+        uint64_t timerId;
+        uint64_t childId;            // Resting child, 0 when none
+        int32_t childResting;        // Its resting quantity when sent
+        int32_t carry;               // Unfilled quantity owed to the next slice
+        int32_t displayQuantity;     // Iceberg peak
+        std::vector<int32_t> slices; // Planned slice sizes, TWAP/VWAP
+        size_t nextSlice;
+        bool finalSent;              // Carry went out after the last slice
+    };
+    
+    TradingEngine& engine;
+    OrderPool childPool;
+    TimerWheel wheel;
+    std::vector<Parent> parents;
+    std::vector<uint32_t> freeParents;
+    std::unordered_map<uint64_t, uint32_t> parentIndex; // Parent id -> slot
+    
+    // Reused across ticks
+    std::vector<uint32_t> dueParents;
+    std::vector<OrderPtr> children;
+    std::vector<uint32_t> childParents;
+    std::vector<size_t> batchOrder;
+    std::vector<OrderPtr> batch;
+    std::vector<ExecutionResult> batchResults;
+    
+    std::vector<ExecutionResult> childResults;
+    std::vector<ParentStatus> completed;
+    std::vector<OrderRecord> orderRecords;
+    
+    uint64_t addParent(Portfolio& portfolio, OrderSide side, SymbolId symbol, int quantity,
+                       Price limit, ExecutionAlgo algo, uint64_t interval);
+    bool validate(SymbolId symbol, int quantity) const;
+    void reclaim(Parent& parent, bool cancelResting);
+    int32_t nextChildQuantity(Parent& parent, bool& done);
+    void finish(uint32_t index);
+    void sendChildren();
+
+public:
+    explicit ExecutionScheduler(TradingEngine& engine, uint64_t startTime = 0);
+    
+    ExecutionScheduler(const ExecutionScheduler&) = delete;
+    ExecutionScheduler& operator=(const ExecutionScheduler&) = delete;
+    
+    // Parent submission; the first child goes out on the next advance.
+    // Returns the parent id, or 0 with a message when rejected.
+    uint64_t submitTwap(Portfolio& portfolio, OrderSide side, SymbolId symbol, int quantity,
+                        Price limit, uint64_t duration, uint64_t interval);
+    uint64_t submitVwap(Portfolio& portfolio, OrderSide side, SymbolId symbol, int quantity,
+                        Price limit, uint64_t duration, const std::vector<double>& volumeProfile);
+    uint64_t submitIceberg(Portfolio& portfolio, OrderSide side, SymbolId symbol, int quantity,
+                           Price limit, int displayQuantity, uint64_t refreshInterval);
+    
+    // Turn strategy signals larger than `maxChildQuantity` into TWAP
+    // parents, removing them from `signals`; the rest stay for a batch
+    size_t scheduleSignals(std::vector<OrderPtr>& signals, Portfolio& portfolio,
+                           int maxChildQuantity, uint64_t duration, uint64_t interval);
+    
+    bool cancel(uint64_t parentId);
+    size_t cancelPortfolio(Portfolio& portfolio);
+    
+    // Move the clock and send every child that came due; returns how many
+    size_t advanceTo(uint64_t time);
+    uint64_t getTime() const;
+    
+    bool getStatus(uint64_t parentId, ParentStatus& status) const;
+    size_t getActiveCount() const;
+    size_t getActive(const Portfolio& portfolio, std::vector<ParentStatus>& statuses) const;
+    
+    // Child executions and finished parents since the previous drain
+    size_t drainChildResults(std::vector<ExecutionResult>& results);
+    size_t drainCompleted(std::vector<ParentStatus>& statuses);
+    
+    // Children once they are done and parents once they end, for the
+    // order journal; parents carry ORDER_FLAG_PARENT
+    size_t drainOrderRecords(std::vector<OrderRecord>& records);
+    
+    // Intraday U-shaped profile: heavier at the open and the close
+    static std::vector<double> defaultVolumeProfile(size_t buckets);
+    static const char* algoName(ExecutionAlgo algo);
+    static void displayStatuses(const std::vector<ParentStatus>& statuses);
+};
+
+#endif
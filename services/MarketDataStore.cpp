@@ -0,0 +1,289 @@
+#include "MarketDataStore.h"
+#include <cmath>
+#include <algorithm>
+
+const size_t MarketDataStore::npos;
+
+MarketDataStore::MarketDataStore()
+    : windowPeriods(Stock::getDefaultWindows()), listener(nullptr) {}
+
+size_t MarketDataStore::addSymbol(const Stock& stock) {
+    SymbolId symbol = SymbolTable::instance().intern(stock.getSymbol());
+    size_t row = findRow(symbol);
+
+    // A replacement with a different depth changes the block layout
+    if (row != npos && stock.getHistoryDepth() != historyCapacities[row]) {
+        removeSymbol(symbol);
+        row = npos;
+    }
+
+    if (row == npos) {
+        appendRow(symbol, stock);
+        row = symbolIds.size() - 1;
+        if (symbol >= rowOfSymbol.size()) {
+            rowOfSymbol.resize(symbol + 1, npos);
+        }
+        rowOfSymbol[symbol] = row;
+    } else {
+        assignRow(row, stock);
+    }
+    return row;
+}
+
+void MarketDataStore::appendRow(SymbolId symbol, const Stock& stock) {
+    PriceHistoryView history = stock.getPriceHistory();
+    size_t capacity = stock.getHistoryDepth();
+
+    symbolIds.push_back(symbol);
+    names.push_back(stock.getName());
+    lastPrices.push_back(stock.getCurrentPrice());
+    previousPrices.push_back(history.size() >= 2 ? FixedPoint::toTicks(history[history.size() - 2])
+                                                 : stock.getCurrentPrice());
+    lastUpdates.push_back(stock.getLastUpdate());
+
+    historyOffsets.push_back(historyBlock.size());
+    historyCapacities.push_back(capacity);
+    historyHeads.push_back(0);
+    historyCounts.push_back(history.size());
+    historyBlock.insert(historyBlock.end(), history.begin(), history.end());
+    historyBlock.resize(historyOffsets.back() + capacity, 0.0);
+
+    for (int period : windowPeriods) {
+        windowBlock.push_back(RollingWindow(period, capacity));
+    }
+    rebuildWindows(symbolIds.size() - 1);
+}
+
+void MarketDataStore::assignRow(size_t row, const Stock& stock) {
+    PriceHistoryView history = stock.getPriceHistory();
+
+    names[row] = stock.getName();
+    lastPrices[row] = stock.getCurrentPrice();
+    previousPrices[row] = history.size() >= 2 ? FixedPoint::toTicks(history[history.size() - 2])
+                                              : stock.getCurrentPrice();
+    lastUpdates[row] = stock.getLastUpdate();
+
+    std::copy(history.begin(), history.end(), historyBlock.begin() + historyOffsets[row]);
+    historyHeads[row] = 0;
+    historyCounts[row] = history.size();
+    rebuildWindows(row);
+}
+
+bool MarketDataStore::removeSymbol(SymbolId symbol) {
+    size_t row = findRow(symbol);
+    if (row == npos) return false;
+
+    size_t offset = historyOffsets[row];
+    size_t capacity = historyCapacities[row];
+    size_t windowCount = windowPeriods.size();
+
+    symbolIds.erase(symbolIds.begin() + row);
+    names.erase(names.begin() + row);
+    lastPrices.erase(lastPrices.begin() + row);
+    previousPrices.erase(previousPrices.begin() + row);
+    lastUpdates.erase(lastUpdates.begin() + row);
+
+    historyBlock.erase(historyBlock.begin() + offset, historyBlock.begin() + offset + capacity);
+    historyOffsets.erase(historyOffsets.begin() + row);
+    historyCapacities.erase(historyCapacities.begin() + row);
+    historyHeads.erase(historyHeads.begin() + row);
+    historyCounts.erase(historyCounts.begin() + row);
+
+    windowBlock.erase(windowBlock.begin() + row * windowCount,
+                      windowBlock.begin() + (row + 1) * windowCount);
+
+    // Rows after the removed one shift down by one
+    rowOfSymbol[symbol] = npos;
+    for (size_t i = row; i < symbolIds.size(); i++) {
+        historyOffsets[i] -= capacity;
+        rowOfSymbol[symbolIds[i]] = i;
+    }
+    return true;
+}
+
+size_t MarketDataStore::findRow(SymbolId symbol) const {
+    return symbol < rowOfSymbol.size() ? rowOfSymbol[symbol] : npos;
+}
+
+void MarketDataStore::clear() {
+    symbolIds.clear();
+    names.clear();
+    lastPrices.clear();
+    previousPrices.clear();
+    lastUpdates.clear();
+    historyBlock.clear();
+    historyOffsets.clear();
+    historyCapacities.clear();
+    historyHeads.clear();
+    historyCounts.clear();
+    windowBlock.clear();
+    rowOfSymbol.clear();
+}
+
+void MarketDataStore::registerWindow(int period) {
+    if (period <= 0) return;
+    for (int existing : windowPeriods) {
+        if (existing == period) return;
+    }
+
+    // Re-layout the window block with one more entry per row
+    size_t oldCount = windowPeriods.size();
+    windowPeriods.push_back(period);
+
+    std::vector<RollingWindow> resized;
+    resized.reserve(symbolIds.size() * windowPeriods.size());
+    for (size_t row = 0; row < symbolIds.size(); row++) {
+        resized.insert(resized.end(), windowBlock.begin() + row * oldCount,
+                       windowBlock.begin() + (row + 1) * oldCount);
+        resized.push_back(RollingWindow(period, historyCapacities[row]));
+    }
+    windowBlock.swap(resized);
+
+    for (size_t row = 0; row < symbolIds.size(); row++) {
+        rebuildWindows(row);
+    }
+}
+
+void MarketDataStore::updatePrice(size_t row, Price price) {
+    previousPrices[row] = lastPrices[row];
+    lastPrices[row] = price;
+    lastUpdates[row] = std::time(nullptr);
+    pushHistory(row, FixedPoint::toDouble(price));
+    
+    if (listener) {
+        listener->onPriceUpdate(row, symbolIds[row], price);
+    }
+}
+
+void MarketDataStore::setPriceListener(PriceListener* priceListener) {
+    listener = priceListener;
+}
+
+void MarketDataStore::pushHistory(size_t row, double price) {
+    PriceHistoryView history = getPriceHistory(row);
+    size_t windowCount = windowPeriods.size();
+    RollingWindow* windows = windowCount > 0 ? &windowBlock[row * windowCount] : nullptr;
+    bool rebuildDue = false;
+
+    for (size_t w = 0; w < windowCount; w++) {
+        windows[w].push(price, history);
+        rebuildDue = rebuildDue || windows[w].needsRebuild();
+    }
+
+    size_t capacity = historyCapacities[row];
+    size_t& head = historyHeads[row];
+    size_t& count = historyCounts[row];
+    double* slice = &historyBlock[historyOffsets[row]];
+
+    if (count < capacity) {
+        size_t pos = head + count;
+        if (pos >= capacity) pos -= capacity;
+        slice[pos] = price;
+        count++;
+    } else {
+        slice[head] = price;
+        if (++head == capacity) head = 0;
+    }
+
+    if (rebuildDue) {
+        rebuildWindows(row);
+    }
+}
+
+void MarketDataStore::rebuildWindows(size_t row) {
+    PriceHistoryView history = getPriceHistory(row);
+    size_t windowCount = windowPeriods.size();
+
+    for (size_t w = 0; w < windowCount; w++) {
+        windowBlock[row * windowCount + w].rebuild(history);
+    }
+}
+
+const RollingWindow* MarketDataStore::findWindow(size_t row, int period) const {
+    size_t windowCount = windowPeriods.size();
+    for (size_t w = 0; w < windowCount; w++) {
+        if (windowPeriods[w] == period) {
+            return &windowBlock[row * windowCount + w];
+        }
+    }
+    return nullptr;
+}
+
+size_t MarketDataStore::size() const {
+    return symbolIds.size();
+}
+
+bool MarketDataStore::empty() const {
+    return symbolIds.empty();
+}
+
+SymbolId MarketDataStore::getSymbolId(size_t row) const {
+    return symbolIds[row];
+}
+
+const std::string& MarketDataStore::getSymbol(size_t row) const {
+    return SymbolTable::instance().name(symbolIds[row]);
+}
+
+const std::string& MarketDataStore::getName(size_t row) const {
+    return names[row];
+}
+
+Price MarketDataStore::getLastPrice(size_t row) const {
+    return lastPrices[row];
+}
+
+Price MarketDataStore::getPreviousPrice(size_t row) const {
+    return previousPrices[row];
+}
+
+time_t MarketDataStore::getLastUpdate(size_t row) const {
+    return lastUpdates[row];
+}
+
+PriceHistoryView MarketDataStore::getPriceHistory(size_t row) const {
+    const double* slice = historyBlock.empty() ? nullptr : &historyBlock[historyOffsets[row]];
+    return PriceHistoryView(slice, historyCapacities[row], historyHeads[row], historyCounts[row]);
+}
+
+Price MarketDataStore::getPriceChange(size_t row) const {
+    return lastPrices[row] - previousPrices[row];
+}
+
+double MarketDataStore::getPriceChangePercent(size_t row) const {
+    if (previousPrices[row] == 0) return 0.0;
+    return (static_cast<double>(getPriceChange(row)) / previousPrices[row]) * 100.0;
+}
+
+double MarketDataStore::getMovingAverage(size_t row, int period) const {
+    const RollingWindow* window = findWindow(row, period);
+    if (window) {
+        return window->mean(historyCounts[row]);
+    }
+
+    // Unregistered period: sum the window directly
+    RollingWindow scratch(period, historyCapacities[row]);
+    scratch.rebuild(getPriceHistory(row));
+    return scratch.mean(historyCounts[row]);
+}
+
+double MarketDataStore::getStdDev(size_t row, int period) const {
+    const RollingWindow* window = findWindow(row, period);
+    if (window) {
+        return std::sqrt(window->variance(historyCounts[row]));
+    }
+
+    RollingWindow scratch(period, historyCapacities[row]);
+    scratch.rebuild(getPriceHistory(row));
+    return std::sqrt(scratch.variance(historyCounts[row]));
+}
+
+const std::vector<Price>& MarketDataStore::getLastPrices() const {
+    return lastPrices;
+}
+
+Stock MarketDataStore::toStock(size_t row) const {
+    Stock stock(getSymbol(row), names[row], lastPrices[row], historyCapacities[row]);
+    stock.loadHistory(getPriceHistory(row));
+    return stock;
+}
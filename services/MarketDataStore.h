@@ -0,0 +1,95 @@
+#ifndef MARKET_DATA_STORE_H
+#define MARKET_DATA_STORE_H
+
+#include <string>
+#include <vector>
+#include <ctime>
+#include <cstddef>
+#include <cstdint>
+#include "../models/Stock.h"
+#include "../utils/RollingWindow.h"
+#include "../utils/SymbolTable.h"
+
+// Notified after every price update, e.g. to fire stop orders
+class PriceListener {
+public:
+    virtual ~PriceListener() = default;
+    virtual void onPriceUpdate(size_t row, SymbolId symbol, Price price) = 0;
+};
+
+// Columnar (structure-of-arrays) market data. Every listed symbol owns one
+// dense row; each field lives in its own contiguous column so full-market
+// scans are linear sweeps instead of tree walks.
+class MarketDataStore {
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+
+private:
+    // Per-row columns
+    std::vector<SymbolId> symbolIds;
+    std::vector<std::string> names;
+    std::vector<Price> lastPrices;
+    std::vector<Price> previousPrices;
+    std::vector<time_t> lastUpdates;
+    
+    // Price history for the indicators: every row owns a circular slice of
+    // one shared block
+    std::vector<double> historyBlock;
+    std::vector<size_t> historyOffsets;
+    std::vector<size_t> historyCapacities;
+    std::vector<size_t> historyHeads;
+    std::vector<size_t> historyCounts;
+    
+    // Indicator windows, row-major with one entry per registered period
+    std::vector<int> windowPeriods;
+    std::vector<RollingWindow> windowBlock;
+    
+    std::vector<size_t> rowOfSymbol; // SymbolId -> row, npos when not listed
+    PriceListener* listener;
+    
+    void appendRow(SymbolId symbol, const Stock& stock);
+    void assignRow(size_t row, const Stock& stock);
+    void pushHistory(size_t row, double price);
+    void rebuildWindows(size_t row);
+    const RollingWindow* findWindow(size_t row, int period) const;
+
+public:
+    // Constructor
+    MarketDataStore();
+    
+    // Symbol management
+    size_t addSymbol(const Stock& stock);
+    bool removeSymbol(SymbolId symbol);
+    size_t findRow(SymbolId symbol) const;
+    void clear();
+    void registerWindow(int period);
+    
+    // Price updates; the listener, if any, runs after each one
+    void updatePrice(size_t row, Price price);
+    void setPriceListener(PriceListener* priceListener);
+    
+    // Row accessors
+    size_t size() const;
+    bool empty() const;
+    SymbolId getSymbolId(size_t row) const;
+    const std::string& getSymbol(size_t row) const; // Ticker text for display
+    const std::string& getName(size_t row) const;
+    Price getLastPrice(size_t row) const;
+    Price getPreviousPrice(size_t row) const;
+    time_t getLastUpdate(size_t row) const;
+    PriceHistoryView getPriceHistory(size_t row) const;
+    
+    // Row metrics
+    Price getPriceChange(size_t row) const;
+    double getPriceChangePercent(size_t row) const;
+    double getMovingAverage(size_t row, int period) const;
+    double getStdDev(size_t row, int period) const;
+    
+    // Whole columns for sweeps
+    const std::vector<Price>& getLastPrices() const;
+    
+    // Compatibility with the object model
+    Stock toStock(size_t row) const;
+};
+
+#endif
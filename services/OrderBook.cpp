@@ -0,0 +1,429 @@
+#include "OrderBook.h"
+#include <limits>
+#include <algorithm>
+#include <iterator>
+
+const uint32_t OrderBook::NONE;
+const size_t OrderBook::MAX_PENDING_LEVELS;
+
+OrderBook::OrderBook(SymbolId symbol)
+    : symbol(symbol), restingCount(0), listener(nullptr), depthLevels(0), depthSequence(0) {}
+
+int32_t OrderBook::submit(uint64_t orderId, OrderSide side, Price limit, int32_t quantity,
+                          uint32_t owner, bool restRemainder, std::vector<Fill>& fills,
+                          FillGate* gate) {
+    LevelMap& opposite = (side == OrderSide::Buy) ? asks : bids;
+    int32_t remaining = quantity;
+    bool blocked = false;
+    
+    while (remaining > 0 && !blocked && !opposite.empty()) {
+        LevelMap::iterator best = opposite.begin();
+        PriceLevel& level = best->second;
+        
+        bool crosses = (side == OrderSide::Buy) ? level.price <= limit : level.price >= limit;
+        if (!crosses) break;
+        touch(side == OrderSide::Buy ? OrderSide::Sell : OrderSide::Buy, level.price);
+        
+        // Walk the level's FIFO queue, oldest order first
+        uint32_t index = level.head;
+        while (remaining > 0 && index != NONE) {
+            RestingOrder& maker = nodes[index];
+            uint32_t next = maker.next;
+            
+            if (owner != NONE && maker.owner == owner) {
+                // Self-trade prevention: cancel the resting order
+                unlink(index);
+            } else {
+                int32_t traded = std::min(remaining, maker.quantity);
+                if (gate) {
+                    int32_t allowed = gate->allowFill(symbol, side, maker.owner, level.price, traded);
+                    if (allowed < traded) {
+                        blocked = true;
+                        traded = std::max(allowed, 0);
+                        if (traded == 0) break;
+                    }
+                }
+                Fill fill = {orderId, maker.orderId, owner, maker.owner, level.price, traded};
+                fills.push_back(fill);
+                
+                remaining -= traded;
+                maker.quantity -= traded;
+                level.totalQuantity -= traded;
+                reduced(maker, traded);
+                
+                if (maker.quantity == 0) {
+                    unlink(index);
+                }
+                if (blocked) break;
+            }
+            
+            index = next;
+        }
+        
+        if (level.orderCount == 0) {
+            opposite.erase(best);
+        }
+    }
+    
+    if (remaining > 0 && restRemainder) {
+        rest(orderId, side, limit, remaining, owner);
+    }
+    
+    return remaining;
+}
+
+void OrderBook::rest(uint64_t orderId, OrderSide side, Price price, int32_t quantity,
+                     uint32_t owner) {
+    PriceLevel empty = {price, 0, 0, NONE, NONE};
+    LevelMap& levels = sideLevels(side);
+    PriceLevel& level = levels.insert(std::make_pair(levelKey(side, price), empty)).first->second;
+    
+    uint32_t index = allocateNode();
+    RestingOrder& node = nodes[index];
+    node.orderId = orderId;
+    node.quantity = quantity;
+    node.owner = owner;
+    node.prev = level.tail;
+    node.next = NONE;
+    node.level = &level;
+    node.side = side;
+    
+    // Append to the back of the level's queue (time priority)
+    if (level.tail != NONE) {
+        nodes[level.tail].next = index;
+    } else {
+        level.head = index;
+    }
+    level.tail = index;
+    level.totalQuantity += quantity;
+    level.orderCount++;
+    restingCount++;
+    orderIndex[orderId] = index;
+    touch(side, price);
+}
+
+void OrderBook::unlink(uint32_t index) {
+    RestingOrder& node = nodes[index];
+    PriceLevel& level = *node.level;
+    
+    if (node.prev != NONE) {
+        nodes[node.prev].next = node.next;
+    } else {
+        level.head = node.next;
+    }
+    
+    if (node.next != NONE) {
+        nodes[node.next].prev = node.prev;
+    } else {
+        level.tail = node.prev;
+    }
+    
+    level.totalQuantity -= node.quantity;
+    level.orderCount--;
+    restingCount--;
+    touch(node.side, level.price);
+    reduced(node, node.quantity);
+    orderIndex.erase(node.orderId);
+    releaseNode(index);
+}
+
+void OrderBook::remove(uint32_t index) {
+    PriceLevel* level = nodes[index].level;
+    OrderSide side = nodes[index].side;
+    unlink(index);
+    
+    if (level->orderCount == 0) {
+        sideLevels(side).erase(levelKey(side, level->price));
+    }
+}
+
+bool OrderBook::cancel(uint64_t orderId) {
+    std::unordered_map<uint64_t, uint32_t>::iterator it = orderIndex.find(orderId);
+    if (it == orderIndex.end()) return false;
+    
+    remove(it->second);
+    return true;
+}
+
+bool OrderBook::amend(uint64_t orderId, int32_t newQuantity) {
+    std::unordered_map<uint64_t, uint32_t>::iterator it = orderIndex.find(orderId);
+    if (it == orderIndex.end()) return false;
+    
+    RestingOrder& node = nodes[it->second];
+    if (newQuantity > node.quantity) return false;
+    
+    if (newQuantity <= 0) {
+        remove(it->second);
+        return true;
+    }
+    
+    // Shrinking in place keeps the order's time priority
+    int32_t removed = node.quantity - newQuantity;
+    node.level->totalQuantity -= removed;
+    node.quantity = newQuantity;
+    touch(node.side, node.level->price);
+    reduced(node, removed);
+    return true;
+}
+
+int32_t OrderBook::replace(uint64_t orderId, uint64_t newOrderId, Price newLimit,
+                           int32_t newQuantity, std::vector<Fill>& fills) {
+    std::unordered_map<uint64_t, uint32_t>::iterator it = orderIndex.find(orderId);
+    if (it == orderIndex.end()) return -1;
+    
+    OrderSide side = nodes[it->second].side;
+    uint32_t owner = nodes[it->second].owner;
+    remove(it->second);
+    
+    return submit(newOrderId, side, newLimit, newQuantity, owner, true, fills);
+}
+
+void OrderBook::reduced(const RestingOrder& node, int32_t quantity) {
+    if (listener && quantity > 0) {
+        listener->onRestingReduced(symbol, node.owner, node.side, node.level->price, quantity);
+    }
+}
+
+void OrderBook::setRestingOrderListener(RestingOrderListener* restingListener) {
+    listener = restingListener;
+}
+
+bool OrderBook::isResting(uint64_t orderId) const {
+    return orderIndex.find(orderId) != orderIndex.end();
+}
+
+int32_t OrderBook::getRestingQuantity(uint64_t orderId) const {
+    std::unordered_map<uint64_t, uint32_t>::const_iterator it = orderIndex.find(orderId);
+    return it != orderIndex.end() ? nodes[it->second].quantity : 0;
+}
+
+bool OrderBook::findResting(uint64_t orderId, RestingView& view) const {
+    std::unordered_map<uint64_t, uint32_t>::const_iterator it = orderIndex.find(orderId);
+    if (it == orderIndex.end()) return false;
+    
+    const RestingOrder& node = nodes[it->second];
+    view.price = node.level->price;
+    view.quantity = node.quantity;
+    view.owner = node.owner;
+    view.side = node.side;
+    return true;
+}
+
+size_t OrderBook::cancelOwner(uint32_t owner) {
+    size_t cancelled = 0;
+    
+    for (uint32_t index = 0; index < nodes.size(); index++) {
+        RestingOrder& node = nodes[index];
+        if (!node.level || node.owner != owner) continue;
+        
+        remove(index);
+        cancelled++;
+    }
+    
+    return cancelled;
+}
+
+uint32_t OrderBook::allocateNode() {
+    if (!freeNodes.empty()) {
+        uint32_t index = freeNodes.back();
+        freeNodes.pop_back();
+        return index;
+    }
+    
+    nodes.push_back(RestingOrder());
+    return static_cast<uint32_t>(nodes.size() - 1);
+}
+
+void OrderBook::releaseNode(uint32_t index) {
+    nodes[index].level = nullptr;
+    freeNodes.push_back(index);
+}
+
+OrderBook::LevelMap& OrderBook::sideLevels(OrderSide side) {
+    return (side == OrderSide::Buy) ? bids : asks;
+}
+
+const OrderBook::LevelMap& OrderBook::sideLevels(OrderSide side) const {
+    return (side == OrderSide::Buy) ? bids : asks;
+}
+
+Price OrderBook::levelKey(OrderSide side, Price price) {
+    return (side == OrderSide::Buy) ? -price : price;
+}
+
+Price OrderBook::marketLimit(OrderSide side) {
+    return (side == OrderSide::Buy) ? std::numeric_limits<Price>::max() : 0;
+}
+
+bool OrderBook::hasBid() const {
+    return !bids.empty();
+}
+
+bool OrderBook::hasAsk() const {
+    return !asks.empty();
+}
+
+Price OrderBook::getBestBid() const {
+    return bids.empty() ? 0 : bids.begin()->second.price;
+}
+
+Price OrderBook::getBestAsk() const {
+    return asks.empty() ? 0 : asks.begin()->second.price;
+}
+
+int64_t OrderBook::getBestBidQuantity() const {
+    return bids.empty() ? 0 : bids.begin()->second.totalQuantity;
+}
+
+int64_t OrderBook::getBestAskQuantity() const {
+    return asks.empty() ? 0 : asks.begin()->second.totalQuantity;
+}
+
+void OrderBook::touch(OrderSide side, Price price) {
+    if (depthLevels == 0) return;
+    
+    DepthChanges& changes = (side == OrderSide::Buy) ? bidChanges : askChanges;
+    if (changes.resync) return;
+    std::vector<Price>& touched = changes.touched;
+    if (!touched.empty() && touched.back() == price) return;
+    touched.push_back(price);
+    
+    // Compact when the list doubles, so it holds at most twice the
+    // distinct levels changed; too many of those and a resync is cheaper
+    if (touched.size() > changes.compactAt) {
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+        if (touched.size() > MAX_PENDING_LEVELS) {
+            touched.clear();
+            changes.resync = true;
+        }
+        changes.compactAt = std::max<size_t>(2 * touched.size(), 64);
+    }
+}
+
+size_t OrderBook::getDepth(OrderSide side, size_t levels, std::vector<DepthLevel>& depth) const {
+    const LevelMap& book = sideLevels(side);
+    size_t added = 0;
+    
+    for (LevelMap::const_iterator it = book.begin(); it != book.end() && added < levels; ++it) {
+        DepthLevel level = {it->second.price, it->second.totalQuantity, it->second.orderCount};
+        depth.push_back(level);
+        added++;
+    }
+    
+    return added;
+}
+
+void OrderBook::getDepthSnapshot(size_t levels, DepthSnapshot& snapshot) const {
+    // Changes not yet drained get later sequence numbers and carry absolute
+    // level state, so replaying them over this snapshot stays consistent
+    snapshot.sequence = depthSequence;
+    snapshot.bids.clear();
+    snapshot.asks.clear();
+    getDepth(OrderSide::Buy, levels, snapshot.bids);
+    getDepth(OrderSide::Sell, levels, snapshot.asks);
+}
+
+void OrderBook::setDepthTracking(size_t levels) {
+    depthLevels = levels;
+    bidChanges = DepthChanges();
+    askChanges = DepthChanges();
+}
+
+bool OrderBook::isDepthTracking() const {
+    return depthLevels > 0;
+}
+
+size_t OrderBook::drainDepthUpdates(std::vector<DepthUpdate>& updates) {
+    if (!isDepthTracking()) return 0;
+    
+    size_t before = updates.size();
+    resolveTouched(OrderSide::Buy, bidChanges, updates);
+    resolveTouched(OrderSide::Sell, askChanges, updates);
+    return updates.size() - before;
+}
+
+void OrderBook::resolveTouched(OrderSide side, DepthChanges& changes,
+                               std::vector<DepthUpdate>& updates) {
+    const LevelMap& book = sideLevels(side);
+    std::vector<Price>& touched = changes.touched;
+    
+    // The deepest followed level; changes beyond it are out of view
+    LevelMap::const_iterator deepest = book.end();
+    if (book.size() >= depthLevels) {
+        deepest = book.begin();
+        std::advance(deepest, depthLevels - 1);
+    }
+    
+    // Best-first order, each level once
+    std::sort(touched.begin(), touched.end(), [side](Price a, Price b) {
+        return levelKey(side, a) < levelKey(side, b);
+    });
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    
+    size_t before = updates.size();
+    if (changes.resync) {
+        DepthUpdate clear;
+        clear.sequence = ++depthSequence;
+        clear.level.price = 0;
+        clear.level.quantity = 0;
+        clear.level.orderCount = 0;
+        clear.side = side;
+        updates.push_back(clear);
+    } else {
+        for (Price price : touched) {
+            if (deepest != book.end() && levelKey(side, price) > deepest->first) break;
+            pushUpdate(side, price, updates);
+        }
+    }
+    
+    // The current top levels follow any change in view, skipping those
+    // just sent
+    if (updates.size() > before) {
+        size_t sent = 0;
+        for (LevelMap::const_iterator it = book.begin(); it != book.end() && sent < depthLevels;
+             ++it, sent++) {
+            if (!changes.resync && std::binary_search(touched.begin(), touched.end(),
+                                                      it->second.price,
+                                                      [side](Price a, Price b) {
+                                                          return levelKey(side, a) < levelKey(side, b);
+                                                      })) {
+                continue;
+            }
+            pushUpdate(side, it->second.price, updates);
+        }
+    }
+    
+    touched.clear();
+    changes.compactAt = 0;
+    changes.resync = false;
+}
+
+void OrderBook::pushUpdate(OrderSide side, Price price, std::vector<DepthUpdate>& updates) {
+    const LevelMap& book = sideLevels(side);
+    LevelMap::const_iterator it = book.find(levelKey(side, price));
+    
+    DepthUpdate update;
+    update.sequence = ++depthSequence;
+    update.level.price = price;
+    update.level.quantity = (it != book.end()) ? it->second.totalQuantity : 0;
+    update.level.orderCount = (it != book.end()) ? it->second.orderCount : 0;
+    update.side = side;
+    updates.push_back(update);
+}
+
+uint64_t OrderBook::getDepthSequence() const {
+    return depthSequence;
+}
+
+SymbolId OrderBook::getSymbol() const {
+    return symbol;
+}
+
+size_t OrderBook::getRestingOrderCount() const {
+    return restingCount;
+}
+
+size_t OrderBook::getLevelCount(OrderSide side) const {
+    return (side == OrderSide::Buy) ? bids.size() : asks.size();
+}
@@ -0,0 +1,213 @@
+#ifndef ORDER_BOOK_H
+#define ORDER_BOOK_H
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "../models/Order.h"
+#include "../utils/FixedPoint.h"
+#include "../utils/SymbolTable.h"
+
+// Told whenever a resting order's open quantity shrinks, through a fill,
+// a cancel, an amend or self-trade prevention, e.g. to release what the
+// order had reserved
+class RestingOrderListener {
+public:
+    virtual ~RestingOrderListener() = default;
+    virtual void onRestingReduced(SymbolId symbol, uint32_t owner, OrderSide side,
+                                  Price price, int32_t quantity) = 0;
+};
+
+// Asked before each fill, while the maker's order is still intact, how
+// much of `quantity` both legs can settle
+class FillGate {
+public:
+    virtual ~FillGate() = default;
+    virtual int32_t allowFill(SymbolId symbol, OrderSide takerSide, uint32_t makerOwner,
+                              Price price, int32_t quantity) = 0;
+};
+
+// Price-time priority limit order book for a single symbol.
+// Each price level keeps a FIFO queue of resting orders; levels are kept
+// sorted best-first so the best bid/offer is always the first level.
+class OrderBook {
+public:
+    static const uint32_t NONE = static_cast<uint32_t>(-1);
+    static const size_t MAX_PENDING_LEVELS = 1024; // Distinct changed levels kept per side between drains
+    
+    // One execution between an incoming (taker) and a resting (maker) order
+    struct Fill {
+        uint64_t takerOrderId;
+        uint64_t makerOrderId;
+        uint32_t takerOwner;
+        uint32_t makerOwner;
+        Price price;
+        int32_t quantity;
+    };
+    
+    // A resting order as seen from outside the book
+    struct RestingView {
+        Price price;
+        int32_t quantity;
+        uint32_t owner;
+        OrderSide side;
+    };
+    
+    // Aggregated state of one price level (market-by-price)
+    struct DepthLevel {
+        Price price;
+        int64_t quantity;
+        uint32_t orderCount;
+    };
+    
+    // Top levels of both sides, best first
+    struct DepthSnapshot {
+        uint64_t sequence; // Apply only updates with a higher sequence
+        std::vector<DepthLevel> bids;
+        std::vector<DepthLevel> asks;
+    };
+    
+    // New absolute state of one level; quantity 0 means the level is gone.
+    // Price 0 clears the side: it is sent when more levels changed between
+    // drains than the book keeps, ahead of the side's current top levels.
+    struct DepthUpdate {
+        uint64_t sequence;
+        DepthLevel level;
+        OrderSide side;
+    };
+
+private:
+    struct PriceLevel {
+        Price price;
+        int64_t totalQuantity;
+        uint32_t orderCount;
+        uint32_t head;  // Oldest resting order (first to fill)
+        uint32_t tail;  // Newest resting order
+    };
+    
+    // Keyed so that the best level is always begin(): asks by price,
+    // bids by negated price
+    typedef std::map<Price, PriceLevel> LevelMap;
+    
+    // Resting order node; nodes are recycled through a free list
+    struct RestingOrder {
+        uint64_t orderId;
+        int32_t quantity;
+        uint32_t owner;
+        uint32_t prev;
+        uint32_t next;
+        PriceLevel* level;
+        OrderSide side;
+    };
+    
+    SymbolId symbol;
+    LevelMap bids;
+    LevelMap asks;
+    std::vector<RestingOrder> nodes;
+    std::vector<uint32_t> freeNodes;
+    std::unordered_map<uint64_t, uint32_t> orderIndex; // Order id -> node
+    size_t restingCount;
+    RestingOrderListener* listener;
+    
+    // Levels changed on one side since the last drain, resolved to deltas
+    // on demand so a sweep through one level yields a single update.
+    // Repeats are compacted away as the list grows; past
+    // MAX_PENDING_LEVELS distinct levels it collapses into a resync.
+    struct DepthChanges {
+        std::vector<Price> touched;
+        size_t compactAt;
+        bool resync;
+        
+        DepthChanges() : compactAt(0), resync(false) {}
+    };
+    
+    size_t depthLevels; // Top levels a subscriber follows; 0 when not tracking
+    uint64_t depthSequence;
+    DepthChanges bidChanges;
+    DepthChanges askChanges;
+    
+    uint32_t allocateNode();
+    void releaseNode(uint32_t index);
+    void rest(uint64_t orderId, OrderSide side, Price price, int32_t quantity, uint32_t owner);
+    void unlink(uint32_t index);
+    void remove(uint32_t index); // Unlink and drop the level if it empties
+    void reduced(const RestingOrder& node, int32_t quantity);
+    
+    LevelMap& sideLevels(OrderSide side);
+    const LevelMap& sideLevels(OrderSide side) const;
+    static Price levelKey(OrderSide side, Price price);
+    
+    void touch(OrderSide side, Price price);
+    void resolveTouched(OrderSide side, DepthChanges& changes, std::vector<DepthUpdate>& updates);
+    void pushUpdate(OrderSide side, Price price, std::vector<DepthUpdate>& updates);
+
+public:
+    explicit OrderBook(SymbolId symbol = INVALID_SYMBOL);
+    
+    // Match an incoming order against the opposite side. Fills are appended
+    // to `fills`; the unfilled remainder rests in the book when `restRemainder`
+    // is set. With a `gate`, matching stops at the first fill it cuts short,
+    // leaving that maker's order as it was. Returns the quantity left unfilled.
+    int32_t submit(uint64_t orderId, OrderSide side, Price limit, int32_t quantity,
+                   uint32_t owner, bool restRemainder, std::vector<Fill>& fills,
+                   FillGate* gate = nullptr);
+    
+    // Resting order management by id, O(1) average
+    bool cancel(uint64_t orderId);
+    
+    // Reduce a resting order's quantity in place, keeping its queue
+    // position. Increases are rejected; reducing to 0 cancels.
+    bool amend(uint64_t orderId, int32_t newQuantity);
+    
+    // Cancel a resting order and submit a replacement with the same side
+    // and owner; the replacement joins the back of its level. Returns the
+    // unfilled quantity, or -1 when `orderId` is not resting.
+    int32_t replace(uint64_t orderId, uint64_t newOrderId, Price newLimit,
+                    int32_t newQuantity, std::vector<Fill>& fills);
+    
+    void setRestingOrderListener(RestingOrderListener* restingListener);
+    
+    bool isResting(uint64_t orderId) const;
+    int32_t getRestingQuantity(uint64_t orderId) const; // 0 when not resting
+    bool findResting(uint64_t orderId, RestingView& view) const; // false when not resting
+    
+    // Remove every resting order that belongs to `owner`
+    size_t cancelOwner(uint32_t owner);
+    
+    // Limit that crosses any resting price, for market orders
+    static Price marketLimit(OrderSide side);
+    
+    // Best bid/offer, O(1)
+    bool hasBid() const;
+    bool hasAsk() const;
+    Price getBestBid() const;
+    Price getBestAsk() const;
+    int64_t getBestBidQuantity() const;
+    int64_t getBestAskQuantity() const;
+    
+    // Level-2 depth: the best `levels` price levels per side, O(levels)
+    size_t getDepth(OrderSide side, size_t levels, std::vector<DepthLevel>& depth) const;
+    void getDepthSnapshot(size_t levels, DepthSnapshot& snapshot) const;
+    
+    // Incremental depth for one subscriber following the top `levels`
+    // per side (0 stops tracking). drainDepthUpdates() appends, in
+    // increasing sequence order, one update per level changed since the
+    // previous drain that is now within the top `levels`, or was removed
+    // from better than the deepest of them. Whenever any is sent, the
+    // side's current top levels follow, so a level that moved up into
+    // view arrives too. A subscriber trims its copy to `levels` after
+    // applying; changes deeper than that are never sent. Nothing is sent
+    // while tracking is off.
+    void setDepthTracking(size_t levels);
+    bool isDepthTracking() const;
+    size_t drainDepthUpdates(std::vector<DepthUpdate>& updates);
+    uint64_t getDepthSequence() const;
+    
+    SymbolId getSymbol() const;
+    size_t getRestingOrderCount() const;
+    size_t getLevelCount(OrderSide side) const;
+};
+
+#endif
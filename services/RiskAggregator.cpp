@@ -0,0 +1,211 @@
+#include "RiskAggregator.h"
+#include "../utils/Colors.h"
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+const size_t RiskAggregator::MIN_ACCOUNTS_PER_WORKER;
+
+RiskAggregator::RiskAggregator(size_t threads) : threadCount(threads) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+size_t RiskAggregator::getThreadCount() const {
+    return threadCount;
+}
+
+void RiskAggregator::scan(const std::vector<const Portfolio*>& portfolios,
+                          const std::vector<Price>& prices, size_t begin, size_t end,
+                          Partial& partial, std::vector<Money>& accountGross,
+                          std::vector<Money>& accountProfitLoss) {
+    Money cash = 0;
+    Money profitLoss = 0;
+    
+    for (size_t i = begin; i < end; i++) {
+        const Portfolio& portfolio = *portfolios[i];
+        Money gross = 0;
+        Money unrealized = 0;
+        cash += portfolio.getCashBalance();
+        
+        for (const Position& pos : portfolio.getPositions()) {
+            SymbolId symbol = pos.symbolId;
+            Price price = (symbol < prices.size() && prices[symbol] > 0) ? prices[symbol]
+                                                                         : pos.marketPrice;
+            Money value = FixedPoint::notional(price, pos.quantity);
+            Money exposure = value < 0 ? -value : value;
+            
+            partial.holders[symbol]++;
+            if (pos.quantity > 0) {
+                partial.longQuantity[symbol] += pos.quantity;
+            } else {
+                partial.shortQuantity[symbol] -= pos.quantity;
+            }
+            partial.grossExposure[symbol] += exposure;
+            partial.netExposure[symbol] += value;
+            
+            gross += exposure;
+            unrealized += value - pos.costBasis();
+        }
+        
+        accountGross[i] = gross;
+        accountProfitLoss[i] = unrealized;
+        profitLoss += unrealized;
+    }
+    
+    partial.cash = cash;
+    partial.profitLoss = profitLoss;
+}
+
+void RiskAggregator::aggregate(const std::vector<const Portfolio*>& portfolios,
+                               const std::vector<Price>& prices, FirmRiskReport& report,
+                               size_t topAccounts) const {
+    size_t accounts = portfolios.size();
+    size_t symbolCount = std::max(prices.size(), SymbolTable::instance().size());
+    size_t workers = std::min(threadCount,
+                              std::max<size_t>(1, accounts / MIN_ACCOUNTS_PER_WORKER));
+    
+    std::vector<Partial> partials(workers);
+    for (Partial& partial : partials) {
+        partial.holders.assign(symbolCount, 0);
+        partial.longQuantity.assign(symbolCount, 0);
+        partial.shortQuantity.assign(symbolCount, 0);
+        partial.grossExposure.assign(symbolCount, 0);
+        partial.netExposure.assign(symbolCount, 0);
+    }
+    std::vector<Money> accountGross(accounts, 0);
+    std::vector<Money> accountProfitLoss(accounts, 0);
+    
+    // Worker w takes accounts [w * n / workers, (w + 1) * n / workers); the
+    // calling thread runs the first range itself
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (size_t w = 1; w < workers; w++) {
+        threads.push_back(std::thread(scan, std::cref(portfolios), std::cref(prices),
+                                      w * accounts / workers, (w + 1) * accounts / workers,
+                                      std::ref(partials[w]), std::ref(accountGross),
+                                      std::ref(accountProfitLoss)));
+    }
+    scan(portfolios, prices, 0, accounts / workers, partials[0], accountGross, accountProfitLoss);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    
+    // Merge in worker order
+    report.accountCount = accounts;
+    report.cash = 0;
+    report.grossExposure = 0;
+    report.netExposure = 0;
+    report.profitLoss = 0;
+    report.symbols.clear();
+    report.topAccounts.clear();
+    
+    for (const Partial& partial : partials) {
+        report.cash += partial.cash;
+        report.profitLoss += partial.profitLoss;
+    }
+    
+    for (size_t symbol = 0; symbol < symbolCount; symbol++) {
+        SymbolRisk risk = {static_cast<SymbolId>(symbol), 0, 0, 0, 0, 0};
+        for (const Partial& partial : partials) {
+            risk.holders += partial.holders[symbol];
+            risk.longQuantity += partial.longQuantity[symbol];
+            risk.shortQuantity += partial.shortQuantity[symbol];
+            risk.grossExposure += partial.grossExposure[symbol];
+            risk.netExposure += partial.netExposure[symbol];
+        }
+        if (risk.holders == 0) continue;
+        
+        report.grossExposure += risk.grossExposure;
+        report.netExposure += risk.netExposure;
+        report.symbols.push_back(risk);
+    }
+    
+    std::sort(report.symbols.begin(), report.symbols.end(),
+              [](const SymbolRisk& a, const SymbolRisk& b) {
+                  if (a.grossExposure != b.grossExposure) return a.grossExposure > b.grossExposure;
+                  return a.symbolId < b.symbolId;
+              });
+    
+    // Largest accounts by gross exposure, ties in account order
+    std::vector<size_t> order(accounts);
+    for (size_t i = 0; i < accounts; i++) {
+        order[i] = i;
+    }
+    size_t top = std::min(topAccounts, accounts);
+    std::partial_sort(order.begin(), order.begin() + top, order.end(),
+                      [&accountGross](size_t a, size_t b) {
+                          if (accountGross[a] != accountGross[b]) return accountGross[a] > accountGross[b];
+                          return a < b;
+                      });
+    for (size_t i = 0; i < top; i++) {
+        AccountRisk risk;
+        risk.userId = portfolios[order[i]]->getUserId();
+        risk.grossExposure = accountGross[order[i]];
+        risk.profitLoss = accountProfitLoss[order[i]];
+        report.topAccounts.push_back(risk);
+    }
+}
+
+void RiskAggregator::displayReport(const FirmRiskReport& report, size_t topSymbols) {
+    std::cout << "\n" << Colors::HEADER << std::string(70, '=') << Colors::RESET << std::endl;
+    std::cout << Colors::BOLD_CYAN << "FIRM-WIDE RISK" << Colors::RESET << std::endl;
+    std::cout << Colors::HEADER << std::string(70, '=') << Colors::RESET << std::endl;
+    
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Accounts: " << report.accountCount << std::endl;
+    std::cout << "Cash: $" << FixedPoint::toDouble(report.cash) << std::endl;
+    std::cout << "Gross Exposure: $" << FixedPoint::toDouble(report.grossExposure) << std::endl;
+    std::cout << "Net Exposure: $" << FixedPoint::toDouble(report.netExposure) << std::endl;
+    
+    Money profitLoss = report.profitLoss;
+    const std::string& color = profitLoss > 0 ? Colors::PROFIT
+                               : (profitLoss < 0 ? Colors::LOSS : Colors::INFO);
+    std::cout << color << "Unrealized P&L: $" << FixedPoint::toDouble(profitLoss)
+              << Colors::RESET << std::endl;
+    
+    if (report.symbols.empty()) {
+        std::cout << Colors::WARNING << "No open positions." << Colors::RESET << std::endl;
+        std::cout << Colors::HEADER << std::string(70, '=') << Colors::RESET << std::endl;
+        return;
+    }
+    
+    std::cout << "\n" << Colors::BOLD << std::left << std::setw(10) << "Symbol"
+              << std::right << std::setw(10) << "Holders"
+              << std::setw(12) << "Net Qty"
+              << std::setw(18) << "Gross Exposure"
+              << std::setw(12) << "% Gross" << Colors::RESET << std::endl;
+    std::cout << Colors::DIM << std::string(70, '-') << Colors::RESET << std::endl;
+    
+    size_t shown = std::min(topSymbols, report.symbols.size());
+    for (size_t i = 0; i < shown; i++) {
+        const SymbolRisk& risk = report.symbols[i];
+        double share = report.grossExposure > 0
+            ? static_cast<double>(risk.grossExposure) / report.grossExposure * 100.0 : 0.0;
+        
+        std::cout << Colors::BOLD_CYAN << std::left << std::setw(10)
+                  << SymbolTable::instance().name(risk.symbolId) << Colors::RESET
+                  << std::right << std::setw(10) << risk.holders
+                  << std::setw(12) << (risk.longQuantity - risk.shortQuantity)
+                  << std::setw(18) << FixedPoint::toDouble(risk.grossExposure)
+                  << std::setw(11) << share << "%" << std::endl;
+    }
+    
+    if (!report.topAccounts.empty()) {
+        std::cout << "\n" << Colors::BOLD << std::left << std::setw(20) << "Account"
+                  << std::right << std::setw(18) << "Gross Exposure"
+                  << std::setw(15) << "P&L" << Colors::RESET << std::endl;
+        std::cout << Colors::DIM << std::string(70, '-') << Colors::RESET << std::endl;
+        
+        for (const AccountRisk& risk : report.topAccounts) {
+            std::cout << std::left << std::setw(20) << risk.userId
+                      << std::right << std::setw(18) << FixedPoint::toDouble(risk.grossExposure)
+                      << std::setw(15) << FixedPoint::toDouble(risk.profitLoss) << std::endl;
+        }
+    }
+    
+    std::cout << Colors::HEADER << std::string(70, '=') << Colors::RESET << std::endl;
+}
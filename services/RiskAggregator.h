@@ -0,0 +1,80 @@
+#ifndef RISK_AGGREGATOR_H
+#define RISK_AGGREGATOR_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "../models/Portfolio.h"
+#include "../utils/FixedPoint.h"
+
+// Firm-wide exposure in one symbol, summed over every account
+struct SymbolRisk {
+    SymbolId symbolId;
+    uint32_t holders;       // Accounts with a position
+    int64_t longQuantity;
+    int64_t shortQuantity;  // Positive share count
+    Money grossExposure;    // Sum of |position| x price
+    Money netExposure;      // Sum of position x price
+};
+
+struct AccountRisk {
+    std::string userId;
+    Money grossExposure;
+    Money profitLoss;
+};
+
+struct FirmRiskReport {
+    size_t accountCount;
+    Money cash;
+    Money grossExposure;
+    Money netExposure;
+    Money profitLoss;                 // Unrealized, at the report prices
+    std::vector<SymbolRisk> symbols;  // Held symbols, largest gross exposure first
+    std::vector<AccountRisk> topAccounts;
+};
+
+// Aggregates risk across many portfolios in parallel. Accounts are split
+// into contiguous ranges, one per worker; each worker sums into its own
+// per-symbol arrays, and the partial sums are merged in worker order once
+// all have finished. Every sum is in integer ticks, so the report is the
+// same for any worker count.
+//
+// Positions are valued at `prices` (indexed by SymbolId, e.g.
+// TradingEngine::getCurrentPrices()), falling back to their last mark for
+// symbols without a price. The portfolios must not change while a report
+// is being built.
+class RiskAggregator {
+public:
+    static const size_t MIN_ACCOUNTS_PER_WORKER = 1024;
+
+private:
+    struct Partial {
+        std::vector<uint32_t> holders;
+        std::vector<int64_t> longQuantity;
+        std::vector<int64_t> shortQuantity;
+        std::vector<Money> grossExposure;
+        std::vector<Money> netExposure;
+        Money cash;
+        Money profitLoss;
+    };
+    
+    size_t threadCount;
+    
+    static void scan(const std::vector<const Portfolio*>& portfolios, const std::vector<Price>& prices,
+                     size_t begin, size_t end, Partial& partial,
+                     std::vector<Money>& accountGross, std::vector<Money>& accountProfitLoss);
+
+public:
+    // `threads` 0 uses one worker per hardware thread
+    explicit RiskAggregator(size_t threads = 0);
+    
+    void aggregate(const std::vector<const Portfolio*>& portfolios, const std::vector<Price>& prices,
+                   FirmRiskReport& report, size_t topAccounts = 10) const;
+    
+    size_t getThreadCount() const;
+    
+    static void displayReport(const FirmRiskReport& report, size_t topSymbols = 10);
+};
+
+#endif
@@ -0,0 +1,234 @@
+#include "RiskGate.h"
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+const uint32_t RiskGate::NONE;
+
+RiskLimits RiskLimits::defaults() {
+    RiskLimits limits;
+    limits.maxOrderNotional = FixedPoint::fromUnits(1000000);
+    limits.maxPosition = 100000;
+    limits.maxGrossExposure = FixedPoint::fromUnits(10000000);
+    limits.priceBandBps = 1000; // 10%
+    return limits;
+}
+
+void RiskLimits::display() const {
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Max Order Notional:  ";
+    if (maxOrderNotional > 0) std::cout << "$" << FixedPoint::toDouble(maxOrderNotional) << "\n";
+    else std::cout << "off\n";
+    std::cout << "Max Position:        ";
+    if (maxPosition > 0) std::cout << maxPosition << " shares\n";
+    else std::cout << "off\n";
+    std::cout << "Max Gross Exposure:  ";
+    if (maxGrossExposure > 0) std::cout << "$" << FixedPoint::toDouble(maxGrossExposure) << "\n";
+    else std::cout << "off\n";
+    std::cout << "Price Band:          ";
+    if (priceBandBps > 0) std::cout << priceBandBps << " bps\n";
+    else std::cout << "off\n";
+    std::cout << std::flush;
+}
+
+std::string RiskLimits::serialize() const {
+    std::ostringstream oss;
+    oss << FixedPoint::toString(maxOrderNotional) << "|" << maxPosition << "|"
+        << FixedPoint::toString(maxGrossExposure) << "|" << priceBandBps;
+    return oss.str();
+}
+
+RiskLimits RiskLimits::deserialize(const std::string& data) {
+    std::istringstream iss(data);
+    std::string notionalStr, positionStr, grossStr, bandStr;
+    
+    std::getline(iss, notionalStr, '|');
+    std::getline(iss, positionStr, '|');
+    std::getline(iss, grossStr, '|');
+    std::getline(iss, bandStr);
+    
+    RiskLimits limits;
+    limits.maxOrderNotional = FixedPoint::parse(notionalStr);
+    limits.maxPosition = std::stoi(positionStr);
+    limits.maxGrossExposure = FixedPoint::parse(grossStr);
+    limits.priceBandBps = static_cast<uint32_t>(std::stoul(bandStr));
+    return limits;
+}
+
+RiskGate::RiskGate()
+    : defaultLimits(RiskLimits::defaults()), enabled(true), batchAccount(NONE), batchGross(0) {}
+
+void RiskGate::setEnabled(bool on) {
+    enabled = on;
+}
+
+bool RiskGate::isEnabled() const {
+    return enabled;
+}
+
+void RiskGate::setDefaultLimits(const RiskLimits& limits) {
+    defaultLimits = limits;
+}
+
+const RiskLimits& RiskGate::getDefaultLimits() const {
+    return defaultLimits;
+}
+
+void RiskGate::setLimits(uint32_t account, const RiskLimits& limits) {
+    getAccount(account).limits = limits;
+}
+
+RiskGate::Account& RiskGate::getAccount(uint32_t account) {
+    if (account >= accounts.size()) {
+        Account empty;
+        empty.limits = defaultLimits;
+        empty.grossExposure = 0;
+        accounts.resize(account + 1, empty);
+    }
+    return accounts[account];
+}
+
+void RiskGate::ensureSymbol(std::vector<int32_t>& positions, std::vector<Money>& exposures,
+                            SymbolId symbol) {
+    if (symbol >= positions.size()) {
+        positions.resize(symbol + 1, 0);
+        exposures.resize(symbol + 1, 0);
+    }
+}
+
+int32_t RiskGate::signedQuantity(OrderSide side, int32_t quantity) {
+    return (side == OrderSide::Buy) ? quantity : -quantity;
+}
+
+Money RiskGate::exposureOf(int32_t position, Price price) {
+    return FixedPoint::notional(price, position < 0 ? -position : position);
+}
+
+void RiskGate::openAccount(uint32_t account, const Portfolio& portfolio,
+                           const RiskLimits& limits) {
+    Account& state = getAccount(account);
+    state.limits = limits;
+    state.grossExposure = 0;
+    std::fill(state.positions.begin(), state.positions.end(), 0);
+    std::fill(state.exposures.begin(), state.exposures.end(), 0);
+    
+    for (const Position& position : portfolio.getPositions()) {
+        SymbolId symbol = position.symbolId;
+        ensureSymbol(state.positions, state.exposures, symbol);
+        state.positions[symbol] = position.quantity;
+        state.exposures[symbol] = exposureOf(position.quantity, position.averagePrice);
+        state.grossExposure += state.exposures[symbol];
+    }
+}
+
+RiskCheck RiskGate::check(uint32_t account, OrderSide side, SymbolId symbol, int32_t quantity,
+                          Price price, Price lastPrice) const {
+    if (!enabled || account >= accounts.size()) return RiskCheck::Passed;
+    const Account& state = accounts[account];
+    const RiskLimits& limits = state.limits;
+    
+    if (limits.maxOrderNotional > 0 &&
+        FixedPoint::notional(price, quantity) > limits.maxOrderNotional) {
+        return RiskCheck::OrderNotional;
+    }
+    
+    if (limits.priceBandBps > 0 && lastPrice > 0) {
+        Price distance = price > lastPrice ? price - lastPrice : lastPrice - price;
+        if (distance * 10000 > lastPrice * static_cast<int64_t>(limits.priceBandBps)) {
+            return RiskCheck::PriceBand;
+        }
+    }
+    
+    // Current counters plus whatever this batch has already reserved
+    bool inBatch = (account == batchAccount);
+    bool touched = inBatch && symbol < batchTouched.size() && batchTouched[symbol];
+    int32_t position = symbol < state.positions.size() ? state.positions[symbol] : 0;
+    Money symbolExposure = symbol < state.exposures.size() ? state.exposures[symbol] : 0;
+    Money gross = inBatch ? batchGross : state.grossExposure;
+    if (touched) {
+        position += batchPositions[symbol];
+        symbolExposure = batchExposures[symbol];
+    }
+    
+    int32_t projected = position + signedQuantity(side, quantity);
+    if (limits.maxPosition > 0 && (projected > limits.maxPosition || projected < -limits.maxPosition)) {
+        return RiskCheck::PositionLimit;
+    }
+    
+    if (limits.maxGrossExposure > 0 &&
+        gross - symbolExposure + exposureOf(projected, price) > limits.maxGrossExposure) {
+        return RiskCheck::GrossExposure;
+    }
+    
+    return RiskCheck::Passed;
+}
+
+void RiskGate::reserve(uint32_t account, OrderSide side, SymbolId symbol, int32_t quantity,
+                       Price price) {
+    if (!enabled) return;
+    Account& state = getAccount(account);
+    ensureSymbol(state.positions, state.exposures, symbol);
+    
+    if (batchAccount != account) {
+        releaseReservations();
+        batchAccount = account;
+        batchGross = state.grossExposure;
+    }
+    ensureSymbol(batchPositions, batchExposures, symbol);
+    if (symbol >= batchTouched.size()) {
+        batchTouched.resize(symbol + 1, 0);
+    }
+    
+    if (!batchTouched[symbol]) {
+        batchTouched[symbol] = 1;
+        batchPositions[symbol] = 0;
+        batchExposures[symbol] = state.exposures[symbol];
+        batchSymbols.push_back(symbol);
+    }
+    
+    batchPositions[symbol] += signedQuantity(side, quantity);
+    Money exposure = exposureOf(state.positions[symbol] + batchPositions[symbol], price);
+    batchGross += exposure - batchExposures[symbol];
+    batchExposures[symbol] = exposure;
+}
+
+void RiskGate::releaseReservations() {
+    for (SymbolId symbol : batchSymbols) {
+        batchTouched[symbol] = 0;
+    }
+    batchSymbols.clear();
+    batchAccount = NONE;
+    batchGross = 0;
+}
+
+void RiskGate::onFill(uint32_t account, OrderSide side, SymbolId symbol, int32_t quantity,
+                      Price price) {
+    if (account >= accounts.size()) return;
+    Account& state = accounts[account];
+    ensureSymbol(state.positions, state.exposures, symbol);
+    
+    state.positions[symbol] += signedQuantity(side, quantity);
+    Money exposure = exposureOf(state.positions[symbol], price);
+    state.grossExposure += exposure - state.exposures[symbol];
+    state.exposures[symbol] = exposure;
+}
+
+int32_t RiskGate::getPosition(uint32_t account, SymbolId symbol) const {
+    if (account >= accounts.size() || symbol >= accounts[account].positions.size()) return 0;
+    return accounts[account].positions[symbol];
+}
+
+Money RiskGate::getGrossExposure(uint32_t account) const {
+    return account < accounts.size() ? accounts[account].grossExposure : 0;
+}
+
+const char* RiskGate::checkName(RiskCheck check) {
+    switch (check) {
+        case RiskCheck::OrderNotional: return "ORDER NOTIONAL LIMIT";
+        case RiskCheck::PositionLimit: return "POSITION LIMIT";
+        case RiskCheck::GrossExposure: return "GROSS EXPOSURE LIMIT";
+        case RiskCheck::PriceBand: return "PRICE BAND";
+        default: return "PASSED";
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef RISK_GATE_H
+#define RISK_GATE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "../models/Order.h"
+#include "../models/Portfolio.h"
+#include "../utils/FixedPoint.h"
+
+// Per-account pre-trade limits; 0 disables a limit
+struct RiskLimits {
+    Money maxOrderNotional;  // Price x quantity of a single order
+    int32_t maxPosition;     // Shares held in one symbol
+    Money maxGrossExposure;  // Sum over symbols of |position| x reference price
+    uint32_t priceBandBps;   // Fat-finger band around the last price, basis points
+    
+    static RiskLimits defaults();
+    
+    void display() const; // One line per limit, "off" when disabled
+    
+    // "notional|position|gross|band", money as exact tick decimals
+    std::string serialize() const;
+    static RiskLimits deserialize(const std::string& data);
+};
+
+// Outcome of a pre-trade check
+enum class RiskCheck : uint8_t {
+    Passed,
+    OrderNotional,
+    PositionLimit,
+    GrossExposure,
+    PriceBand
+};
+
+// Inline pre-trade risk checks. Every account keeps running counters
+// (position and exposure per symbol, gross exposure) that fills update
+// incrementally, so a check is a handful of array reads and compares
+// instead of a walk over the portfolio. Accounts are the engine's book
+// owner ids.
+//
+// Exposure is valued at the price of the trade that last changed each
+// position, which keeps the counters O(1) to maintain as prices move.
+class RiskGate {
+private:
+    struct Account {
+        RiskLimits limits;
+        Money grossExposure;
+        std::vector<int32_t> positions; // SymbolId -> shares
+        std::vector<Money> exposures;   // SymbolId -> |shares| x reference price
+    };
+    
+    RiskLimits defaultLimits;
+    std::vector<Account> accounts;
+    bool enabled;
+    
+    // Batch reservations: orders accepted earlier in a batch count
+    // against the limits of later ones until the batch is released
+    uint32_t batchAccount;
+    Money batchGross;
+    std::vector<int32_t> batchPositions;  // SymbolId -> reserved shares
+    std::vector<Money> batchExposures;    // SymbolId -> projected exposure
+    std::vector<uint8_t> batchTouched;
+    std::vector<SymbolId> batchSymbols;
+    
+    Account& getAccount(uint32_t account);
+    static void ensureSymbol(std::vector<int32_t>& positions, std::vector<Money>& exposures,
+                             SymbolId symbol);
+    static int32_t signedQuantity(OrderSide side, int32_t quantity);
+    static Money exposureOf(int32_t position, Price price);
+
+public:
+    static const uint32_t NONE = static_cast<uint32_t>(-1);
+    
+    RiskGate();
+    
+    void setEnabled(bool on);
+    bool isEnabled() const;
+    
+    // Limits applied to newly opened accounts
+    void setDefaultLimits(const RiskLimits& limits);
+    const RiskLimits& getDefaultLimits() const;
+    void setLimits(uint32_t account, const RiskLimits& limits);
+    
+    // Reset an account's counters from its current holdings, valued at
+    // their average prices, under `limits`
+    void openAccount(uint32_t account, const Portfolio& portfolio, const RiskLimits& limits);
+    
+    // O(1) pre-trade check of an order at `price` (the effective price for
+    // market-style orders) against the account's counters
+    RiskCheck check(uint32_t account, OrderSide side, SymbolId symbol, int32_t quantity,
+                    Price price, Price lastPrice) const;
+    
+    // Batch mode: count an accepted order against later checks
+    void reserve(uint32_t account, OrderSide side, SymbolId symbol, int32_t quantity, Price price);
+    void releaseReservations();
+    
+    // Keep the counters in step with executions
+    void onFill(uint32_t account, OrderSide side, SymbolId symbol, int32_t quantity, Price price);
+    
+    int32_t getPosition(uint32_t account, SymbolId symbol) const;
+    Money getGrossExposure(uint32_t account) const;
+    
+    static const char* checkName(RiskCheck check);
+};
+
+#endif
@@ -0,0 +1,308 @@
+#include "ShardedMatchingEngine.h"
+#include <algorithm>
+
+const size_t ShardedMatchingEngine::npos;
+const int ShardedMatchingEngine::IDLE_SPINS;
+
+ShardedMatchingEngine::Shard::Shard(size_t queueCapacity)
+    : inbound(queueCapacity), outbound(queueCapacity), parked(false), routed(0), processed(0),
+      trades(0) {}
+
+ShardedMatchingEngine::ShardedMatchingEngine(size_t shardCount, size_t queueCapacity,
+                                             bool publishTrades)
+    : running(false), publishTrades(publishTrades) {
+    if (shardCount == 0) {
+        shardCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    for (size_t i = 0; i < shardCount; i++) {
+        shards.push_back(std::unique_ptr<Shard>(new Shard(queueCapacity)));
+    }
+}
+
+ShardedMatchingEngine::~ShardedMatchingEngine() {
+    stop();
+}
+
+bool ShardedMatchingEngine::addSymbol(const Stock& stock) {
+    if (isRunning()) return false;
+    
+    SymbolId symbol = SymbolTable::instance().intern(stock.getSymbol());
+    if (getShardOf(symbol) != npos) return false;
+    
+    // Round-robin keeps the shards balanced however the ids are spread
+    size_t assigned = 0;
+    for (uint32_t index : shardOfSymbol) {
+        if (index != static_cast<uint32_t>(npos)) assigned++;
+    }
+    uint32_t index = static_cast<uint32_t>(assigned % shards.size());
+    
+    if (symbol >= shardOfSymbol.size()) {
+        shardOfSymbol.resize(symbol + 1, static_cast<uint32_t>(npos));
+    }
+    shardOfSymbol[symbol] = index;
+    
+    Shard& shard = *shards[index];
+    shard.market.addSymbol(stock);
+    if (symbol >= shard.books.size()) {
+        shard.books.resize(symbol + 1);
+    }
+    shard.books[symbol].reset(new OrderBook(symbol));
+    return true;
+}
+
+void ShardedMatchingEngine::start() {
+    if (isRunning()) return;
+    
+    running.store(true, std::memory_order_release);
+    for (size_t i = 0; i < shards.size(); i++) {
+        Shard* shard = shards[i].get();
+        shard->worker = std::thread([this, shard]() { runShard(*shard); });
+    }
+}
+
+void ShardedMatchingEngine::stop() {
+    if (!isRunning()) return;
+    
+    running.store(false, std::memory_order_release);
+    for (size_t i = 0; i < shards.size(); i++) {
+        std::lock_guard<std::mutex> lock(shards[i]->parkMutex);
+        shards[i]->wake.notify_one();
+    }
+    for (size_t i = 0; i < shards.size(); i++) {
+        if (shards[i]->worker.joinable()) {
+            shards[i]->worker.join();
+        }
+    }
+}
+
+bool ShardedMatchingEngine::isRunning() const {
+    return running.load(std::memory_order_acquire);
+}
+
+void ShardedMatchingEngine::runShard(Shard& shard) {
+    MatchCommand command;
+    int idle = 0;
+    
+    for (;;) {
+        if (shard.inbound.tryPop(command)) {
+            process(shard, command);
+            idle = 0;
+            continue;
+        }
+        
+        flushOverflow(shard);
+        
+        // Only exit once the queue is drained, so stop() loses nothing
+        if (!running.load(std::memory_order_acquire) && shard.inbound.empty()) break;
+        
+        // Trades waiting on a slow reader need polling, so back off
+        // rather than park; otherwise park once the spin budget is spent
+        if (++idle < IDLE_SPINS || !shard.overflow.empty()) {
+            std::this_thread::yield();
+        } else {
+            park(shard);
+            idle = 0;
+        }
+    }
+}
+
+void ShardedMatchingEngine::park(Shard& shard) {
+    std::unique_lock<std::mutex> lock(shard.parkMutex);
+    shard.parked.store(true, std::memory_order_relaxed);
+    
+    // Pairs with the fence in wakeShard(): either the router sees the
+    // flag and notifies, or this check sees its command
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    shard.wake.wait(lock, [this, &shard]() {
+        return !shard.inbound.empty() || !running.load(std::memory_order_acquire);
+    });
+    shard.parked.store(false, std::memory_order_relaxed);
+}
+
+void ShardedMatchingEngine::wakeShard(Shard& shard) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (shard.parked.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(shard.parkMutex);
+        shard.wake.notify_one();
+    }
+}
+
+void ShardedMatchingEngine::process(Shard& shard, const MatchCommand& command) {
+    const OrderRecord& order = command.order;
+    OrderBook& book = *shard.books[order.symbolId];
+    
+    switch (command.type) {
+        case MatchCommand::Submit:
+            shard.fills.clear();
+            book.submit(order.orderId, order.side, order.price,
+                        order.quantity - order.filledQuantity, command.owner, true, shard.fills);
+            if (!shard.fills.empty()) {
+                shard.market.updatePrice(shard.market.findRow(order.symbolId),
+                                         shard.fills.back().price);
+                shard.trades.store(shard.trades.load(std::memory_order_relaxed) + shard.fills.size(),
+                                   std::memory_order_relaxed);
+                if (publishTrades) publish(shard, order.symbolId);
+            }
+            break;
+        case MatchCommand::Cancel:
+            book.cancel(order.orderId);
+            break;
+        case MatchCommand::Amend:
+            book.amend(order.orderId, order.quantity);
+            break;
+    }
+    
+    // Single writer, so a plain store publishes the count; release makes
+    // the book changes visible to a thread that observes it
+    shard.processed.store(shard.processed.load(std::memory_order_relaxed) + 1,
+                          std::memory_order_release);
+}
+
+void ShardedMatchingEngine::publish(Shard& shard, SymbolId symbol) {
+    flushOverflow(shard);
+    
+    for (const OrderBook::Fill& fill : shard.fills) {
+        TradeEvent event = {symbol, fill};
+        // Never block on a slow reader: park trades until there is room
+        if (!shard.overflow.empty() || !shard.outbound.tryPush(event)) {
+            shard.overflow.push_back(event);
+        }
+    }
+}
+
+void ShardedMatchingEngine::flushOverflow(Shard& shard) {
+    size_t sent = 0;
+    while (sent < shard.overflow.size() && shard.outbound.tryPush(shard.overflow[sent])) {
+        sent++;
+    }
+    shard.overflow.erase(shard.overflow.begin(), shard.overflow.begin() + sent);
+}
+
+void ShardedMatchingEngine::route(const MatchCommand& command) {
+    Shard& shard = *shards[shardOfSymbol[command.order.symbolId]];
+    
+    // Back-pressure: wait for the shard to make room
+    while (!shard.inbound.tryPush(command)) {
+        std::this_thread::yield();
+    }
+    shard.routed++;
+    wakeShard(shard);
+    
+    // Without workers the command is applied inline, e.g. before start()
+    if (!isRunning()) {
+        MatchCommand queued;
+        while (shard.inbound.tryPop(queued)) {
+            process(shard, queued);
+        }
+    }
+}
+
+bool ShardedMatchingEngine::submit(const OrderRecord& order, uint32_t owner) {
+    if (getShardOf(order.symbolId) == npos || order.quantity <= order.filledQuantity) {
+        return false;
+    }
+    
+    MatchCommand command;
+    command.order = order;
+    command.owner = owner;
+    command.type = MatchCommand::Submit;
+    route(command);
+    return true;
+}
+
+bool ShardedMatchingEngine::cancel(SymbolId symbol, uint64_t orderId) {
+    if (getShardOf(symbol) == npos) return false;
+    
+    MatchCommand command = MatchCommand();
+    command.order.orderId = orderId;
+    command.order.symbolId = symbol;
+    command.owner = OrderBook::NONE;
+    command.type = MatchCommand::Cancel;
+    route(command);
+    return true;
+}
+
+bool ShardedMatchingEngine::amend(SymbolId symbol, uint64_t orderId, int32_t newQuantity) {
+    if (getShardOf(symbol) == npos) return false;
+    
+    MatchCommand command = MatchCommand();
+    command.order.orderId = orderId;
+    command.order.symbolId = symbol;
+    command.order.quantity = newQuantity;
+    command.owner = OrderBook::NONE;
+    command.type = MatchCommand::Amend;
+    route(command);
+    return true;
+}
+
+size_t ShardedMatchingEngine::pollTrades(std::vector<TradeEvent>& trades, size_t maxTrades) {
+    size_t polled = 0;
+    TradeEvent event;
+    
+    for (size_t i = 0; i < shards.size() && polled < maxTrades; i++) {
+        Shard& shard = *shards[i];
+        while (polled < maxTrades && shard.outbound.tryPop(event)) {
+            trades.push_back(event);
+            polled++;
+        }
+        
+        // Stopped workers no longer flush their overflow, so read it here
+        if (!isRunning()) {
+            size_t taken = std::min(maxTrades - polled, shard.overflow.size());
+            trades.insert(trades.end(), shard.overflow.begin(), shard.overflow.begin() + taken);
+            shard.overflow.erase(shard.overflow.begin(), shard.overflow.begin() + taken);
+            polled += taken;
+        }
+    }
+    
+    return polled;
+}
+
+void ShardedMatchingEngine::waitIdle() const {
+    for (size_t i = 0; i < shards.size(); i++) {
+        const Shard& shard = *shards[i];
+        while (shard.processed.load(std::memory_order_acquire) < shard.routed) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+size_t ShardedMatchingEngine::getShardCount() const {
+    return shards.size();
+}
+
+size_t ShardedMatchingEngine::getShardOf(SymbolId symbol) const {
+    if (symbol >= shardOfSymbol.size()) return npos;
+    uint32_t index = shardOfSymbol[symbol];
+    return index == static_cast<uint32_t>(npos) ? npos : index;
+}
+
+uint64_t ShardedMatchingEngine::getProcessedCount() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < shards.size(); i++) {
+        total += shards[i]->processed.load(std::memory_order_acquire);
+    }
+    return total;
+}
+
+uint64_t ShardedMatchingEngine::getTradeCount() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < shards.size(); i++) {
+        total += shards[i]->trades.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+const OrderBook* ShardedMatchingEngine::findBook(SymbolId symbol) const {
+    size_t index = getShardOf(symbol);
+    return index == npos ? nullptr : shards[index]->books[symbol].get();
+}
+
+Price ShardedMatchingEngine::getLastTradePrice(SymbolId symbol) const {
+    size_t index = getShardOf(symbol);
+    if (index == npos) return 0;
+    
+    const MarketDataStore& market = shards[index]->market;
+    return market.getLastPrice(market.findRow(symbol));
+}
@@ -0,0 +1,127 @@
+#ifndef SHARDED_MATCHING_ENGINE_H
+#define SHARDED_MATCHING_ENGINE_H
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include "../models/Order.h"
+#include "../models/Stock.h"
+#include "../utils/SpscQueue.h"
+#include "MarketDataStore.h"
+#include "OrderBook.h"
+
+// One instruction routed to the shard that owns its symbol. The order
+// travels as its POD record, so a command is a flat copy into the queue.
+struct MatchCommand {
+    enum Type : uint8_t {
+        Submit,  // Match `order`, resting any remainder
+        Cancel,  // Cancel `order.orderId`
+        Amend    // Reduce `order.orderId` to `order.quantity`
+    };
+    
+    OrderRecord order;
+    uint32_t owner;
+    Type type;
+};
+
+// A fill tagged with the symbol it traded in
+struct TradeEvent {
+    SymbolId symbolId;
+    OrderBook::Fill fill;
+};
+
+// Matching engine that partitions symbols across worker threads. Each shard
+// owns the order books and market data for its symbols outright, so the
+// matching path takes no locks: commands reach the owning shard through a
+// single-producer/single-consumer queue and trades come back the same way.
+//
+// An idle worker spins briefly, then parks on its shard's condition
+// variable; routing a command wakes it only when it is parked, so a busy
+// shard never touches the lock.
+//
+// Threading contract: addSymbol() before start(); submit/cancel/amend,
+// pollTrades() and waitIdle() from one controlling thread. Per-shard
+// state (books, last prices) may be read only after waitIdle() or stop().
+class ShardedMatchingEngine {
+public:
+    static const size_t npos = static_cast<size_t>(-1);
+    static const int IDLE_SPINS = 256; // Empty polls before a worker parks
+
+private:
+    struct Shard {
+        SpscQueue<MatchCommand> inbound;
+        SpscQueue<TradeEvent> outbound;
+        MarketDataStore market;
+        std::vector<std::unique_ptr<OrderBook>> books; // SymbolId -> book
+        std::vector<OrderBook::Fill> fills;            // Reused per command
+        std::vector<TradeEvent> overflow; // Trades waiting for outbound room
+        std::thread worker;
+        
+        std::mutex parkMutex;
+        std::condition_variable wake;
+        std::atomic<bool> parked;
+        
+        uint64_t routed; // Commands pushed; controlling thread only
+        std::atomic<uint64_t> processed;
+        std::atomic<uint64_t> trades;
+        
+        explicit Shard(size_t queueCapacity);
+    };
+    
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<uint32_t> shardOfSymbol; // SymbolId -> shard index
+    std::atomic<bool> running;
+    bool publishTrades;
+    
+    void route(const MatchCommand& command);
+    void runShard(Shard& shard);
+    void process(Shard& shard, const MatchCommand& command);
+    void publish(Shard& shard, SymbolId symbol);
+    void flushOverflow(Shard& shard);
+    void park(Shard& shard);
+    void wakeShard(Shard& shard);
+    
+    ShardedMatchingEngine(const ShardedMatchingEngine&);
+    ShardedMatchingEngine& operator=(const ShardedMatchingEngine&);
+
+public:
+    // `shardCount` 0 uses one shard per hardware thread. With
+    // `publishTrades` off, trades are only counted, never queued back.
+    explicit ShardedMatchingEngine(size_t shardCount = 0, size_t queueCapacity = 65536,
+                                   bool publishTrades = true);
+    ~ShardedMatchingEngine();
+    
+    // Symbols are assigned round-robin in the order they are added
+    bool addSymbol(const Stock& stock);
+    
+    void start();
+    void stop(); // Drains every queued command before the workers exit
+    bool isRunning() const;
+    
+    // Routing; the caller blocks only while the owning shard's queue is full
+    bool submit(const OrderRecord& order, uint32_t owner = OrderBook::NONE);
+    bool cancel(SymbolId symbol, uint64_t orderId);
+    bool amend(SymbolId symbol, uint64_t orderId, int32_t newQuantity);
+    
+    // Move up to `maxTrades` published trades into `trades`; returns the count
+    size_t pollTrades(std::vector<TradeEvent>& trades, size_t maxTrades = static_cast<size_t>(-1));
+    
+    // Spin until every routed command has been processed
+    void waitIdle() const;
+    
+    size_t getShardCount() const;
+    size_t getShardOf(SymbolId symbol) const; // npos when unassigned
+    uint64_t getProcessedCount() const;
+    uint64_t getTradeCount() const;
+    
+    // Shard state; valid after waitIdle() or stop()
+    const OrderBook* findBook(SymbolId symbol) const;
+    Price getLastTradePrice(SymbolId symbol) const; // 0 when unassigned
+};
+
+#endif
@@ -0,0 +1,315 @@
+#include "StopIndex.h"
+
+const uint32_t StopIndex::NONE;
+
+StopIndex::StopIndex(SymbolId symbol)
+    : symbol(symbol), liveCount(0) {}
+
+StopIndex::Side& StopIndex::sideOf(OrderSide side) {
+    return (side == OrderSide::Buy) ? buys : sells;
+}
+
+Price StopIndex::normalize(OrderSide side, Price price) {
+    return (side == OrderSide::Buy) ? -price : price;
+}
+
+void StopIndex::add(const StopOrder& stop, Price lastPrice) {
+    OrderSide orderSide = stop.order.side;
+    Side& side = sideOf(orderSide);
+    
+    uint32_t index = allocateSlot();
+    Slot& slot = slots[index];
+    slot.stop = stop;
+    slot.live = true;
+    
+    if (stop.type != StopType::TrailingStop) {
+        slot.group = NONE;
+        slot.entry = side.stops.insert(std::make_pair(-normalize(orderSide, stop.stopPrice), index));
+    } else {
+        // Join the group anchored at the current price, opening one if needed
+        Price current = normalize(orderSide, lastPrice);
+        raise(side, current);
+        
+        uint32_t group;
+        if (!side.groupStack.empty() && groups[side.groupStack.back()].peak == current) {
+            group = side.groupStack.back();
+        } else {
+            group = allocateGroup(current);
+            side.groupStack.push_back(group);
+        }
+        
+        slot.group = group;
+        slot.entry = groups[group].members.insert(std::make_pair(stop.trailAmount, index));
+        slot.stop.stopPrice = normalize(orderSide, current - stop.trailAmount);
+        relist(side, group);
+    }
+    
+    slotIndex[stop.order.orderId] = index;
+    liveCount++;
+}
+
+bool StopIndex::cancel(uint64_t orderId) {
+    std::unordered_map<uint64_t, uint32_t>::iterator it = slotIndex.find(orderId);
+    if (it == slotIndex.end()) return false;
+    
+    uint32_t index = it->second;
+    Side& side = sideOf(slots[index].stop.order.side);
+    uint32_t group = slots[index].group;
+    
+    if (group == NONE) {
+        side.stops.erase(slots[index].entry);
+    } else {
+        groups[group].members.erase(slots[index].entry);
+        relist(side, group);
+        retire(side, group);
+    }
+    
+    release(index, nullptr);
+    return true;
+}
+
+size_t StopIndex::cancelOwner(uint32_t owner) {
+    size_t cancelled = 0;
+    
+    for (uint32_t index = 0; index < slots.size(); index++) {
+        if (!slots[index].live || slots[index].stop.owner != owner) continue;
+        
+        cancel(slots[index].stop.order.orderId);
+        cancelled++;
+    }
+    
+    return cancelled;
+}
+
+size_t StopIndex::onPrice(Price price, std::vector<StopOrder>& triggered) {
+    if (liveCount == 0) return 0;
+    
+    size_t before = triggered.size();
+    raise(sells, normalize(OrderSide::Sell, price));
+    trigger(sells, OrderSide::Sell, normalize(OrderSide::Sell, price), triggered);
+    raise(buys, normalize(OrderSide::Buy, price));
+    trigger(buys, OrderSide::Buy, normalize(OrderSide::Buy, price), triggered);
+    return triggered.size() - before;
+}
+
+void StopIndex::raise(Side& side, Price price) {
+    // Groups whose best price is now beaten sit on top of the stack;
+    // they merge into one group anchored at the new price
+    std::vector<uint32_t>& stack = side.groupStack;
+    size_t first = stack.size();
+    while (first > 0 && groups[stack[first - 1]].peak < price) {
+        first--;
+    }
+    if (first == stack.size()) return;
+    
+    // Keep the largest group and move the others' members into it
+    uint32_t target = stack[first];
+    for (size_t i = first; i < stack.size(); i++) {
+        if (groups[stack[i]].members.empty()) side.emptyGroups--;
+        if (groups[stack[i]].members.size() > groups[target].members.size()) {
+            target = stack[i];
+        }
+    }
+    
+    TrailGroup& merged = groups[target];
+    for (size_t i = first; i < stack.size(); i++) {
+        uint32_t group = stack[i];
+        if (group == target) continue;
+        
+        TrailGroup& source = groups[group];
+        for (TriggerMap::iterator it = source.members.begin(); it != source.members.end(); ++it) {
+            Slot& slot = slots[it->second];
+            slot.group = target;
+            slot.entry = merged.members.insert(*it);
+        }
+        source.members.clear();
+        if (source.listed) {
+            side.thresholds.erase(source.entry);
+            source.listed = false;
+        }
+        freeGroups.push_back(group);
+    }
+    
+    merged.peak = price;
+    relist(side, target);
+    
+    stack.resize(first);
+    if (merged.members.empty()) {
+        freeGroups.push_back(target);
+        popEmpty(side);
+    } else {
+        stack.push_back(target);
+    }
+}
+
+void StopIndex::trigger(Side& side, OrderSide orderSide, Price price,
+                        std::vector<StopOrder>& triggered) {
+    // Fixed stops: every stop at or beyond the price, nearest first
+    while (!side.stops.empty() && side.stops.begin()->first <= -price) {
+        uint32_t index = side.stops.begin()->second;
+        side.stops.erase(side.stops.begin());
+        release(index, &triggered);
+    }
+    
+    // Trailing stops: groups whose tightest stop is reached
+    while (!side.thresholds.empty() && side.thresholds.begin()->first <= -price) {
+        uint32_t group = side.thresholds.begin()->second;
+        TrailGroup& trail = groups[group];
+        
+        while (!trail.members.empty() && trail.members.begin()->first <= trail.peak - price) {
+            uint32_t index = trail.members.begin()->second;
+            slots[index].stop.stopPrice = normalize(orderSide, trail.peak - trail.members.begin()->first);
+            trail.members.erase(trail.members.begin());
+            release(index, &triggered);
+        }
+        relist(side, group);
+        retire(side, group);
+    }
+}
+
+void StopIndex::relist(Side& side, uint32_t group) {
+    TrailGroup& trail = groups[group];
+    if (trail.listed) {
+        side.thresholds.erase(trail.entry);
+        trail.listed = false;
+    }
+    
+    // The tightest trail in the group fires first
+    if (!trail.members.empty()) {
+        Price stop = trail.peak - trail.members.begin()->first;
+        trail.entry = side.thresholds.insert(std::make_pair(-stop, group));
+        trail.listed = true;
+    }
+}
+
+void StopIndex::retire(Side& side, uint32_t group) {
+    if (!groups[group].members.empty()) return;
+    
+    side.emptyGroups++;
+    if (side.emptyGroups * 2 > side.groupStack.size()) {
+        compact(side);
+    } else {
+        popEmpty(side);
+    }
+}
+
+void StopIndex::popEmpty(Side& side) {
+    std::vector<uint32_t>& stack = side.groupStack;
+    while (!stack.empty() && groups[stack.back()].members.empty()) {
+        freeGroups.push_back(stack.back());
+        stack.pop_back();
+        side.emptyGroups--;
+    }
+}
+
+void StopIndex::compact(Side& side) {
+    // Keeps the order, so peaks stay descending
+    std::vector<uint32_t>& stack = side.groupStack;
+    size_t kept = 0;
+    for (uint32_t group : stack) {
+        if (groups[group].members.empty()) {
+            freeGroups.push_back(group);
+        } else {
+            stack[kept++] = group;
+        }
+    }
+    stack.resize(kept);
+    side.emptyGroups = 0;
+}
+
+void StopIndex::release(uint32_t index, std::vector<StopOrder>* triggered) {
+    Slot& slot = slots[index];
+    if (triggered) {
+        triggered->push_back(slot.stop);
+    }
+    
+    slotIndex.erase(slot.stop.order.orderId);
+    slot.live = false;
+    slot.group = NONE;
+    freeSlots.push_back(index);
+    liveCount--;
+}
+
+uint32_t StopIndex::allocateSlot() {
+    if (!freeSlots.empty()) {
+        uint32_t index = freeSlots.back();
+        freeSlots.pop_back();
+        return index;
+    }
+    
+    slots.push_back(Slot());
+    return static_cast<uint32_t>(slots.size() - 1);
+}
+
+uint32_t StopIndex::allocateGroup(Price peak) {
+    uint32_t index;
+    if (!freeGroups.empty()) {
+        index = freeGroups.back();
+        freeGroups.pop_back();
+    } else {
+        groups.push_back(TrailGroup());
+        index = static_cast<uint32_t>(groups.size() - 1);
+    }
+    
+    groups[index].peak = peak;
+    groups[index].listed = false;
+    return index;
+}
+
+bool StopIndex::contains(uint64_t orderId) const {
+    return slotIndex.find(orderId) != slotIndex.end();
+}
+
+Price StopIndex::getStopPrice(uint64_t orderId) const {
+    std::unordered_map<uint64_t, uint32_t>::const_iterator it = slotIndex.find(orderId);
+    if (it == slotIndex.end()) return 0;
+    
+    const Slot& slot = slots[it->second];
+    if (slot.group == NONE) return slot.stop.stopPrice;
+    
+    // Trailing stops move with their group's best price
+    OrderSide side = slot.stop.order.side;
+    return normalize(side, groups[slot.group].peak - slot.entry->first);
+}
+
+uint32_t StopIndex::getOwner(uint64_t orderId) const {
+    std::unordered_map<uint64_t, uint32_t>::const_iterator it = slotIndex.find(orderId);
+    return it == slotIndex.end() ? NONE : slots[it->second].stop.owner;
+}
+
+size_t StopIndex::getOwned(uint32_t owner, std::vector<StopOrder>& stops) const {
+    size_t found = 0;
+    for (const Slot& slot : slots) {
+        if (!slot.live || slot.stop.owner != owner) continue;
+        
+        stops.push_back(slot.stop);
+        stops.back().stopPrice = getStopPrice(slot.stop.order.orderId);
+        found++;
+    }
+    return found;
+}
+
+const char* StopIndex::typeName(StopType type) {
+    switch (type) {
+        case StopType::Stop: return "STOP";
+        case StopType::StopLimit: return "STOP LIMIT";
+        case StopType::TrailingStop: return "TRAILING";
+    }
+    return "UNKNOWN";
+}
+
+SymbolId StopIndex::getSymbol() const {
+    return symbol;
+}
+
+size_t StopIndex::getTrailGroupCount() const {
+    return buys.groupStack.size() + sells.groupStack.size();
+}
+
+size_t StopIndex::size() const {
+    return liveCount;
+}
+
+bool StopIndex::empty() const {
+    return liveCount == 0;
+}
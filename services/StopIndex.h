@@ -0,0 +1,122 @@
+#ifndef STOP_INDEX_H
+#define STOP_INDEX_H
+
+#include <map>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "../models/Order.h"
+#include "../utils/FixedPoint.h"
+
+// How a dormant stop becomes a live order
+enum class StopType : uint8_t {
+    Stop,         // Market order once the price reaches the stop
+    StopLimit,    // Limit order at the record's price once triggered
+    TrailingStop  // Stop that follows the best price by a fixed distance
+};
+
+// Dormant stop orders for a single symbol, indexed by trigger price so a
+// price update costs O(log n + triggered) however many stops are waiting.
+//
+// Both sides share one implementation: prices are normalized so a stop
+// fires when the normalized price falls to its stop (sell prices as is,
+// buy prices negated, the same trick the order book uses for bids).
+// Trailing stops that have seen the same best price share a group keyed
+// by that price, so a new high re-keys groups rather than every stop.
+class StopIndex {
+public:
+    static const uint32_t NONE = static_cast<uint32_t>(-1);
+    
+    struct StopOrder {
+        OrderRecord order;  // Side, quantity and id; price is the StopLimit limit
+        Price stopPrice;    // Trigger price; for trailing stops the current one
+        Price trailAmount;  // Distance behind the best price, trailing only
+        uint32_t owner;     // Book owner id of the account
+        StopType type;
+    };
+
+private:
+    // Stop keyed by negated normalized stop, so begin() fires first
+    typedef std::multimap<Price, uint32_t> TriggerMap;
+    
+    // Trailing stops that share a best price, ordered by trail distance
+    struct TrailGroup {
+        Price peak;                  // Best normalized price since placement
+        TriggerMap members;          // Trail amount -> slot
+        TriggerMap::iterator entry;  // Position in the side's thresholds
+        bool listed;                 // Whether `entry` is valid
+    };
+    
+    // Groups that empty leave the stack at once from the top, and
+    // otherwise in one pass once they make up half of it
+    struct Side {
+        TriggerMap stops;                // Fixed stops
+        TriggerMap thresholds;           // Negated group stop -> group
+        std::vector<uint32_t> groupStack; // Group ids, peaks descending
+        size_t emptyGroups;              // Groups on the stack with no members
+        
+        Side() : emptyGroups(0) {}
+    };
+    
+    struct Slot {
+        StopOrder stop;
+        TriggerMap::iterator entry; // In Side::stops or TrailGroup::members
+        uint32_t group;             // NONE for fixed stops
+        bool live;
+    };
+    
+    SymbolId symbol;
+    Side buys;
+    Side sells;
+    std::deque<TrailGroup> groups; // Deque keeps member iterators stable on growth
+    std::vector<uint32_t> freeGroups;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<uint64_t, uint32_t> slotIndex; // Order id -> slot
+    size_t liveCount;
+    
+    Side& sideOf(OrderSide side);
+    static Price normalize(OrderSide side, Price price);
+    
+    uint32_t allocateSlot();
+    uint32_t allocateGroup(Price peak);
+    void relist(Side& side, uint32_t group);
+    void retire(Side& side, uint32_t group); // After `group` lost members
+    void popEmpty(Side& side);
+    void compact(Side& side);
+    void raise(Side& side, Price price);
+    void trigger(Side& side, OrderSide orderSide, Price price, std::vector<StopOrder>& triggered);
+    void release(uint32_t index, std::vector<StopOrder>* triggered);
+
+public:
+    explicit StopIndex(SymbolId symbol = INVALID_SYMBOL);
+    
+    // Add a stop. `lastPrice` anchors trailing stops; fixed stops are
+    // expected to sit on the far side of it (the caller validates).
+    void add(const StopOrder& stop, Price lastPrice);
+    bool cancel(uint64_t orderId);
+    size_t cancelOwner(uint32_t owner);
+    
+    // Apply a new last price: trailing stops follow it, then every stop it
+    // reaches is removed and appended to `triggered` (sells, then buys).
+    size_t onPrice(Price price, std::vector<StopOrder>& triggered);
+    
+    bool contains(uint64_t orderId) const;
+    Price getStopPrice(uint64_t orderId) const; // 0 when unknown
+    uint32_t getOwner(uint64_t orderId) const;  // NONE when unknown
+    
+    // Append `owner`'s stops to `stops`, with trailing stops at their
+    // current trigger price; returns how many were found
+    size_t getOwned(uint32_t owner, std::vector<StopOrder>& stops) const;
+    
+    static const char* typeName(StopType type);
+    
+    SymbolId getSymbol() const;
+    size_t getTrailGroupCount() const; // Groups kept for trailing stops, both sides
+    size_t size() const;
+    bool empty() const;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
 
 // Base TradingStrategy implementation
 TradingStrategy::TradingStrategy(const std::string& name, const std::string& desc)
@@ -20,45 +21,69 @@ void TradingStrategy::displayInfo() const {
     std::cout << "Description: " << description << std::endl;
 }
 
+void TradingStrategy::generateSignals(
+    const MarketDataStore& market,
+    const PortfolioView& portfolio,
+    OrderPool& pool,
+    std::vector<OrderPtr>& signals) const {
+    
+    std::vector<StrategySignal> decisions;
+    evaluate(market, portfolio, 0, market.size(), decisions);
+    
+    for (const StrategySignal& signal : decisions) {
+        signals.push_back(pool.create(
+            signal.side, market.getSymbolId(signal.row), signal.quantity, signal.price));
+        describeSignal(market, signal);
+    }
+    
+    if (decisions.empty()) {
+        describeNoSignals();
+    }
+}
+
 // BuyBelowPriceStrategy implementation
 BuyBelowPriceStrategy::BuyBelowPriceStrategy(double threshold, int qty)
     : TradingStrategy("Buy Below Price", 
                      "Buy stocks when price falls below threshold"),
-      priceThreshold(threshold), quantity(qty) {}
+      priceThreshold(FixedPoint::toTicks(threshold)), quantity(qty) {}
 
-std::vector<std::unique_ptr<Order>> BuyBelowPriceStrategy::generateSignals(
-    const std::map<std::string, Stock>& stocks,
-    const Portfolio& /* portfolio */) {
+void BuyBelowPriceStrategy::evaluate(
+    const MarketDataStore& market,
+    const PortfolioView& /* portfolio */,
+    size_t beginRow,
+    size_t endRow,
+    std::vector<StrategySignal>& out) const {
     
-    std::vector<std::unique_ptr<Order>> signals;
+    const std::vector<Price>& prices = market.getLastPrices();
     
-    for (const auto& pair : stocks) {
-        const Stock& stock = pair.second;
-        
-        if (stock.getCurrentPrice() < priceThreshold) {
+    for (size_t row = beginRow; row < endRow; row++) {
+        if (prices[row] < priceThreshold) {
             // Generate buy signal
-            signals.push_back(std::unique_ptr<Order>(new BuyOrder(
-                stock.getSymbol(), quantity, stock.getCurrentPrice())));
-            
-            std::cout << "Signal: BUY " << stock.getSymbol() 
-                      << " (Price: $" << std::fixed << std::setprecision(2)
-                      << stock.getCurrentPrice() << " < Threshold: $" 
-                      << priceThreshold << ")" << std::endl;
+            StrategySignal signal = {row, OrderSide::Buy, quantity, prices[row],
+                                     FixedPoint::toDouble(prices[row]),
+                                     FixedPoint::toDouble(priceThreshold)};
+            out.push_back(signal);
         }
     }
-    
-    if (signals.empty()) {
-        std::cout << "No buy signals generated. No stocks below $" 
-                  << priceThreshold << std::endl;
-    }
-    
-    return signals;
+}
+
+void BuyBelowPriceStrategy::describeSignal(const MarketDataStore& market,
+                                           const StrategySignal& signal) const {
+    std::cout << "Signal: BUY " << market.getSymbol(signal.row) 
+              << " (Price: $" << std::fixed << std::setprecision(2)
+              << signal.indicator << " < Threshold: $" 
+              << signal.reference << ")" << std::endl;
+}
+
+void BuyBelowPriceStrategy::describeNoSignals() const {
+    std::cout << "No buy signals generated. No stocks below $" 
+              << FixedPoint::toDouble(priceThreshold) << std::endl;
 }
 
 void BuyBelowPriceStrategy::displayInfo() const {
     TradingStrategy::displayInfo();
     std::cout << "Price Threshold: $" << std::fixed << std::setprecision(2) 
-              << priceThreshold << std::endl;
+              << FixedPoint::toDouble(priceThreshold) << std::endl;
     std::cout << "Quantity per trade: " << quantity << std::endl;
 }
 
@@ -68,54 +93,48 @@ MovingAverageCrossoverStrategy::MovingAverageCrossoverStrategy(int shortMA, int
                      "Buy when short MA crosses above long MA, sell when below"),
       shortPeriod(shortMA), longPeriod(longMA), quantity(qty) {}
 
-std::vector<std::unique_ptr<Order>> MovingAverageCrossoverStrategy::generateSignals(
-    const std::map<std::string, Stock>& stocks,
-    const Portfolio& portfolio) {
+void MovingAverageCrossoverStrategy::evaluate(
+    const MarketDataStore& market,
+    const PortfolioView& portfolio,
+    size_t beginRow,
+    size_t endRow,
+    std::vector<StrategySignal>& out) const {
     
-    std::vector<std::unique_ptr<Order>> signals;
-    
-    for (const auto& pair : stocks) {
-        const Stock& stock = pair.second;
-        
+    for (size_t row = beginRow; row < endRow; row++) {
         // Need enough price history
-        if (stock.getPriceHistory().size() < static_cast<size_t>(longPeriod)) {
+        if (market.getPriceHistory(row).size() < static_cast<size_t>(longPeriod)) {
             continue;
         }
         
-        double shortMA = stock.getMovingAverage(shortPeriod);
-        double longMA = stock.getMovingAverage(longPeriod);
+        const Position* held = portfolio.getPosition(market.getSymbolId(row));
+        double shortMA = market.getMovingAverage(row, shortPeriod);
+        double longMA = market.getMovingAverage(row, longPeriod);
         
         // Buy signal: short MA > long MA and we don't own the stock
-        if (shortMA > longMA && portfolio.getPositions().find(stock.getSymbol()) == 
-            portfolio.getPositions().end()) {
-            
-            signals.push_back(std::unique_ptr<Order>(new BuyOrder(
-                stock.getSymbol(), quantity, stock.getCurrentPrice())));
-            
-            std::cout << "Signal: BUY " << stock.getSymbol() 
-                      << " (Short MA: $" << std::fixed << std::setprecision(2) << shortMA
-                      << " > Long MA: $" << longMA << ")" << std::endl;
+        if (shortMA > longMA && !held) {
+            StrategySignal signal = {row, OrderSide::Buy, quantity, market.getLastPrice(row),
+                                     shortMA, longMA};
+            out.push_back(signal);
         }
         // Sell signal: short MA < long MA and we own the stock
-        else if (shortMA < longMA && portfolio.getPositions().find(stock.getSymbol()) != 
-                 portfolio.getPositions().end()) {
-            
-            const Position& pos = portfolio.getPositions().at(stock.getSymbol());
-            
-            signals.push_back(std::unique_ptr<Order>(new SellOrder(
-                stock.getSymbol(), pos.quantity, stock.getCurrentPrice())));
-            
-            std::cout << "Signal: SELL " << stock.getSymbol() 
-                      << " (Short MA: $" << std::fixed << std::setprecision(2) << shortMA
-                      << " < Long MA: $" << longMA << ")" << std::endl;
+        else if (shortMA < longMA && held) {
+            StrategySignal signal = {row, OrderSide::Sell, held->quantity, market.getLastPrice(row),
+                                     shortMA, longMA};
+            out.push_back(signal);
         }
     }
-    
-    if (signals.empty()) {
-        std::cout << "No MA crossover signals generated." << std::endl;
-    }
-    
-    return signals;
+}
+
+void MovingAverageCrossoverStrategy::describeSignal(const MarketDataStore& market,
+                                                    const StrategySignal& signal) const {
+    bool buy = (signal.side == OrderSide::Buy);
+    std::cout << "Signal: " << (buy ? "BUY " : "SELL ") << market.getSymbol(signal.row) 
+              << " (Short MA: $" << std::fixed << std::setprecision(2) << signal.indicator
+              << (buy ? " > " : " < ") << "Long MA: $" << signal.reference << ")" << std::endl;
+}
+
+void MovingAverageCrossoverStrategy::describeNoSignals() const {
+    std::cout << "No MA crossover signals generated." << std::endl;
 }
 
 void MovingAverageCrossoverStrategy::displayInfo() const {
@@ -131,59 +150,50 @@ MeanReversionStrategy::MeanReversionStrategy(int period, double threshold, int q
                      "Buy when price deviates below mean, sell when above"),
       period(period), deviationThreshold(threshold), quantity(qty) {}
 
-std::vector<std::unique_ptr<Order>> MeanReversionStrategy::generateSignals(
-    const std::map<std::string, Stock>& stocks,
-    const Portfolio& portfolio) {
-    
-    std::vector<std::unique_ptr<Order>> signals;
+void MeanReversionStrategy::evaluate(
+    const MarketDataStore& market,
+    const PortfolioView& portfolio,
+    size_t beginRow,
+    size_t endRow,
+    std::vector<StrategySignal>& out) const {
     
-    for (const auto& pair : stocks) {
-        const Stock& stock = pair.second;
-        
+    for (size_t row = beginRow; row < endRow; row++) {
         // Need enough price history
-        if (stock.getPriceHistory().size() < static_cast<size_t>(period)) {
+        if (market.getPriceHistory(row).size() < static_cast<size_t>(period)) {
             continue;
         }
         
-        double mean = stock.getMovingAverage(period);
-        double currentPrice = stock.getCurrentPrice();
-        double deviation = (currentPrice - mean) / mean;
+        const Position* held = portfolio.getPosition(market.getSymbolId(row));
+        double mean = market.getMovingAverage(row, period);
+        Price currentPrice = market.getLastPrice(row);
+        double deviation = (FixedPoint::toDouble(currentPrice) - mean) / mean;
         
         // Buy signal: price significantly below mean
-        if (deviation < -deviationThreshold && 
-            portfolio.getPositions().find(stock.getSymbol()) == 
-            portfolio.getPositions().end()) {
-            
-            signals.push_back(std::unique_ptr<Order>(new BuyOrder(
-                stock.getSymbol(), quantity, currentPrice)));
-            
-            std::cout << "Signal: BUY " << stock.getSymbol() 
-                      << " (Price: $" << std::fixed << std::setprecision(2) << currentPrice
-                      << " is " << (deviation * 100) << "% below mean: $" 
-                      << mean << ")" << std::endl;
+        if (deviation < -deviationThreshold && !held) {
+            StrategySignal signal = {row, OrderSide::Buy, quantity, currentPrice, deviation, mean};
+            out.push_back(signal);
         }
         // Sell signal: price significantly above mean
-        else if (deviation > deviationThreshold && 
-                 portfolio.getPositions().find(stock.getSymbol()) != 
-                 portfolio.getPositions().end()) {
-            
-            const Position& pos = portfolio.getPositions().at(stock.getSymbol());
-            
-            signals.push_back(std::unique_ptr<Order>(new SellOrder(
-                stock.getSymbol(), pos.quantity, currentPrice)));
-            
-            std::cout << "Signal: SELL " << stock.getSymbol() 
-                      << " (Price: $" << std::fixed << std::setprecision(2) << currentPrice
-                      << " is " << (deviation * 100) << "% above mean: $" 
-                      << mean << ")" << std::endl;
+        else if (deviation > deviationThreshold && held) {
+            StrategySignal signal = {row, OrderSide::Sell, held->quantity, currentPrice,
+                                     deviation, mean};
+            out.push_back(signal);
         }
     }
-    
-    if (signals.empty()) {
-        std::cout << "No mean reversion signals generated." << std::endl;
-    }
-    
-    return signals;
+}
+
+void MeanReversionStrategy::describeSignal(const MarketDataStore& market,
+                                           const StrategySignal& signal) const {
+    bool buy = (signal.side == OrderSide::Buy);
+    std::cout << "Signal: " << (buy ? "BUY " : "SELL ") << market.getSymbol(signal.row) 
+              << " (Price: $" << std::fixed << std::setprecision(2) 
+              << FixedPoint::toDouble(signal.price)
+              << " is " << (signal.indicator * 100) << (buy ? "% below" : "% above")
+              << " mean: $" << signal.reference << ")" << std::endl;
+}
+
+void MeanReversionStrategy::describeNoSignals() const {
+    std::cout << "No mean reversion signals generated." << std::endl;
 }
 
 void MeanReversionStrategy::displayInfo() const {
@@ -194,7 +204,9 @@ void MeanReversionStrategy::displayInfo() const {
 }
 
 // StrategyEngine implementation
-StrategyEngine::StrategyEngine() {
+const size_t StrategyEngine::ROWS_PER_TASK;
+
+StrategyEngine::StrategyEngine(size_t threads) : workers(threads) {
     // Initialize with default strategies
     strategies.push_back(std::unique_ptr<TradingStrategy>(new BuyBelowPriceStrategy(200.0, 5)));
     strategies.push_back(std::unique_ptr<TradingStrategy>(new MovingAverageCrossoverStrategy(5, 20, 10)));
@@ -209,20 +221,66 @@ const std::vector<std::unique_ptr<TradingStrategy>>& StrategyEngine::getStrategi
     return strategies;
 }
 
-std::vector<std::unique_ptr<Order>> StrategyEngine::runStrategy(
+size_t StrategyEngine::runStrategy(
     int strategyIndex,
-    const std::map<std::string, Stock>& stocks,
-    const Portfolio& portfolio) {
+    const MarketDataStore& market,
+    const PortfolioView& portfolio,
+    std::vector<OrderPtr>& signals) {
+    
+    signals.clear();
     
     if (strategyIndex < 0 || static_cast<size_t>(strategyIndex) >= strategies.size()) {
         std::cout << "Invalid strategy index." << std::endl;
-        return std::vector<std::unique_ptr<Order>>();
+        return 0;
     }
     
     std::cout << "\n=== Running Strategy: " 
               << strategies[strategyIndex]->getStrategyName() << " ===" << std::endl;
     
-    return strategies[strategyIndex]->generateSignals(stocks, portfolio);
+    strategies[strategyIndex]->generateSignals(market, portfolio, orderPool, signals);
+    return signals.size();
+}
+
+size_t StrategyEngine::runAllStrategies(
+    const MarketDataStore& market,
+    const PortfolioView& portfolio,
+    std::vector<OrderPtr>& signals) {
+    
+    signals.clear();
+    
+    // Task t covers strategy t / partitions, rows of partition t % partitions
+    size_t rows = market.size();
+    size_t partitions = std::max<size_t>(1, (rows + ROWS_PER_TASK - 1) / ROWS_PER_TASK);
+    size_t taskCount = strategies.size() * partitions;
+    if (taskSignals.size() < taskCount) {
+        taskSignals.resize(taskCount);
+    }
+    
+    workers.run(taskCount, [&](size_t task, size_t /* worker */) {
+        size_t begin = (task % partitions) * ROWS_PER_TASK;
+        size_t end = std::min(rows, begin + ROWS_PER_TASK);
+        taskSignals[task].clear();
+        strategies[task / partitions]->evaluate(market, portfolio, begin, end, taskSignals[task]);
+    });
+    
+    // Merge in task order; orders come from the pool on this thread only
+    std::cout << "\n=== Running All Strategies ===" << std::endl;
+    for (size_t s = 0; s < strategies.size(); s++) {
+        size_t before = signals.size();
+        for (size_t task = s * partitions; task < (s + 1) * partitions; task++) {
+            for (const StrategySignal& signal : taskSignals[task]) {
+                signals.push_back(orderPool.create(
+                    signal.side, market.getSymbolId(signal.row), signal.quantity, signal.price));
+            }
+        }
+        std::cout << strategies[s]->getStrategyName() << ": "
+                  << (signals.size() - before) << " signals" << std::endl;
+    }
+    return signals.size();
+}
+
+size_t StrategyEngine::getThreadCount() const {
+    return workers.getThreadCount();
 }
 
 void StrategyEngine::displayStrategies() const {
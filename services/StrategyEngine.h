@@ -5,8 +5,21 @@
 #include <vector>
 #include <memory>
 #include "../models/Stock.h"
-#include "../models/Portfolio.h"
+#include "../models/PortfolioView.h"
 #include "../models/Order.h"
+#include "../models/OrderPool.h"
+#include "../utils/WorkStealingPool.h"
+#include "MarketDataStore.h"
+
+// One strategy decision, before it becomes an order
+struct StrategySignal {
+    size_t row;
+    OrderSide side;
+    int quantity;
+    Price price;
+    double indicator; // The value the rule tested, e.g. the short MA
+    double reference; // What it was tested against, e.g. the long MA
+};
 
 // Abstract Strategy class demonstrating Abstraction and Polymorphism
 class TradingStrategy {
@@ -18,10 +31,28 @@ public:
     TradingStrategy(const std::string& name, const std::string& desc);
     virtual ~TradingStrategy() = default;
     
-    // Pure virtual function - must be implemented by derived classes
-    virtual std::vector<std::unique_ptr<Order>> generateSignals(
-        const std::map<std::string, Stock>& stocks,
-        const Portfolio& portfolio) = 0;
+    // Pure virtual functions - must be implemented by derived classes.
+    // evaluate() decides on rows [beginRow, endRow), appending to `out` in
+    // row order. It only reads, so disjoint ranges may be evaluated on
+    // different threads at once.
+    virtual void evaluate(
+        const MarketDataStore& market,
+        const PortfolioView& portfolio,
+        size_t beginRow,
+        size_t endRow,
+        std::vector<StrategySignal>& out) const = 0;
+    
+    // Console explanation of a signal, and of finding none
+    virtual void describeSignal(const MarketDataStore& market, const StrategySignal& signal) const = 0;
+    virtual void describeNoSignals() const = 0;
+    
+    // Evaluate every row; orders are drawn from `pool`, appended to
+    // `signals` and described on the console
+    void generateSignals(
+        const MarketDataStore& market,
+        const PortfolioView& portfolio,
+        OrderPool& pool,
+        std::vector<OrderPtr>& signals) const;
     
     // Getters
     std::string getStrategyName() const;
@@ -34,15 +65,20 @@ public:
 // Concrete strategy: Buy when price is below a threshold
 class BuyBelowPriceStrategy : public TradingStrategy {
 private:
-    double priceThreshold;
+    Price priceThreshold;
     int quantity;
 
 public:
     BuyBelowPriceStrategy(double threshold, int qty = 10);
     
-    std::vector<std::unique_ptr<Order>> generateSignals(
-        const std::map<std::string, Stock>& stocks,
-        const Portfolio& portfolio) override;
+    void evaluate(
+        const MarketDataStore& market,
+        const PortfolioView& portfolio,
+        size_t beginRow,
+        size_t endRow,
+        std::vector<StrategySignal>& out) const override;
+    void describeSignal(const MarketDataStore& market, const StrategySignal& signal) const override;
+    void describeNoSignals() const override;
     
     void displayInfo() const override;
 };
@@ -57,9 +93,14 @@ private:
 public:
     MovingAverageCrossoverStrategy(int shortMA = 5, int longMA = 20, int qty = 10);
     
-    std::vector<std::unique_ptr<Order>> generateSignals(
-        const std::map<std::string, Stock>& stocks,
-        const Portfolio& portfolio) override;
+    void evaluate(
+        const MarketDataStore& market,
+        const PortfolioView& portfolio,
+        size_t beginRow,
+        size_t endRow,
+        std::vector<StrategySignal>& out) const override;
+    void describeSignal(const MarketDataStore& market, const StrategySignal& signal) const override;
+    void describeNoSignals() const override;
     
     void displayInfo() const override;
 };
@@ -74,30 +115,57 @@ private:
 public:
     MeanReversionStrategy(int period = 20, double threshold = 0.05, int qty = 10);
     
-    std::vector<std::unique_ptr<Order>> generateSignals(
-        const std::map<std::string, Stock>& stocks,
-        const Portfolio& portfolio) override;
+    void evaluate(
+        const MarketDataStore& market,
+        const PortfolioView& portfolio,
+        size_t beginRow,
+        size_t endRow,
+        std::vector<StrategySignal>& out) const override;
+    void describeSignal(const MarketDataStore& market, const StrategySignal& signal) const override;
+    void describeNoSignals() const override;
     
     void displayInfo() const override;
 };
 
 // Strategy Engine manages and executes strategies
 class StrategyEngine {
+public:
+    static const size_t ROWS_PER_TASK = 512;
+
 private:
     std::vector<std::unique_ptr<TradingStrategy>> strategies;
+    OrderPool orderPool; // Slots for generated signals, recycled between runs
+    WorkStealingPool workers;
+    std::vector<std::vector<StrategySignal>> taskSignals; // Per task, reused between runs
 
 public:
-    StrategyEngine();
+    // `threads` 0 evaluates on one worker per hardware thread
+    explicit StrategyEngine(size_t threads = 0);
     
     // Strategy management
     void addStrategy(std::unique_ptr<TradingStrategy> strategy);
     const std::vector<std::unique_ptr<TradingStrategy>>& getStrategies() const;
     
-    // Execute a strategy
-    std::vector<std::unique_ptr<Order>> runStrategy(
+    // Execute a strategy; `signals` is cleared and refilled.
+    // Returns the number of signals generated.
+    size_t runStrategy(
         int strategyIndex,
-        const std::map<std::string, Stock>& stocks,
-        const Portfolio& portfolio);
+        const MarketDataStore& market,
+        const PortfolioView& portfolio,
+        std::vector<OrderPtr>& signals);
+    
+    // Evaluate every strategy over the whole market at once. Each strategy's
+    // rows are split into tasks of ROWS_PER_TASK, run on the work-stealing
+    // pool; signals are merged in strategy order, then row order, so the
+    // result does not depend on the thread count. `signals` is cleared and
+    // refilled, and only a count per strategy is printed. Returns the
+    // number of signals generated.
+    size_t runAllStrategies(
+        const MarketDataStore& market,
+        const PortfolioView& portfolio,
+        std::vector<OrderPtr>& signals);
+    
+    size_t getThreadCount() const;
     
     // Display available strategies
     void displayStrategies() const;
@@ -3,110 +3,944 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
+
+const size_t TradingEngine::DISPLAY_DEPTH;
+
+namespace {
+    
+    // Passes a fill only when the taker can pay for it, or deliver it, after
+    // the fills before it in the same match, and the maker's order is still
+    // backed by what it reserved
+    class SettlementGate : public FillGate {
+    private:
+        const std::vector<Portfolio*>& accounts;
+        Money cash;  // Taker's cash not yet committed to earlier fills
+        int shares;  // Taker's shares not yet committed to earlier fills
+    
+    public:
+        SettlementGate(const std::vector<Portfolio*>& accounts, const Portfolio& taker,
+                       SymbolId symbol)
+            : accounts(accounts), cash(taker.getAvailableCash()),
+              shares(taker.getAvailableShares(symbol)) {}
+        
+        int32_t allowFill(SymbolId symbol, OrderSide takerSide, uint32_t makerOwner, Price price,
+                          int32_t quantity) override {
+            const Portfolio* maker = makerOwner < accounts.size() ? accounts[makerOwner] : nullptr;
+            if (!maker) return 0;
+            
+            int32_t allowed = quantity;
+            if (takerSide == OrderSide::Buy) {
+                const Position* held = maker->getPosition(symbol);
+                if (!held || held->reserved < quantity) return 0;
+                Money affordable = std::max<Money>(cash, 0);
+                if (price > 0) {
+                    allowed = static_cast<int32_t>(std::min<Money>(quantity, affordable / price));
+                }
+                cash -= FixedPoint::notional(price, allowed);
+            } else {
+                if (maker->getReservedCash() < FixedPoint::notional(price, quantity)) return 0;
+                allowed = std::min(quantity, std::max(shares, 0));
+                shares -= allowed;
+            }
+            return allowed;
+        }
+    };
+    
+}
 
 TradingEngine::TradingEngine() {
+    market.setPriceListener(this);
+    
     // Initialize with some default stocks
-    addStock(Stock("AAPL", "Apple Inc.", 150.50));
-    addStock(Stock("GOOGL", "Alphabet Inc.", 2800.75));
-    addStock(Stock("MSFT", "Microsoft Corp.", 310.25));
-    addStock(Stock("TSLA", "Tesla Inc.", 245.80));
-    addStock(Stock("AMZN", "Amazon.com Inc.", 135.40));
+    addStock(Stock("AAPL", "Apple Inc.", FixedPoint::toTicks(150.50)));
+    addStock(Stock("GOOGL", "Alphabet Inc.", FixedPoint::toTicks(2800.75)));
+    addStock(Stock("MSFT", "Microsoft Corp.", FixedPoint::toTicks(310.25)));
+    addStock(Stock("TSLA", "Tesla Inc.", FixedPoint::toTicks(245.80)));
+    addStock(Stock("AMZN", "Amazon.com Inc.", FixedPoint::toTicks(135.40)));
 }
 
 void TradingEngine::addStock(const Stock& stock) {
-    stocks[stock.getSymbol()] = stock;
+    market.addSymbol(stock);
     std::cout << Colors::SUCCESS << Symbols::CHECK << " Stock " << stock.getSymbol() << " added successfully." << Colors::RESET << std::endl;
 }
 
-bool TradingEngine::removeStock(const std::string& symbol) {
-    auto it = stocks.find(symbol);
-    if (it != stocks.end()) {
-        stocks.erase(it);
-        std::cout << Colors::WARNING << Symbols::CHECK << " Stock " << symbol << " removed successfully." << Colors::RESET << std::endl;
+bool TradingEngine::removeStock(SymbolId symbol) {
+    const std::string& ticker = SymbolTable::instance().name(symbol);
+    
+    if (market.removeSymbol(symbol)) {
+        // Resting orders on a delisted symbol are dropped with its book,
+        // releasing what they reserved
+        if (symbol < books.size() && books[symbol]) {
+            for (size_t owner = 0; owner < accounts.size(); owner++) {
+                if (accounts[owner]) books[symbol]->cancelOwner(static_cast<uint32_t>(owner));
+            }
+            books[symbol].reset();
+        }
+        if (symbol < stopBooks.size()) {
+            stopBooks[symbol].reset();
+        }
+        std::cout << Colors::WARNING << Symbols::CHECK << " Stock " << ticker << " removed successfully." << Colors::RESET << std::endl;
         return true;
     }
-    std::cout << Colors::ERROR << Symbols::CROSS << " Stock " << symbol << " not found." << Colors::RESET << std::endl;
+    std::cout << Colors::ERROR << Symbols::CROSS << " Stock " << ticker << " not found." << Colors::RESET << std::endl;
     return false;
 }
 
-Stock* TradingEngine::getStock(const std::string& symbol) {
-    auto it = stocks.find(symbol);
-    if (it != stocks.end()) {
-        return &(it->second);
-    }
-    return nullptr;
+bool TradingEngine::getStock(SymbolId symbol, Stock& stock) const {
+    size_t row = market.findRow(symbol);
+    if (row == MarketDataStore::npos) return false;
+    
+    stock = market.toStock(row);
+    return true;
 }
 
-const std::map<std::string, Stock>& TradingEngine::getAllStocks() const {
+std::map<std::string, Stock> TradingEngine::getAllStocks() const {
+    std::map<std::string, Stock> stocks;
+    for (size_t row = 0; row < market.size(); row++) {
+        stocks.insert(std::make_pair(market.getSymbol(row), market.toStock(row)));
+    }
     return stocks;
 }
 
-bool TradingEngine::stockExists(const std::string& symbol) const {
-    return stocks.find(symbol) != stocks.end();
+bool TradingEngine::stockExists(SymbolId symbol) const {
+    return market.findRow(symbol) != MarketDataStore::npos;
 }
 
-bool TradingEngine::executeOrder(Order* order, Portfolio& portfolio) {
-    // Polymorphic behavior - determine order type at runtime
-    if (BuyOrder* buyOrder = dynamic_cast<BuyOrder*>(order)) {
-        return executeBuyOrder(buyOrder, portfolio);
-    } else if (SellOrder* sellOrder = dynamic_cast<SellOrder*>(order)) {
-        return executeSellOrder(sellOrder, portfolio);
-    }
-    return false;
+bool TradingEngine::updateStockPrice(SymbolId symbol, Price price) {
+    size_t row = market.findRow(symbol);
+    if (row == MarketDataStore::npos) return false;
+    
+    market.updatePrice(row, price);
+    return true;
 }
 
-bool TradingEngine::executeBuyOrder(BuyOrder* order, Portfolio& portfolio) {
-    if (!stockExists(order->getSymbol())) {
+MarketDataStore& TradingEngine::getMarket() {
+    return market;
+}
+
+const MarketDataStore& TradingEngine::getMarket() const {
+    return market;
+}
+
+bool TradingEngine::executeOrder(Order* order, Portfolio& portfolio) {
+    if (!order) return false;
+    
+    SymbolId symbol = order->getSymbolId();
+    size_t row = market.findRow(symbol);
+    if (row == MarketDataStore::npos) {
         std::cout << "Stock " << order->getSymbol() << " does not exist." << std::endl;
-        order->setStatus("CANCELLED");
+        order->setStatus(OrderStatus::Cancelled);
+        return false;
+    }
+    
+    // The order price is its limit; a buy never pays more than it
+    bool accepted = order->isBuy() ? portfolio.canBuy(order->getQuantity(), order->getPrice())
+                                   : portfolio.canSell(symbol, order->getQuantity());
+    if (!accepted) {
+        reportShortfall(*order, portfolio);
+        order->setStatus(OrderStatus::Cancelled);
         return false;
     }
     
-    Stock* stock = getStock(order->getSymbol());
-    double currentPrice = stock->getCurrentPrice();
+    RiskCheck risk = riskGate.check(attachAccount(portfolio), order->getSide(), symbol,
+                                    order->getQuantity(), order->getPrice(), market.getLastPrice(row));
+    if (risk != RiskCheck::Passed) {
+        std::cout << Colors::ERROR << Symbols::CROSS << " Order rejected by risk check: "
+                  << RiskGate::checkName(risk) << Colors::RESET << std::endl;
+        order->setStatus(OrderStatus::Cancelled);
+        return false;
+    }
     
-    // Execute at current market price
-    bool success = portfolio.buyStock(order->getSymbol(), order->getQuantity(), currentPrice);
+    ExecutionResult result;
+    fillOrder(*order, row, portfolio, result);
     
-    if (success) {
-        order->setStatus("EXECUTED");
-        std::cout << Colors::SUCCESS << Symbols::CHECK << " Buy order executed: " << order->getQuantity() << " shares of " 
-                  << order->getSymbol() << " at " << Colors::BOLD_WHITE << "$" << std::fixed << std::setprecision(2) 
-                  << currentPrice << Colors::RESET << std::endl;
+    if (result.filledQuantity > 0) {
+        std::cout << Colors::SUCCESS << Symbols::CHECK << (order->isBuy() ? " Buy" : " Sell") 
+                  << " order executed: " << result.filledQuantity << " shares of " 
+                  << order->getSymbol() << " at " << Colors::BOLD_WHITE << "$" << std::fixed 
+                  << std::setprecision(2) << FixedPoint::toDouble(result.averagePrice) 
+                  << Colors::RESET << std::endl;
+    }
+    
+    if (result.error != ExecutionError::None) {
+        std::cout << Colors::ERROR << Symbols::CROSS << " "
+                  << order->getQuantity() - result.filledQuantity << " shares of "
+                  << order->getSymbol() << " could not be filled: "
+                  << executionErrorName(result.error) << Colors::RESET << std::endl;
+    }
+    
+    if (result.restingQuantity > 0) {
+        std::cout << Colors::INFO << "Order resting in book: " << result.restingQuantity 
+                  << " shares of " << order->getSymbol() << " at $" << std::fixed 
+                  << std::setprecision(2) << FixedPoint::toDouble(order->getPrice()) 
+                  << Colors::RESET << std::endl;
         return true;
-    } else {
-        order->setStatus("CANCELLED");
+    }
+    
+    return result.filledQuantity > 0;
+}
+
+void TradingEngine::reportShortfall(const Order& order, const Portfolio& portfolio) {
+    if (order.isBuy()) {
+        std::cout << "Insufficient funds. Required: $" << std::fixed << std::setprecision(2)
+                  << FixedPoint::toDouble(order.getTotalValue()) << ", Available: $"
+                  << FixedPoint::toDouble(portfolio.getAvailableCash()) << std::endl;
+        return;
+    }
+    
+    const Position* pos = portfolio.getPosition(order.getSymbolId());
+    if (!pos) {
+        std::cout << "You don't own any shares of " << order.getSymbol() << std::endl;
+        return;
+    }
+    std::cout << "Insufficient shares. You own " << pos->quantity << " shares of "
+              << order.getSymbol();
+    if (pos->reserved > 0) {
+        std::cout << " (" << pos->reserved << " committed to resting orders)";
+    }
+    std::cout << std::endl;
+}
+
+size_t TradingEngine::executeBatch(const std::vector<OrderPtr>& orders, Portfolio& portfolio,
+                                   std::vector<ExecutionResult>& results) {
+    results.resize(orders.size());
+    
+    // Validation pass: cash and shares are committed as orders are accepted,
+    // so later orders in the batch see what earlier ones reserved
+    Money cash = portfolio.getAvailableCash();
+    uint32_t owner = attachAccount(portfolio);
+    
+    for (size_t i = 0; i < orders.size(); i++) {
+        Order& order = *orders[i];
+        ExecutionResult& result = results[i];
+        SymbolId symbol = order.getSymbolId();
+        size_t row = market.findRow(symbol);
+        
+        result = ExecutionResult();
+        result.orderId = order.getId();
+        result.symbolId = symbol;
+        result.side = order.getSide();
+        
+        RiskCheck risk = RiskCheck::Passed;
+        if (row != MarketDataStore::npos) {
+            risk = riskGate.check(owner, order.getSide(), symbol, order.getQuantity(),
+                                  order.getPrice(), market.getLastPrice(row));
+        }
+        
+        if (row == MarketDataStore::npos) {
+            result.error = ExecutionError::UnknownSymbol;
+        } else if (risk != RiskCheck::Passed) {
+            result.error = riskError(risk);
+        } else if (order.isBuy()) {
+            Money cost = order.getTotalValue();
+            if (cost > cash) {
+                result.error = ExecutionError::InsufficientFunds;
+            } else {
+                cash -= cost;
+            }
+        } else {
+            if (symbol >= batchShares.size()) {
+                batchShares.resize(symbol + 1, 0);
+            }
+            int available = portfolio.getAvailableShares(symbol) - batchShares[symbol];
+            if (order.getQuantity() > available) {
+                result.error = ExecutionError::InsufficientShares;
+            } else {
+                batchShares[symbol] += order.getQuantity();
+            }
+        }
+        
+        if (result.error != ExecutionError::None) {
+            order.setStatus(OrderStatus::Cancelled);
+            result.status = OrderStatus::Cancelled;
+        } else {
+            riskGate.reserve(owner, order.getSide(), symbol, order.getQuantity(), order.getPrice());
+        }
+    }
+    
+    // Release the share and risk reservations for the next batch
+    riskGate.releaseReservations();
+    for (size_t i = 0; i < orders.size(); i++) {
+        SymbolId symbol = orders[i]->getSymbolId();
+        if (symbol < batchShares.size()) batchShares[symbol] = 0;
+    }
+    
+    // Fill pass
+    size_t executed = 0;
+    for (size_t i = 0; i < orders.size(); i++) {
+        Order& order = *orders[i];
+        if (results[i].error != ExecutionError::None) continue;
+        
+        fillOrder(order, market.findRow(order.getSymbolId()), portfolio, results[i]);
+        if (results[i].filledQuantity > 0) executed++;
+    }
+    
+    return executed;
+}
+
+size_t TradingEngine::previewBatch(const std::vector<OrderPtr>& orders, PortfolioOverlay& overlay,
+                                   std::vector<ExecutionResult>& results) const {
+    results.resize(orders.size());
+    
+    // Validation pass, as in executeBatch: buys commit their notional and
+    // sells their shares against what the overlay holds before the batch
+    Money cash = overlay.getAvailableCash();
+    std::vector<int> committed; // SymbolId -> shares committed to sells
+    
+    for (size_t i = 0; i < orders.size(); i++) {
+        const Order& order = *orders[i];
+        ExecutionResult& result = results[i];
+        SymbolId symbol = order.getSymbolId();
+        
+        result = ExecutionResult();
+        result.orderId = order.getId();
+        result.symbolId = symbol;
+        result.side = order.getSide();
+        
+        if (market.findRow(symbol) == MarketDataStore::npos) {
+            result.error = ExecutionError::UnknownSymbol;
+        } else if (order.isBuy()) {
+            Money cost = order.getTotalValue();
+            if (cost > cash) {
+                result.error = ExecutionError::InsufficientFunds;
+            } else {
+                cash -= cost;
+            }
+        } else {
+            if (symbol >= committed.size()) {
+                committed.resize(symbol + 1, 0);
+            }
+            const Position* held = overlay.getPosition(symbol);
+            int available = held ? held->quantity - held->reserved - committed[symbol] : 0;
+            if (order.getQuantity() > available) {
+                result.error = ExecutionError::InsufficientShares;
+            } else {
+                committed[symbol] += order.getQuantity();
+            }
+        }
+        
+        result.status = result.error == ExecutionError::None ? OrderStatus::Pending
+                                                              : OrderStatus::Cancelled;
+    }
+    
+    // Fill pass: marketable orders fill at the last price, others rest
+    size_t filled = 0;
+    for (size_t i = 0; i < orders.size(); i++) {
+        const Order& order = *orders[i];
+        ExecutionResult& result = results[i];
+        if (result.error != ExecutionError::None) continue;
+        
+        SymbolId symbol = order.getSymbolId();
+        Price last = market.getLastPrice(market.findRow(symbol));
+        bool marketable = order.isBuy() ? last <= order.getPrice() : last >= order.getPrice();
+        if (!marketable) {
+            result.restingQuantity = order.getQuantity();
+            continue;
+        }
+        
+        bool applied = order.isBuy() ? overlay.buyStock(symbol, order.getQuantity(), last)
+                                     : overlay.sellStock(symbol, order.getQuantity(), last);
+        if (applied) {
+            result.filledQuantity = order.getQuantity();
+            result.averagePrice = last;
+            result.status = OrderStatus::Executed;
+            filled++;
+        }
+    }
+    
+    return filled;
+}
+
+void TradingEngine::fillOrder(Order& order, size_t row, Portfolio& portfolio,
+                              ExecutionResult& result) {
+    OrderSide side = order.getSide();
+    SymbolId symbol = order.getSymbolId();
+    bool isBuy = (side == OrderSide::Buy);
+    Price currentPrice = market.getLastPrice(row);
+    
+    Price limit = order.getPrice();
+    bool marketable = isBuy ? currentPrice <= limit : currentPrice >= limit;
+    uint32_t owner = attachAccount(portfolio);
+    
+    // Match against resting orders first; rest only if the market is away.
+    // Both legs of each fill are checked before the book takes it from the
+    // maker, and the book has released the maker's reservation for every
+    // fill it returns, so each one settles.
+    fillBuffer.clear();
+    SettlementGate gate(accounts, portfolio, symbol);
+    int remaining = getBook(symbol).submit(order.getId(), side, limit, order.getQuantity(),
+                                           owner, !marketable, fillBuffer, &gate);
+    
+    int filledQuantity = 0;
+    Money filledValue = 0;
+    
+    for (const OrderBook::Fill& fill : fillBuffer) {
+        Portfolio* maker = accounts[fill.makerOwner];
+        Money value = FixedPoint::notional(fill.price, fill.quantity);
+        Portfolio* buyer = isBuy ? &portfolio : maker;
+        Portfolio* seller = isBuy ? maker : &portfolio;
+        
+        buyer->buyStock(symbol, fill.quantity, fill.price);
+        seller->sellStock(symbol, fill.quantity, fill.price);
+        
+        riskGate.onFill(owner, side, symbol, fill.quantity, fill.price);
+        riskGate.onFill(fill.makerOwner, isBuy ? OrderSide::Sell : OrderSide::Buy, symbol,
+                        fill.quantity, fill.price);
+        syncMark(fill.makerOwner, symbol, currentPrice);
+        
+        filledQuantity += fill.quantity;
+        filledValue += value;
+    }
+    
+    // Whatever the book could not fill executes against the market price
+    if (remaining > 0 && marketable) {
+        bool success = isBuy ? portfolio.buyStock(symbol, remaining, currentPrice)
+                             : portfolio.sellStock(symbol, remaining, currentPrice);
+        if (success) {
+            riskGate.onFill(owner, side, symbol, remaining, currentPrice);
+            filledQuantity += remaining;
+            filledValue += FixedPoint::notional(currentPrice, remaining);
+            remaining = 0;
+        }
+    }
+    
+    if (filledQuantity > 0) {
+        syncMark(owner, symbol, currentPrice);
+    }
+    
+    // A resting remainder sets aside what it would need to settle
+    if (!marketable && remaining > 0) {
+        if (isBuy) {
+            portfolio.reserveCash(FixedPoint::notional(limit, remaining));
+        } else {
+            portfolio.reserveShares(symbol, remaining);
+        }
+    }
+    order.addFill(filledQuantity);
+    
+    result.orderId = order.getId();
+    result.symbolId = symbol;
+    result.side = side;
+    result.filledQuantity = filledQuantity;
+    result.averagePrice = FixedPoint::divide(filledValue, filledQuantity);
+    result.restingQuantity = marketable ? 0 : remaining;
+    result.error = ExecutionError::None;
+    
+    // A marketable order that could not be paid for or delivered in full
+    // is cancelled with what did fill
+    if (remaining == 0) {
+        order.setStatus(OrderStatus::Executed);
+    } else if (marketable) {
+        order.setStatus(OrderStatus::Cancelled);
+        result.error = isBuy ? ExecutionError::InsufficientFunds : ExecutionError::InsufficientShares;
+    }
+    result.status = order.getStatus();
+}
+
+void TradingEngine::displayExecutionResults(const std::vector<ExecutionResult>& results) {
+    size_t filled = 0;
+    size_t resting = 0;
+    size_t rejected = 0;
+    
+    std::cout << std::left << std::setw(6) << "Side" << std::setw(8) << "Symbol"
+              << std::right << std::setw(8) << "Filled" << std::setw(12) << "Avg Price"
+              << "  " << std::left << "Result" << std::endl;
+    std::cout << std::string(50, '-') << std::endl;
+    
+    for (const ExecutionResult& result : results) {
+        std::cout << std::left << std::setw(6) << Order::sideName(result.side)
+                  << std::setw(8) << SymbolTable::instance().name(result.symbolId)
+                  << std::right << std::setw(8) << result.filledQuantity
+                  << std::setw(12) << std::fixed << std::setprecision(2)
+                  << FixedPoint::toDouble(result.averagePrice) << "  " << std::left;
+        
+        if (result.error != ExecutionError::None && result.filledQuantity > 0) {
+            std::cout << Colors::WARNING << "PARTIAL, " << executionErrorName(result.error)
+                      << Colors::RESET;
+            filled++;
+        } else if (result.error != ExecutionError::None) {
+            std::cout << Colors::ERROR << executionErrorName(result.error) << Colors::RESET;
+            rejected++;
+        } else if (result.restingQuantity > 0) {
+            std::cout << Colors::INFO << "RESTING " << result.restingQuantity << Colors::RESET;
+            resting++;
+        } else {
+            std::cout << Colors::SUCCESS << Order::statusName(result.status) << Colors::RESET;
+            if (result.filledQuantity > 0) filled++;
+        }
+        std::cout << "\n";
+    }
+    
+    std::cout << Colors::SUCCESS << Symbols::CHECK << " Batch complete: " << filled << " filled, "
+              << resting << " resting, " << rejected << " rejected" << Colors::RESET << std::endl;
+}
+
+const char* TradingEngine::executionErrorName(ExecutionError error) {
+    switch (error) {
+        case ExecutionError::UnknownSymbol: return "UNKNOWN SYMBOL";
+        case ExecutionError::InsufficientFunds: return "INSUFFICIENT FUNDS";
+        case ExecutionError::InsufficientShares: return "INSUFFICIENT SHARES";
+        case ExecutionError::OrderNotionalLimit: return "NOTIONAL LIMIT";
+        case ExecutionError::PositionLimit: return "POSITION LIMIT";
+        case ExecutionError::GrossExposureLimit: return "EXPOSURE LIMIT";
+        case ExecutionError::PriceBand: return "PRICE BAND";
+        default: return "OK";
+    }
+}
+
+ExecutionError TradingEngine::riskError(RiskCheck check) {
+    switch (check) {
+        case RiskCheck::OrderNotional: return ExecutionError::OrderNotionalLimit;
+        case RiskCheck::PositionLimit: return ExecutionError::PositionLimit;
+        case RiskCheck::GrossExposure: return ExecutionError::GrossExposureLimit;
+        case RiskCheck::PriceBand: return ExecutionError::PriceBand;
+        default: return ExecutionError::None;
+    }
+}
+
+RiskGate& TradingEngine::getRiskGate() {
+    return riskGate;
+}
+
+void TradingEngine::setRiskLimits(const Portfolio& portfolio, const RiskLimits& limits) {
+    riskLimits[portfolio.getUserId()] = limits;
+    
+    uint32_t owner = findAccount(portfolio);
+    if (owner != OrderBook::NONE) riskGate.setLimits(owner, limits);
+}
+
+void TradingEngine::clearRiskLimits(const Portfolio& portfolio) {
+    riskLimits.erase(portfolio.getUserId());
+    
+    uint32_t owner = findAccount(portfolio);
+    if (owner != OrderBook::NONE) riskGate.setLimits(owner, riskGate.getDefaultLimits());
+}
+
+RiskLimits TradingEngine::getRiskLimits(const Portfolio& portfolio) const {
+    auto it = riskLimits.find(portfolio.getUserId());
+    return it != riskLimits.end() ? it->second : riskGate.getDefaultLimits();
+}
+
+bool TradingEngine::hasRiskLimits(const Portfolio& portfolio) const {
+    return riskLimits.find(portfolio.getUserId()) != riskLimits.end();
+}
+
+std::string TradingEngine::serializeRiskLimits() const {
+    std::ostringstream oss;
+    oss << riskLimits.size() << "\n";
+    
+    for (const auto& entry : riskLimits) {
+        oss << entry.first << "|" << entry.second.serialize() << "\n";
+    }
+    
+    return oss.str();
+}
+
+void TradingEngine::deserializeRiskLimits(const std::string& data) {
+    riskLimits.clear();
+    
+    std::istringstream iss(data);
+    std::string line;
+    
+    if (!std::getline(iss, line)) return;
+    int count = std::stoi(line);
+    
+    for (int i = 0; i < count; i++) {
+        if (!std::getline(iss, line)) break;
+        size_t split = line.find('|');
+        if (split == std::string::npos) continue;
+        riskLimits[line.substr(0, split)] = RiskLimits::deserialize(line.substr(split + 1));
+    }
+}
+
+bool TradingEngine::cancelOrder(SymbolId symbol, uint64_t orderId, const Portfolio& portfolio) {
+    OrderBook::RestingView resting;
+    OrderBook* book = findOwned(symbol, orderId, portfolio, resting);
+    return book && book->cancel(orderId);
+}
+
+bool TradingEngine::amendOrder(SymbolId symbol, uint64_t orderId, int newQuantity,
+                               const Portfolio& portfolio) {
+    OrderBook::RestingView resting;
+    OrderBook* book = findOwned(symbol, orderId, portfolio, resting);
+    return book && book->amend(orderId, newQuantity);
+}
+
+bool TradingEngine::replaceOrder(SymbolId symbol, uint64_t orderId, Order* replacement,
+                                 Portfolio& portfolio) {
+    if (!replacement) return false;
+    
+    OrderBook::RestingView resting;
+    OrderBook* book = findOwned(symbol, orderId, portfolio, resting);
+    size_t row = market.findRow(symbol);
+    if (!book || row == MarketDataStore::npos) {
+        std::cout << "Order " << orderId << " is not resting." << std::endl;
+        return false;
+    }
+    
+    if (replacement->getSymbolId() != symbol || replacement->getSide() != resting.side) {
+        std::cout << "A replacement must be for the same stock and side." << std::endl;
+        replacement->setStatus(OrderStatus::Cancelled);
+        return false;
+    }
+    
+    // What the original reserved comes back when it is cancelled, so it
+    // counts toward the replacement
+    bool isBuy = resting.side == OrderSide::Buy;
+    bool covered = isBuy
+        ? FixedPoint::notional(replacement->getPrice(), replacement->getQuantity()) <=
+              portfolio.getAvailableCash() + FixedPoint::notional(resting.price, resting.quantity)
+        : replacement->getQuantity() <= portfolio.getAvailableShares(symbol) + resting.quantity;
+    if (!covered) {
+        std::cout << "Insufficient " << (isBuy ? "funds" : "shares") << " for the replacement; order "
+                  << orderId << " is still resting." << std::endl;
+        replacement->setStatus(OrderStatus::Cancelled);
+        return false;
+    }
+    
+    RiskCheck risk = riskGate.check(resting.owner, resting.side, symbol, replacement->getQuantity(),
+                                    replacement->getPrice(), market.getLastPrice(row));
+    if (risk != RiskCheck::Passed) {
+        std::cout << Colors::ERROR << Symbols::CROSS << " Replacement rejected by risk check: "
+                  << RiskGate::checkName(risk) << Colors::RESET << std::endl;
+        replacement->setStatus(OrderStatus::Cancelled);
+        return false;
+    }
+    
+    book->cancel(orderId);
+    return executeOrder(replacement, portfolio);
+}
+
+bool TradingEngine::placeStopOrder(Order* order, Portfolio& portfolio, StopType type,
+                                   Price stopPrice) {
+    if (type == StopType::TrailingStop) {
+        std::cout << "Use a trail amount for trailing stops." << std::endl;
+        return false;
+    }
+    return addStop(order, portfolio, type, stopPrice, 0);
+}
+
+bool TradingEngine::placeTrailingStop(Order* order, Portfolio& portfolio, Price trailAmount) {
+    if (trailAmount <= 0) {
+        std::cout << "Trail amount must be positive." << std::endl;
         return false;
     }
+    return addStop(order, portfolio, StopType::TrailingStop, 0, trailAmount);
 }
 
-bool TradingEngine::executeSellOrder(SellOrder* order, Portfolio& portfolio) {
-    if (!stockExists(order->getSymbol())) {
+bool TradingEngine::addStop(Order* order, Portfolio& portfolio, StopType type, Price stopPrice,
+                            Price trailAmount) {
+    if (!order) return false;
+    
+    SymbolId symbol = order->getSymbolId();
+    size_t row = market.findRow(symbol);
+    if (row == MarketDataStore::npos) {
         std::cout << "Stock " << order->getSymbol() << " does not exist." << std::endl;
-        order->setStatus("CANCELLED");
+        order->setStatus(OrderStatus::Cancelled);
         return false;
     }
     
-    Stock* stock = getStock(order->getSymbol());
-    double currentPrice = stock->getCurrentPrice();
+    // A stop already reached would fire immediately; place an order instead
+    Price current = market.getLastPrice(row);
+    if (type != StopType::TrailingStop &&
+        (order->isBuy() ? stopPrice <= current : stopPrice >= current)) {
+        std::cout << "Stop price must be " << (order->isBuy() ? "above" : "below")
+                  << " the current price of $" << std::fixed << std::setprecision(2)
+                  << FixedPoint::toDouble(current) << "." << std::endl;
+        order->setStatus(OrderStatus::Cancelled);
+        return false;
+    }
     
-    // Execute at current market price
-    bool success = portfolio.sellStock(order->getSymbol(), order->getQuantity(), currentPrice);
+    StopIndex::StopOrder stop;
+    stop.order = order->getRecord();
+    stop.stopPrice = stopPrice;
+    stop.trailAmount = trailAmount;
+    stop.owner = attachAccount(portfolio);
+    stop.type = type;
     
-    if (success) {
-        order->setStatus("EXECUTED");
-        std::cout << Colors::SUCCESS << Symbols::CHECK << " Sell order executed: " << order->getQuantity() << " shares of " 
-                  << order->getSymbol() << " at " << Colors::BOLD_WHITE << "$" << std::fixed << std::setprecision(2) 
-                  << currentPrice << Colors::RESET << std::endl;
-        return true;
+    StopIndex& stops = getStops(symbol);
+    stops.add(stop, current);
+    
+    std::cout << Colors::SUCCESS << Symbols::CHECK << " Stop order placed: " << order->getOrderType()
+              << " " << order->getQuantity() << " " << order->getSymbol() << " triggers at $"
+              << std::fixed << std::setprecision(2)
+              << FixedPoint::toDouble(stops.getStopPrice(order->getId())) << Colors::RESET << std::endl;
+    return true;
+}
+
+bool TradingEngine::cancelStopOrder(SymbolId symbol, uint64_t orderId, const Portfolio& portfolio) {
+    if (symbol >= stopBooks.size() || !stopBooks[symbol]) return false;
+    
+    uint32_t owner = findAccount(portfolio);
+    if (owner == OrderBook::NONE || stopBooks[symbol]->getOwner(orderId) != owner) return false;
+    return stopBooks[symbol]->cancel(orderId);
+}
+
+size_t TradingEngine::getStopOrders(const Portfolio& portfolio,
+                                    std::vector<StopIndex::StopOrder>& stops) const {
+    uint32_t owner = findAccount(portfolio);
+    if (owner == OrderBook::NONE) return 0;
+    
+    size_t found = 0;
+    for (const auto& book : stopBooks) {
+        if (book) found += book->getOwned(owner, stops);
+    }
+    return found;
+}
+
+const StopIndex* TradingEngine::findStops(SymbolId symbol) const {
+    return symbol < stopBooks.size() ? stopBooks[symbol].get() : nullptr;
+}
+
+size_t TradingEngine::drainStopExecutions(std::vector<ExecutionResult>& executions) {
+    size_t drained = stopExecutions.size();
+    executions.insert(executions.end(), stopExecutions.begin(), stopExecutions.end());
+    stopExecutions.clear();
+    return drained;
+}
+
+StopIndex& TradingEngine::getStops(SymbolId symbol) {
+    if (symbol >= stopBooks.size()) {
+        stopBooks.resize(symbol + 1);
+    }
+    if (!stopBooks[symbol]) {
+        stopBooks[symbol].reset(new StopIndex(symbol));
+    }
+    return *stopBooks[symbol];
+}
+
+void TradingEngine::onPriceUpdate(size_t row, SymbolId symbol, Price price) {
+    if (symbol < stopBooks.size() && stopBooks[symbol] && !stopBooks[symbol]->empty()) {
+        fireStops(row, symbol, price);
+    }
+    
+    if (symbol < markWatchers.size()) {
+        for (uint32_t owner : markWatchers[symbol]) {
+            accounts[owner]->markPrice(symbol, price);
+        }
+    }
+}
+
+void TradingEngine::onRestingReduced(SymbolId symbol, uint32_t owner, OrderSide side, Price price,
+                                     int32_t quantity) {
+    Portfolio* portfolio = owner < accounts.size() ? accounts[owner] : nullptr;
+    if (!portfolio) return;
+    
+    if (side == OrderSide::Buy) {
+        portfolio->releaseCash(FixedPoint::notional(price, quantity));
     } else {
-        order->setStatus("CANCELLED");
-        return false;
+        portfolio->releaseShares(symbol, quantity);
+    }
+}
+
+void TradingEngine::fireStops(size_t row, SymbolId symbol, Price price) {
+    triggeredStops.clear();
+    stopBooks[symbol]->onPrice(price, triggeredStops);
+    
+    for (const StopIndex::StopOrder& stop : triggeredStops) {
+        Portfolio* portfolio = stop.owner < accounts.size() ? accounts[stop.owner] : nullptr;
+        if (!portfolio) continue;
+        
+        // Stop and trailing stops become market orders; a buy is capped at
+        // the most its cash pays for, so the book never fills it past what
+        // the checks below approved
+        OrderRecord record = stop.order;
+        if (stop.type != StopType::StopLimit) {
+            record.price = (record.side == OrderSide::Buy)
+                ? std::max<Money>(portfolio->getAvailableCash(), 0) / record.quantity
+                : OrderBook::marketLimit(record.side);
+        }
+        Order order(record);
+        
+        ExecutionResult result;
+        result.orderId = record.orderId;
+        result.symbolId = symbol;
+        result.side = record.side;
+        
+        if (record.side == OrderSide::Buy) {
+            Price worst = (stop.type == StopType::StopLimit) ? record.price : price;
+            if (FixedPoint::notional(worst, record.quantity) > portfolio->getAvailableCash()) {
+                result.error = ExecutionError::InsufficientFunds;
+            }
+        } else {
+            if (portfolio->getAvailableShares(symbol) < record.quantity) {
+                result.error = ExecutionError::InsufficientShares;
+            }
+        }
+        
+        if (result.error == ExecutionError::None) {
+            Price effective = (stop.type == StopType::StopLimit) ? record.price : price;
+            RiskCheck risk = riskGate.check(stop.owner, record.side, symbol, record.quantity,
+                                            effective, price);
+            if (risk != RiskCheck::Passed) result.error = riskError(risk);
+        }
+        
+        if (result.error == ExecutionError::None) {
+            fillOrder(order, row, *portfolio, result);
+        } else {
+            result.status = OrderStatus::Cancelled;
+        }
+        stopExecutions.push_back(result);
+    }
+}
+
+OrderBook& TradingEngine::getBook(SymbolId symbol) {
+    if (symbol >= books.size()) {
+        books.resize(symbol + 1);
+    }
+    if (!books[symbol]) {
+        books[symbol].reset(new OrderBook(symbol));
+        books[symbol]->setRestingOrderListener(this);
+    }
+    return *books[symbol];
+}
+
+const OrderBook* TradingEngine::findBook(SymbolId symbol) const {
+    return symbol < books.size() ? books[symbol].get() : nullptr;
+}
+
+bool TradingEngine::getDepthSnapshot(SymbolId symbol, size_t levels,
+                                     OrderBook::DepthSnapshot& snapshot) const {
+    snapshot.sequence = 0;
+    snapshot.bids.clear();
+    snapshot.asks.clear();
+    if (!stockExists(symbol)) return false;
+    
+    const OrderBook* book = findBook(symbol);
+    if (book) {
+        book->getDepthSnapshot(levels, snapshot);
+    }
+    return true;
+}
+
+bool TradingEngine::subscribeDepth(SymbolId symbol, size_t levels) {
+    if (!stockExists(symbol) || levels == 0) return false;
+    getBook(symbol).setDepthTracking(levels);
+    return true;
+}
+
+void TradingEngine::unsubscribeDepth(SymbolId symbol) {
+    if (symbol < books.size() && books[symbol]) {
+        books[symbol]->setDepthTracking(0);
+    }
+}
+
+size_t TradingEngine::drainDepthUpdates(SymbolId symbol,
+                                        std::vector<OrderBook::DepthUpdate>& updates) {
+    OrderBook* book = symbol < books.size() ? books[symbol].get() : nullptr;
+    return book ? book->drainDepthUpdates(updates) : 0;
+}
+
+void TradingEngine::displayDepth(const OrderBook::DepthSnapshot& depth) {
+    std::cout << std::right << std::setw(7) << "Orders" << std::setw(9) << "Qty"
+              << std::setw(11) << "Bid" << "  |" << std::setw(11) << "Ask"
+              << std::setw(9) << "Qty" << std::setw(7) << "Orders" << std::endl;
+    
+    size_t rows = std::max(depth.bids.size(), depth.asks.size());
+    for (size_t i = 0; i < rows; i++) {
+        if (i < depth.bids.size()) {
+            const OrderBook::DepthLevel& bid = depth.bids[i];
+            std::cout << std::setw(7) << bid.orderCount << std::setw(9) << bid.quantity
+                      << std::setw(11) << std::fixed << std::setprecision(2)
+                      << FixedPoint::toDouble(bid.price);
+        } else {
+            std::cout << std::string(27, ' ');
+        }
+        std::cout << "  |";
+        if (i < depth.asks.size()) {
+            const OrderBook::DepthLevel& ask = depth.asks[i];
+            std::cout << std::setw(11) << std::fixed << std::setprecision(2)
+                      << FixedPoint::toDouble(ask.price)
+                      << std::setw(9) << ask.quantity << std::setw(7) << ask.orderCount;
+        }
+        std::cout << std::endl;
+    }
+}
+
+uint32_t TradingEngine::findAccount(const Portfolio& portfolio) const {
+    // The portfolio caches its owner id; a stale id from another engine
+    // or an earlier attachment does not match the slot
+    uint32_t owner = portfolio.getAccountId();
+    if (owner < accounts.size() && accounts[owner] == &portfolio) return owner;
+    return OrderBook::NONE;
+}
+
+OrderBook* TradingEngine::findOwned(SymbolId symbol, uint64_t orderId, const Portfolio& portfolio,
+                                    OrderBook::RestingView& resting) {
+    OrderBook* book = symbol < books.size() ? books[symbol].get() : nullptr;
+    uint32_t owner = findAccount(portfolio);
+    if (!book || owner == OrderBook::NONE || !book->findResting(orderId, resting) ||
+        resting.owner != owner) {
+        return nullptr;
+    }
+    return book;
+}
+
+uint32_t TradingEngine::attachAccount(Portfolio& portfolio) {
+    uint32_t owner = findAccount(portfolio);
+    if (owner != OrderBook::NONE) return owner;
+    
+    if (!freeAccounts.empty()) {
+        owner = freeAccounts.back();
+        freeAccounts.pop_back();
+    } else {
+        owner = static_cast<uint32_t>(accounts.size());
+        accounts.push_back(nullptr);
+    }
+    accounts[owner] = &portfolio;
+    portfolio.setAccountId(owner);
+    riskGate.openAccount(owner, portfolio, getRiskLimits(portfolio));
+    
+    for (const Position& position : portfolio.getPositions()) {
+        size_t row = market.findRow(position.symbolId);
+        Price price = (row != MarketDataStore::npos) ? market.getLastPrice(row) : 0;
+        syncMark(owner, position.symbolId, price);
+    }
+    return owner;
+}
+
+void TradingEngine::syncMark(uint32_t owner, SymbolId symbol, Price price) {
+    if (symbol >= markWatchers.size()) {
+        markWatchers.resize(symbol + 1);
     }
+    std::vector<uint32_t>& watchers = markWatchers[symbol];
+    auto it = std::find(watchers.begin(), watchers.end(), owner);
+    
+    // Subscribe on the first share held, unsubscribe once flat
+    bool held = accounts[owner]->markPrice(symbol, price);
+    if (held && it == watchers.end()) {
+        watchers.push_back(owner);
+    } else if (!held && it != watchers.end()) {
+        *it = watchers.back();
+        watchers.pop_back();
+    }
+}
+
+void TradingEngine::watchPortfolio(Portfolio& portfolio) {
+    attachAccount(portfolio);
+}
+
+void TradingEngine::detachAccount(Portfolio& portfolio) {
+    uint32_t owner = findAccount(portfolio);
+    if (owner == OrderBook::NONE) return;
+    
+    for (auto& book : books) {
+        if (book) book->cancelOwner(owner);
+    }
+    for (auto& stops : stopBooks) {
+        if (stops) stops->cancelOwner(owner);
+    }
+    for (auto& watchers : markWatchers) {
+        watchers.erase(std::remove(watchers.begin(), watchers.end(), owner), watchers.end());
+    }
+    accounts[owner] = nullptr;
+    freeAccounts.push_back(owner);
+    portfolio.setAccountId(Portfolio::NO_ACCOUNT);
 }
 
 void TradingEngine::displayMarket() const {
-    if (stocks.empty()) {
+    if (market.empty()) {
         std::cout << Colors::WARNING << "No stocks in the market." << Colors::RESET << std::endl;
         return;
     }
@@ -122,37 +956,51 @@ void TradingEngine::displayMarket() const {
               << std::setw(10) << "Change%" << Colors::RESET << std::endl;
     std::cout << Colors::DIM << std::string(80, '-') << Colors::RESET << std::endl;
     
-    for (const auto& pair : stocks) {
-        pair.second.display();
+    // Rows are in listing order; the table is shown alphabetically
+    std::vector<size_t> rows(market.size());
+    for (size_t row = 0; row < rows.size(); row++) rows[row] = row;
+    std::sort(rows.begin(), rows.end(), [this](size_t a, size_t b) {
+        return market.getSymbol(a) < market.getSymbol(b);
+    });
+    
+    for (size_t row : rows) {
+        Stock::displayQuote(market.getSymbol(row), market.getName(row), market.getLastPrice(row),
+                            market.getPriceChange(row), market.getPriceChangePercent(row));
         std::cout << std::endl;
     }
     
     std::cout << Colors::HEADER << std::string(80, '=') << Colors::RESET << std::endl;
 }
 
-void TradingEngine::displayStockDetails(const std::string& symbol) const {
-    auto it = stocks.find(symbol);
-    if (it == stocks.end()) {
-        std::cout << "Stock " << symbol << " not found." << std::endl;
+void TradingEngine::displayStockDetails(SymbolId symbol) const {
+    size_t row = market.findRow(symbol);
+    if (row == MarketDataStore::npos) {
+        std::cout << "Stock " << SymbolTable::instance().name(symbol) << " not found." << std::endl;
         return;
     }
     
-    const Stock& stock = it->second;
-    
     std::cout << "\n" << std::string(60, '=') << std::endl;
-    std::cout << "STOCK DETAILS: " << symbol << std::endl;
+    std::cout << "STOCK DETAILS: " << market.getSymbol(row) << std::endl;
     std::cout << std::string(60, '=') << std::endl;
-    std::cout << "Name: " << stock.getName() << std::endl;
+    std::cout << "Name: " << market.getName(row) << std::endl;
     std::cout << "Current Price: $" << std::fixed << std::setprecision(2) 
-              << stock.getCurrentPrice() << std::endl;
-    std::cout << "Price Change: $" << stock.getPriceChange() 
-              << " (" << stock.getPriceChangePercent() << "%)" << std::endl;
-    std::cout << "5-Period MA: $" << stock.getMovingAverage(5) << std::endl;
-    std::cout << "10-Period MA: $" << stock.getMovingAverage(10) << std::endl;
-    std::cout << "20-Period MA: $" << stock.getMovingAverage(20) << std::endl;
+              << FixedPoint::toDouble(market.getLastPrice(row)) << std::endl;
+    std::cout << "Price Change: $" << FixedPoint::toDouble(market.getPriceChange(row)) 
+              << " (" << market.getPriceChangePercent(row) << "%)" << std::endl;
+    std::cout << "5-Period MA: $" << market.getMovingAverage(row, 5) << std::endl;
+    std::cout << "10-Period MA: $" << market.getMovingAverage(row, 10) << std::endl;
+    std::cout << "20-Period MA: $" << market.getMovingAverage(row, 20) << std::endl;
+    
+    // Market-by-price ladder
+    OrderBook::DepthSnapshot depth;
+    getDepthSnapshot(symbol, DISPLAY_DEPTH, depth);
+    if (!depth.bids.empty() || !depth.asks.empty()) {
+        std::cout << "\nOrder Book (Top " << DISPLAY_DEPTH << "):" << std::endl;
+        displayDepth(depth);
+    }
     
     // Display recent price history
-    const auto& history = stock.getPriceHistory();
+    PriceHistoryView history = market.getPriceHistory(row);
     int count = std::min(10, static_cast<int>(history.size()));
     
     std::cout << "\nRecent Price History (Last " << count << "):" << std::endl;
@@ -163,27 +1011,28 @@ void TradingEngine::displayStockDetails(const std::string& symbol) const {
     std::cout << std::string(60, '=') << std::endl;
 }
 
-std::map<std::string, double> TradingEngine::getCurrentPrices() const {
-    std::map<std::string, double> prices;
-    for (const auto& pair : stocks) {
-        prices[pair.first] = pair.second.getCurrentPrice();
+std::vector<Price> TradingEngine::getCurrentPrices() const {
+    std::vector<Price> prices(SymbolTable::instance().size(), 0);
+    const std::vector<Price>& lastPrices = market.getLastPrices();
+    for (size_t row = 0; row < lastPrices.size(); row++) {
+        prices[market.getSymbolId(row)] = lastPrices[row];
     }
     return prices;
 }
 
 std::string TradingEngine::serializeStocks() const {
     std::ostringstream oss;
-    oss << stocks.size() << "\n";
+    oss << market.size() << "\n";
     
-    for (const auto& pair : stocks) {
-        oss << pair.second.serialize() << "\n";
+    for (size_t row = 0; row < market.size(); row++) {
+        oss << market.toStock(row).serialize() << "\n";
     }
     
     return oss.str();
 }
 
 void TradingEngine::deserializeStocks(const std::string& data) {
-    stocks.clear();
+    market.clear();
     
     std::istringstream iss(data);
     std::string line;
@@ -195,7 +1044,6 @@ void TradingEngine::deserializeStocks(const std::string& data) {
     // Read stocks
     for (int i = 0; i < count; i++) {
         if (!std::getline(iss, line)) break;
-        Stock stock = Stock::deserialize(line);
-        stocks[stock.getSymbol()] = stock;
+        market.addSymbol(Stock::deserialize(line));
     }
 }
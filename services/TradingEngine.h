@@ -6,13 +6,85 @@
 #include <memory>
 #include "../models/Stock.h"
 #include "../models/Order.h"
+#include "../models/OrderPool.h"
 #include "../models/Portfolio.h"
+#include "../models/PortfolioOverlay.h"
+#include "MarketDataStore.h"
+#include "OrderBook.h"
+#include "StopIndex.h"
+#include "RiskGate.h"
+
+// Why an order in a batch was rejected
+enum class ExecutionError : uint8_t {
+    None,
+    UnknownSymbol,
+    InsufficientFunds,
+    InsufficientShares,
+    OrderNotionalLimit,  // Pre-trade risk rejections
+    PositionLimit,
+    GrossExposureLimit,
+    PriceBand
+};
+
+// Compact outcome of one executed order
+struct ExecutionResult {
+    uint64_t orderId;
+    Price averagePrice;       // Volume-weighted fill price, 0 when unfilled
+    SymbolId symbolId;
+    int32_t filledQuantity;
+    int32_t restingQuantity;  // Left in the book as a limit order
+    OrderSide side;
+    OrderStatus status;
+    ExecutionError error;     // Also set, with status Cancelled, on a partial fill
+    
+    ExecutionResult()
+        : orderId(0), averagePrice(0), symbolId(INVALID_SYMBOL), filledQuantity(0),
+          restingQuantity(0), side(OrderSide::Buy), status(OrderStatus::Pending),
+          error(ExecutionError::None) {}
+};
 
 // TradingEngine manages stocks and executes orders
-class TradingEngine {
+class TradingEngine : public PriceListener, public RestingOrderListener {
 private:
-    std::map<std::string, Stock> stocks; // symbol -> Stock
-    std::vector<std::unique_ptr<Order>> orderBook;
+    MarketDataStore market; // Columnar market data, one row per symbol
+    std::vector<std::unique_ptr<OrderBook>> books; // SymbolId -> limit order book
+    std::vector<Portfolio*> accounts; // Book owner id -> portfolio
+    std::vector<uint32_t> freeAccounts; // Detached owner ids, reused first
+    std::vector<OrderBook::Fill> fillBuffer; // Reused across executions
+    std::vector<int> batchShares; // SymbolId -> shares committed to sells in a batch
+    std::vector<std::unique_ptr<StopIndex>> stopBooks; // SymbolId -> dormant stops
+    std::vector<StopIndex::StopOrder> triggeredStops; // Reused per price update
+    std::vector<ExecutionResult> stopExecutions; // Triggered stops not yet drained
+    RiskGate riskGate; // Pre-trade limits, indexed by book owner id
+    std::map<std::string, RiskLimits> riskLimits; // User id -> limits set for it
+    std::vector<std::vector<uint32_t>> markWatchers; // SymbolId -> owners holding it
+    
+    OrderBook& getBook(SymbolId symbol);
+    uint32_t attachAccount(Portfolio& portfolio);
+    uint32_t findAccount(const Portfolio& portfolio) const; // OrderBook::NONE when detached
+    OrderBook* findOwned(SymbolId symbol, uint64_t orderId, const Portfolio& portfolio,
+                         OrderBook::RestingView& resting); // Null unless `portfolio` owns it
+    void fillOrder(Order& order, size_t row, Portfolio& portfolio, ExecutionResult& result);
+    void syncMark(uint32_t owner, SymbolId symbol, Price price);
+    void fireStops(size_t row, SymbolId symbol, Price price);
+    StopIndex& getStops(SymbolId symbol);
+    static ExecutionError riskError(RiskCheck check);
+    static void reportShortfall(const Order& order, const Portfolio& portfolio);
+    bool addStop(Order* order, Portfolio& portfolio, StopType type, Price stopPrice,
+                 Price trailAmount);
+    
+    // Fires the symbol's stops, then re-marks the portfolios holding it,
+    // from the market's price listener hook
+    void onPriceUpdate(size_t row, SymbolId symbol, Price price) override;
+    
+    // Releases the cash or shares a resting order had reserved as it
+    // fills or leaves the book
+    void onRestingReduced(SymbolId symbol, uint32_t owner, OrderSide side, Price price,
+                          int32_t quantity) override;
+    
+    // The market holds a pointer back to this engine
+    TradingEngine(const TradingEngine&);
+    TradingEngine& operator=(const TradingEngine&);
 
 public:
     // Constructor
@@ -20,22 +92,97 @@ public:
     
     // Stock management
     void addStock(const Stock& stock);
-    bool removeStock(const std::string& symbol);
-    Stock* getStock(const std::string& symbol);
-    const std::map<std::string, Stock>& getAllStocks() const;
-    bool stockExists(const std::string& symbol) const;
+    bool removeStock(SymbolId symbol);
+    // Copies built from the market store, so later price updates never
+    // invalidate them; getStock() returns false when not listed
+    bool getStock(SymbolId symbol, Stock& stock) const;
+    std::map<std::string, Stock> getAllStocks() const; // By ticker
+    bool stockExists(SymbolId symbol) const;
+    bool updateStockPrice(SymbolId symbol, Price price);
+    
+    // Direct access to the columnar store for scans and simulation
+    MarketDataStore& getMarket();
+    const MarketDataStore& getMarket() const;
     
-    // Order execution using polymorphism
+    // Order execution; the order's side selects the path
     bool executeOrder(Order* order, Portfolio& portfolio);
-    bool executeBuyOrder(BuyOrder* order, Portfolio& portfolio);
-    bool executeSellOrder(SellOrder* order, Portfolio& portfolio);
+    
+    // Execute a batch for one portfolio without console output. Cash and
+    // shares are validated once for the whole batch, then every accepted
+    // order is filled in a single pass. `results` gets one entry per order.
+    // Returns the number of orders that filled.
+    size_t executeBatch(const std::vector<OrderPtr>& orders, Portfolio& portfolio,
+                        std::vector<ExecutionResult>& results);
+    
+    // What executeBatch would do to `overlay`'s base, applied to the
+    // overlay instead; the book and the portfolio are not touched. Orders
+    // are validated the same way against the overlay's cash and shares.
+    // A marketable order fills in full at the last price; any other would
+    // rest and leaves the overlay unchanged. Resting makers and risk
+    // limits are not simulated. Returns the number that would fill.
+    size_t previewBatch(const std::vector<OrderPtr>& orders, PortfolioOverlay& overlay,
+                        std::vector<ExecutionResult>& results) const;
+    static void displayExecutionResults(const std::vector<ExecutionResult>& results);
+    static const char* executionErrorName(ExecutionError error);
+    
+    // Resting order management; only the portfolio that placed an order
+    // can change it. A replacement is validated before the original is
+    // cancelled, so a rejected replacement leaves the original resting.
+    bool cancelOrder(SymbolId symbol, uint64_t orderId, const Portfolio& portfolio);
+    bool amendOrder(SymbolId symbol, uint64_t orderId, int newQuantity,
+                    const Portfolio& portfolio); // Reduce only
+    bool replaceOrder(SymbolId symbol, uint64_t orderId, Order* replacement, Portfolio& portfolio);
+    
+    // Stop orders stay dormant until the last price reaches the stop; stop
+    // and trailing stops then execute at market, a buy up to the price its
+    // cash covers, and stop-limits at the order's price. Cash and shares
+    // are checked when the stop fires.
+    bool placeStopOrder(Order* order, Portfolio& portfolio, StopType type, Price stopPrice);
+    bool placeTrailingStop(Order* order, Portfolio& portfolio, Price trailAmount);
+    bool cancelStopOrder(SymbolId symbol, uint64_t orderId, const Portfolio& portfolio);
+    const StopIndex* findStops(SymbolId symbol) const;
+    size_t getStopOrders(const Portfolio& portfolio, std::vector<StopIndex::StopOrder>& stops) const;
+    
+    // Results of stops triggered by price updates since the previous
+    // drain; callers drain after moving prices
+    size_t drainStopExecutions(std::vector<ExecutionResult>& executions);
+    
+    // Pre-trade risk: every order is checked against its account's limits
+    // before it can reach the book. Limits set for a portfolio are kept by
+    // user id and applied whenever it attaches; others get the defaults.
+    RiskGate& getRiskGate();
+    void setRiskLimits(const Portfolio& portfolio, const RiskLimits& limits);
+    void clearRiskLimits(const Portfolio& portfolio); // Back to the defaults
+    RiskLimits getRiskLimits(const Portfolio& portfolio) const;
+    bool hasRiskLimits(const Portfolio& portfolio) const;
+    std::string serializeRiskLimits() const;
+    void deserializeRiskLimits(const std::string& data);
+    
+    // Order books
+    const OrderBook* findBook(SymbolId symbol) const;
+    void detachAccount(Portfolio& portfolio); // Cancels its resting orders
+    
+    // Keep a portfolio marked to market: it is valued at the current prices
+    // now, then re-marked only when a symbol it holds changes price
+    void watchPortfolio(Portfolio& portfolio);
+    
+    // Level-2 depth. A snapshot gives the top `levels` per side; after
+    // subscribeDepth(), drainDepthUpdates() returns the changes to the top
+    // `levels` since the previous drain, to be applied over a snapshot by
+    // sequence (see DepthLadder). Each book feeds one subscriber.
+    static const size_t DISPLAY_DEPTH = 5;
+    bool getDepthSnapshot(SymbolId symbol, size_t levels, OrderBook::DepthSnapshot& snapshot) const;
+    bool subscribeDepth(SymbolId symbol, size_t levels);
+    void unsubscribeDepth(SymbolId symbol);
+    size_t drainDepthUpdates(SymbolId symbol, std::vector<OrderBook::DepthUpdate>& updates);
+    static void displayDepth(const OrderBook::DepthSnapshot& depth); // Bids left, asks right
     
     // Market display
     void displayMarket() const;
-    void displayStockDetails(const std::string& symbol) const;
+    void displayStockDetails(SymbolId symbol) const;
     
-    // Price updates
-    std::map<std::string, double> getCurrentPrices() const;
+    // Price updates: last prices indexed by SymbolId, 0 when not listed
+    std::vector<Price> getCurrentPrices() const;
     
     // Serialization
     std::string serializeStocks() const;
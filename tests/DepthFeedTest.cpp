@@ -0,0 +1,165 @@
+// A ladder kept from a snapshot and drained depth updates matches a fresh
+// snapshot of the book's top levels, including levels that move up into
+// view and a resync after too many changes between drains
+#include <random>
+#include <vector>
+#include "TestSupport.h"
+#include "../services/DepthLadder.h"
+#include "../services/TradingEngine.h"
+
+namespace {
+    const size_t LEVELS = 3;
+    
+    using TestSupport::units;
+    
+    bool sameLevels(const std::vector<OrderBook::DepthLevel>& a,
+                    const std::vector<OrderBook::DepthLevel>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].price != b[i].price || a[i].quantity != b[i].quantity ||
+                a[i].orderCount != b[i].orderCount) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Drain into the ladder and compare it with a fresh snapshot
+    bool inSync(OrderBook& book, DepthLadder& ladder) {
+        std::vector<OrderBook::DepthUpdate> updates;
+        book.drainDepthUpdates(updates);
+        ladder.apply(updates);
+        
+        OrderBook::DepthSnapshot fresh;
+        book.getDepthSnapshot(LEVELS, fresh);
+        return sameLevels(ladder.getDepth().bids, fresh.bids) &&
+               sameLevels(ladder.getDepth().asks, fresh.asks);
+    }
+    
+    void testLevelMovesIntoView() {
+        OrderBook book(SymbolTable::instance().intern("DPA"));
+        std::vector<OrderBook::Fill> fills;
+        for (int i = 0; i < 5; i++) {
+            book.submit(i + 1, OrderSide::Buy, units(100 - i), 10, 0, true, fills);
+        }
+        
+        book.setDepthTracking(LEVELS);
+        DepthLadder ladder(LEVELS);
+        OrderBook::DepthSnapshot snapshot;
+        book.getDepthSnapshot(LEVELS, snapshot);
+        ladder.reset(snapshot);
+        
+        // The fourth level was never sent; removing the best brings it up
+        CHECK(book.cancel(1));
+        CHECK(inSync(book, ladder));
+        CHECK(ladder.getDepth().bids.back().price == units(97));
+        
+        // Changes below the followed levels are not sent
+        CHECK(book.cancel(5));
+        std::vector<OrderBook::DepthUpdate> updates;
+        CHECK(book.drainDepthUpdates(updates) == 0);
+        
+        // A sell sweeping the top two levels
+        book.submit(10, OrderSide::Sell, units(98), 20, 1, true, fills);
+        CHECK(inSync(book, ladder));
+        CHECK(ladder.getDepth().bids.size() == 1);
+    }
+    
+    void testNotTracking() {
+        OrderBook book(SymbolTable::instance().intern("DPD"));
+        std::vector<OrderBook::DepthUpdate> updates;
+        CHECK(book.drainDepthUpdates(updates) == 0);
+        
+        std::vector<OrderBook::Fill> fills;
+        book.submit(1, OrderSide::Buy, units(100), 10, 0, true, fills);
+        CHECK(book.drainDepthUpdates(updates) == 0);
+        
+        // Turning tracking off drops what was pending
+        book.setDepthTracking(LEVELS);
+        book.submit(2, OrderSide::Sell, units(101), 10, 0, true, fills);
+        book.setDepthTracking(0);
+        CHECK(!book.isDepthTracking());
+        CHECK(book.drainDepthUpdates(updates) == 0);
+        CHECK(updates.empty());
+        
+        TradingEngine engine;
+        SymbolId symbol = SymbolTable::instance().find("AAPL");
+        CHECK(engine.drainDepthUpdates(symbol, updates) == 0);
+        Price last = engine.getMarket().getLastPrice(engine.getMarket().findRow(symbol));
+        BuyOrder bid(symbol, 10, last - units(1));
+        Portfolio portfolio("depth");
+        CHECK(engine.executeOrder(&bid, portfolio));
+        CHECK(engine.drainDepthUpdates(symbol, updates) == 0);
+        CHECK(updates.empty());
+    }
+    
+    void testRandomStream() {
+        OrderBook book(SymbolTable::instance().intern("DPB"));
+        book.setDepthTracking(LEVELS);
+        DepthLadder ladder(LEVELS);
+        OrderBook::DepthSnapshot snapshot;
+        book.getDepthSnapshot(LEVELS, snapshot);
+        ladder.reset(snapshot);
+        
+        std::mt19937 random(14);
+        std::vector<OrderBook::Fill> fills;
+        std::vector<uint64_t> placed;
+        size_t mismatches = 0;
+        for (uint64_t id = 1; id <= 20000; id++) {
+            if (!placed.empty() && random() % 3 == 0) {
+                size_t pick = random() % placed.size();
+                book.cancel(placed[pick]);
+                placed[pick] = placed.back();
+                placed.pop_back();
+            } else {
+                OrderSide side = random() % 2 ? OrderSide::Buy : OrderSide::Sell;
+                Price price = units(100) + static_cast<int>(random() % 21) * 10 - 100;
+                fills.clear();
+                book.submit(id, side, price, 1 + random() % 50, 0, true, fills);
+                placed.push_back(id);
+            }
+            if (random() % 7 == 0 && !inSync(book, ladder)) {
+                mismatches++;
+            }
+        }
+        CHECK(inSync(book, ladder));
+        CHECK(mismatches == 0);
+    }
+    
+    void testResync() {
+        OrderBook book(SymbolTable::instance().intern("DPC"));
+        book.setDepthTracking(LEVELS);
+        DepthLadder ladder(LEVELS);
+        OrderBook::DepthSnapshot snapshot;
+        book.getDepthSnapshot(LEVELS, snapshot);
+        ladder.reset(snapshot);
+        
+        // Well past the distinct levels the book keeps between drains, so the
+        // pending list is compacted and found over the limit
+        std::vector<OrderBook::Fill> fills;
+        for (size_t i = 0; i < 2 * OrderBook::MAX_PENDING_LEVELS + 10; i++) {
+            book.submit(i + 1, OrderSide::Sell, units(100) + static_cast<Price>(i), 1, 0, true, fills);
+        }
+        for (size_t i = 0; i < 5; i++) {
+            book.cancel(i + 1);
+        }
+        
+        std::vector<OrderBook::DepthUpdate> updates;
+        book.drainDepthUpdates(updates);
+        CHECK(updates.size() == 1 + LEVELS);
+        CHECK(updates[0].level.price == 0 && updates[0].side == OrderSide::Sell);
+        ladder.apply(updates);
+        CHECK(ladder.getDepth().asks.size() == LEVELS);
+        CHECK(ladder.getDepth().asks[0].price == units(100) + 5);
+        CHECK(inSync(book, ladder));
+    }
+}
+
+int main() {
+    TestSupport::quietConsole();
+    testLevelMovesIntoView();
+    testNotTracking();
+    testRandomStream();
+    testResync();
+    return TEST_RESULT("DepthFeedTest");
+}
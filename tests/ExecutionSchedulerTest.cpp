@@ -0,0 +1,168 @@
+// TWAP parents carry unfilled slices to the end, send them as one final
+// child and report what that leaves unfilled
+#include <vector>
+#include "TestSupport.h"
+#include "../services/ExecutionScheduler.h"
+
+namespace {
+    using TestSupport::units;
+    
+    // A bid under the market never fills on its own: every slice rests, is
+    // pulled back at the next step and carried
+    void testUnfilledParentReportsShortfall() {
+        TradingEngine engine;
+        SymbolId symbol = TestSupport::listStock(engine, "EXS", units(100));
+        Portfolio buyer("buyer", units(100000));
+        ExecutionScheduler scheduler(engine);
+        
+        uint64_t id = scheduler.submitTwap(buyer, OrderSide::Buy, symbol, 40, units(90), 4, 1);
+        CHECK(id != 0);
+        
+        for (uint64_t step = 1; step <= 5; step++) {
+            scheduler.advanceTo(step);
+            ExecutionScheduler::ParentStatus status;
+            CHECK(scheduler.getStatus(id, status));
+            CHECK(status.filledQuantity == 0);
+            CHECK(status.workingQuantity == (step < 5 ? 10 * static_cast<int32_t>(step) : 40));
+        }
+        
+        // The final child held everything carried; the next step ends the parent
+        scheduler.advanceTo(6);
+        std::vector<ExecutionScheduler::ParentStatus> finished;
+        CHECK(scheduler.drainCompleted(finished) == 1);
+        CHECK(!finished.empty() && finished[0].unfilledQuantity == 40);
+        CHECK(!finished.empty() && finished[0].error == ExecutionError::None);
+        CHECK(scheduler.getActiveCount() == 0);
+        CHECK(buyer.getReservedCash() == 0);
+        CHECK(engine.findBook(symbol)->getRestingOrderCount() == 0);
+    }
+    
+    // A seller crossing the final child fills the whole carry
+    void testFinalChildFillsCarry() {
+        TradingEngine engine;
+        SymbolId symbol = TestSupport::listStock(engine, "EXF", units(100));
+        Portfolio buyer("buyer", units(100000));
+        Portfolio seller("seller", units(100000));
+        ExecutionScheduler scheduler(engine);
+        
+        BuyOrder stock(symbol, 100, units(100));
+        CHECK(engine.executeOrder(&stock, seller));
+        
+        uint64_t id = scheduler.submitTwap(buyer, OrderSide::Buy, symbol, 30, units(90), 3, 1);
+        for (uint64_t step = 1; step <= 4; step++) {
+            scheduler.advanceTo(step);
+        }
+        
+        ExecutionScheduler::ParentStatus status;
+        CHECK(scheduler.getStatus(id, status) && status.workingQuantity == 30);
+        SellOrder hit(symbol, 30, units(90));
+        CHECK(engine.executeOrder(&hit, seller));
+        
+        scheduler.advanceTo(5);
+        std::vector<ExecutionScheduler::ParentStatus> finished;
+        CHECK(scheduler.drainCompleted(finished) == 1);
+        CHECK(!finished.empty() && finished[0].filledQuantity == 30);
+        CHECK(!finished.empty() && finished[0].unfilledQuantity == 0);
+        CHECK(buyer.getPosition(symbol) && buyer.getPosition(symbol)->quantity == 30);
+    }
+    
+    void testCancelPortfolio() {
+        TradingEngine engine;
+        SymbolId symbol = TestSupport::listStock(engine, "EXC", units(100));
+        Portfolio buyer("buyer", units(100000));
+        ExecutionScheduler scheduler(engine);
+        
+        scheduler.submitTwap(buyer, OrderSide::Buy, symbol, 40, units(90), 4, 1);
+        scheduler.submitIceberg(buyer, OrderSide::Buy, symbol, 40, units(95), 5, 1);
+        scheduler.advanceTo(1);
+        CHECK(buyer.getReservedCash() > 0);
+        
+        CHECK(scheduler.cancelPortfolio(buyer) == 2);
+        CHECK(scheduler.getActiveCount() == 0);
+        CHECK(buyer.getReservedCash() == 0);
+        CHECK(scheduler.advanceTo(10) == 0);
+    }
+    
+    // Every child is journaled once it is done, a resting one only after it
+    // leaves the book, and the parent once it ends, flagged and with the total
+    void testOrdersJournaled() {
+        TradingEngine engine;
+        SymbolId symbol = TestSupport::listStock(engine, "EXJ", units(100));
+        Portfolio buyer("buyer", units(100000));
+        Portfolio seller("seller", units(100000));
+        ExecutionScheduler scheduler(engine);
+        
+        BuyOrder stock(symbol, 100, units(100));
+        CHECK(engine.executeOrder(&stock, seller));
+        
+        // Two marketable children fill at once; the third rests until hit
+        uint64_t id = scheduler.submitTwap(seller, OrderSide::Sell, symbol, 30, units(100), 3, 1);
+        scheduler.advanceTo(1);
+        scheduler.advanceTo(2);
+        std::vector<OrderRecord> records;
+        CHECK(scheduler.drainOrderRecords(records) == 2);
+        for (const OrderRecord& record : records) {
+            CHECK(record.flags == 0 && record.filledQuantity == 10);
+            CHECK(record.status == OrderStatus::Executed);
+        }
+        
+        engine.updateStockPrice(symbol, units(95));
+        scheduler.advanceTo(3);
+        CHECK(scheduler.drainOrderRecords(records) == 0);
+        BuyOrder hit(symbol, 4, units(100));
+        CHECK(engine.executeOrder(&hit, buyer));
+        
+        // The rest of the resting child is pulled and goes out as the final child
+        engine.updateStockPrice(symbol, units(100));
+        scheduler.advanceTo(4);
+        scheduler.advanceTo(5);
+        records.clear();
+        CHECK(scheduler.drainOrderRecords(records) == 3);
+        CHECK(records.size() == 3 && records[0].filledQuantity == 4);
+        CHECK(records.size() == 3 && records[0].status == OrderStatus::Cancelled);
+        CHECK(records.size() == 3 && records[1].quantity == 6 && records[1].filledQuantity == 6);
+        CHECK(records.size() == 3 && records[2].orderId == id);
+        CHECK(records.size() == 3 && (records[2].flags & ORDER_FLAG_PARENT) != 0);
+        CHECK(records.size() == 3 && records[2].quantity == 30 && records[2].filledQuantity == 30);
+        CHECK(records.size() == 3 && records[2].status == OrderStatus::Executed);
+    }
+    
+    // Only a child rejected outright ends the parent; what the filled slices
+    // left is reported unfilled and the rejected child is journaled too
+    void testRejectedChildEndsParent() {
+        TradingEngine engine;
+        SymbolId symbol = TestSupport::listStock(engine, "EXR", units(100));
+        Portfolio seller("seller", units(100000));
+        ExecutionScheduler scheduler(engine);
+        
+        BuyOrder stock(symbol, 15, units(100));
+        CHECK(engine.executeOrder(&stock, seller));
+        
+        scheduler.submitTwap(seller, OrderSide::Sell, symbol, 30, 0, 3, 1);
+        scheduler.advanceTo(1);
+        scheduler.advanceTo(2);
+        
+        std::vector<ExecutionScheduler::ParentStatus> finished;
+        CHECK(scheduler.drainCompleted(finished) == 1);
+        CHECK(!finished.empty() && finished[0].filledQuantity == 10);
+        CHECK(!finished.empty() && finished[0].unfilledQuantity == 20);
+        CHECK(!finished.empty() && finished[0].error == ExecutionError::InsufficientShares);
+        
+        std::vector<OrderRecord> records;
+        CHECK(scheduler.drainOrderRecords(records) == 3);
+        CHECK(records.size() == 3 && records[1].filledQuantity == 0);
+        CHECK(records.size() == 3 && records[1].status == OrderStatus::Cancelled);
+        CHECK(records.size() == 3 && records[2].filledQuantity == 10);
+        CHECK(records.size() == 3 && records[2].status == OrderStatus::Cancelled);
+    }
+}
+
+int main() {
+    TestSupport::quietConsole();
+    testUnfilledParentReportsShortfall();
+    testFinalChildFillsCarry();
+    testCancelPortfolio();
+    testOrdersJournaled();
+    testRejectedChildEndsParent();
+    return TEST_RESULT("ExecutionSchedulerTest");
+}
@@ -0,0 +1,82 @@
+// Steady-state orders make no heap allocations on the pool -> execute ->
+// release path. operator new is replaced to count every allocation.
+#include <cstdlib>
+#include <new>
+#include <vector>
+#include "TestSupport.h"
+#include "../models/OrderPool.h"
+#include "../services/TradingEngine.h"
+
+namespace {
+    size_t allocations = 0;
+}
+
+void* operator new(std::size_t size) {
+    allocations++;
+    void* block = std::malloc(size ? size : 1);
+    if (!block) throw std::bad_alloc();
+    return block;
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+namespace {
+    using TestSupport::units;
+    
+    void testSteadyStateOrders() {
+        TradingEngine engine;
+        SymbolId symbol = TestSupport::listStock(engine, "ALC", units(100));
+        Price price = units(100);
+        
+        Portfolio portfolio("alloc", units(1000000000));
+        OrderPool pool;
+        std::vector<OrderPtr> signals;
+        signals.reserve(16);
+        
+        OrderPtr opening = pool.createBuy(symbol, 1000, price);
+        CHECK(engine.executeOrder(opening.get(), portfolio));
+        opening.reset();
+        
+        // Warm up to a segment boundary of the transaction history, so the
+        // measured orders neither seal a segment nor outgrow the symbol's
+        // posting list; that growth belongs to the log, not to each order
+        const size_t WARM = 3 * TransactionLog::SEGMENT_SIZE;
+        for (size_t i = portfolio.getTransactionHistory().size(); i < WARM; i++) {
+            signals.push_back(i % 2 ? pool.createSell(symbol, 1, price) : pool.createBuy(symbol, 1, price));
+            engine.executeOrder(signals.back().get(), portfolio);
+            signals.clear();
+        }
+        CHECK(portfolio.getTransactionHistory().size() == WARM);
+        size_t poolCapacity = pool.capacity();
+        
+        const size_t ORDERS = TransactionLog::SEGMENT_SIZE / 2;
+        size_t before = allocations;
+        for (size_t i = 0; i < ORDERS; i++) {
+            signals.push_back(i % 2 ? pool.createSell(symbol, 1, price) : pool.createBuy(symbol, 1, price));
+            engine.executeOrder(signals.back().get(), portfolio);
+            signals.clear();
+        }
+        size_t during = allocations - before;
+        CHECK(before > 0);
+        
+        if (during != 0) {
+            std::cerr << during << " allocations over " << ORDERS << " orders" << std::endl;
+        }
+        CHECK(during == 0);
+        CHECK(portfolio.getTransactionHistory().size() == WARM + ORDERS);
+        CHECK(pool.capacity() == poolCapacity);
+        CHECK(pool.inUse() == 0);
+    }
+}
+
+int main() {
+    TestSupport::quietConsole();
+    testSteadyStateOrders();
+    return TEST_RESULT("OrderAllocationTest");
+}
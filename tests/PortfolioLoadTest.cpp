@@ -0,0 +1,113 @@
+// Saved portfolios load in parallel; a missing file keeps the trader's
+// current portfolio and an unreadable or malformed one is reported. History spilled
+// after the last save is ignored on the next load.
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include "TestSupport.h"
+#include "../utils/FileHandler.h"
+
+namespace {
+    using TestSupport::units;
+    
+    const char* DIRECTORY = "test_data_load";
+    
+    void testParallelLoad() {
+        FileHandler fileHandler(DIRECTORY);
+        SymbolId symbol = SymbolTable::instance().intern("LOAD");
+        
+        std::vector<std::unique_ptr<Trader>> saved;
+        std::vector<Trader*> traders;
+        for (int i = 0; i < 40; i++) {
+            Trader writer("load" + std::to_string(i), "pw", units(1000 + i));
+            writer.getPortfolio().buyStock(symbol, i + 1, units(1));
+            CHECK(fileHandler.savePortfolio(writer));
+            
+            saved.emplace_back(new Trader(writer.getUsername(), "pw"));
+            traders.push_back(saved.back().get());
+        }
+        Trader unsaved("load_unsaved", "pw", units(5));
+        traders.push_back(&unsaved);
+        Trader broken("load_broken", "pw");
+        std::ofstream(std::string(DIRECTORY) + "/portfolio_load_broken.txt").close();
+        traders.push_back(&broken);
+        
+        // Numbers the parser cannot read fail that file, not the whole load
+        Trader corrupt("load_corrupt", "pw", units(7));
+        std::ofstream(std::string(DIRECTORY) + "/portfolio_load_corrupt.txt")
+            << "load_corrupt|1000.0000|two|LOAD,x,1.0000;|1,0|" << std::endl;
+        traders.push_back(&corrupt);
+        
+        std::vector<Trader*> failed;
+        CHECK(fileHandler.readPortfolios(traders, failed) == 40);
+        CHECK(failed.size() == 2 && failed[0] == &broken && failed[1] == &corrupt);
+        CHECK(corrupt.getPortfolio().getCashBalance() == units(7));
+        for (int i = 0; i < 40; i++) {
+            const Portfolio& portfolio = saved[i]->getPortfolio();
+            CHECK(portfolio.getPosition(symbol) && portfolio.getPosition(symbol)->quantity == i + 1);
+            CHECK(portfolio.getCashBalance() == units(1000 + i) - units(i + 1));
+        }
+        CHECK(unsaved.getPortfolio().getCashBalance() == units(5));
+        
+        for (Trader* trader : traders) {
+            std::remove((std::string(DIRECTORY) + "/portfolio_" + trader->getUsername() + ".txt").c_str());
+        }
+        std::remove(DIRECTORY);
+    }
+    
+    // Buy one share at `price` units, `count` times
+    void buyShares(Portfolio& portfolio, SymbolId symbol, size_t count, int price) {
+        for (size_t i = 0; i < count; i++) {
+            portfolio.buyStock(symbol, 1, units(price));
+        }
+    }
+    
+    void testSpillAfterSave() {
+        FileHandler fileHandler(DIRECTORY);
+        SymbolId symbol = SymbolTable::instance().intern("LOAD");
+        const size_t SEGMENT = TransactionLog::SEGMENT_SIZE;
+        std::string username = "load_spill";
+        
+        Trader writer(username, "pw", units(1000000));
+        CHECK(fileHandler.loadPortfolio(writer));
+        buyShares(writer.getPortfolio(), symbol, SEGMENT + 10, 1);
+        CHECK(fileHandler.savePortfolio(writer));
+        
+        // A second segment spills, then the process dies before saving
+        buyShares(writer.getPortfolio(), symbol, SEGMENT, 2);
+        CHECK(writer.getPortfolio().getTransactionHistory().getSpilledSize() == 2 * SEGMENT);
+        
+        Trader reader(username, "pw");
+        CHECK(fileHandler.loadPortfolio(reader));
+        const TransactionLog& history = reader.getPortfolio().getTransactionHistory();
+        CHECK(history.size() == SEGMENT + 10);
+        CHECK(reader.getPortfolio().getPosition(symbol)->quantity == static_cast<int>(SEGMENT + 10));
+        
+        // The next spill overwrites the stale segment
+        buyShares(reader.getPortfolio(), symbol, SEGMENT, 3);
+        CHECK(fileHandler.savePortfolio(reader));
+        Trader again(username, "pw");
+        CHECK(fileHandler.loadPortfolio(again));
+        std::vector<Transaction> records;
+        CHECK(again.getPortfolio().getTransactionHistory().read(0, 3 * SEGMENT, records) == 2 * SEGMENT + 10);
+        CHECK(records.size() == 2 * SEGMENT + 10);
+        CHECK(records[SEGMENT + 9].price == units(1));
+        CHECK(records[SEGMENT + 10].price == units(3));
+        CHECK(records.back().price == units(3));
+        
+        std::remove((std::string(DIRECTORY) + "/portfolio_" + username + ".txt").c_str());
+        std::string spillFile = std::string(DIRECTORY) + "/history_" + username + ".log";
+        std::remove(spillFile.c_str());
+        std::remove((spillFile + ".idx").c_str());
+        std::remove((spillFile + ".symbols").c_str());
+        std::remove(DIRECTORY);
+    }
+}
+
+int main() {
+    TestSupport::quietConsole();
+    testParallelLoad();
+    testSpillAfterSave();
+    return TEST_RESULT("PortfolioLoadTest");
+}
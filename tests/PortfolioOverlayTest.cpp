@@ -0,0 +1,121 @@
+// What-if overlays follow the base portfolio's rules, lots included, and
+// a previewed batch projects what executing it does
+#include <vector>
+#include "TestSupport.h"
+#include "../models/PortfolioOverlay.h"
+#include "../services/TradingEngine.h"
+
+namespace {
+    using TestSupport::units;
+    
+    // The same sales on an overlay and on a copy of its base agree
+    void checkSales(LotMethod method) {
+        SymbolId symbol = SymbolTable::instance().intern("OVL");
+        Portfolio base("base", units(10000));
+        base.setLotMethod(method);
+        base.buyStock(symbol, 10, units(100));
+        base.buyStock(symbol, 10, units(120));
+        Money baseCash = base.getCashBalance();
+        
+        PortfolioOverlay overlay(base);
+        Portfolio reference = base;
+        CHECK(overlay.sellStock(symbol, 15, units(130)));
+        CHECK(reference.sellStock(symbol, 15, units(130)));
+        CHECK(overlay.buyStock(symbol, 5, units(90)));
+        CHECK(reference.buyStock(symbol, 5, units(90)));
+        CHECK(overlay.sellStock(symbol, 7, units(110)));
+        CHECK(reference.sellStock(symbol, 7, units(110)));
+        
+        CHECK(overlay.getPosition(symbol)->quantity == reference.getPosition(symbol)->quantity);
+        CHECK(overlay.getPosition(symbol)->averagePrice == reference.getPosition(symbol)->averagePrice);
+        CHECK(overlay.getRealizedProfitLoss() == reference.getRealizedProfitLoss());
+        CHECK(overlay.getCashBalance() == reference.getCashBalance());
+        CHECK(overlay.getTotalValue() == reference.getTotalValue());
+        
+        // Closing and reopening starts a fresh lot, as in the base
+        CHECK(overlay.sellStock(symbol, 3, units(100)));
+        CHECK(reference.sellStock(symbol, 3, units(100)));
+        CHECK(!overlay.getPosition(symbol));
+        CHECK(overlay.buyStock(symbol, 2, units(80)));
+        CHECK(reference.buyStock(symbol, 2, units(80)));
+        CHECK(overlay.getPosition(symbol)->averagePrice == units(80));
+        CHECK(overlay.getRealizedProfitLoss() == reference.getRealizedProfitLoss());
+        
+        // The base never changes
+        CHECK(base.getPosition(symbol)->quantity == 20);
+        CHECK(base.getCashBalance() == baseCash);
+        CHECK(base.getRealizedProfitLoss() == 0);
+    }
+    
+    void testReservations() {
+        TradingEngine engine;
+        SymbolId symbol = TestSupport::listStock(engine, "OVR", units(100));
+        
+        Portfolio base("reserved", units(10000));
+        BuyOrder buy(symbol, 30, units(100));
+        CHECK(engine.executeOrder(&buy, base));
+        
+        // A resting bid and a resting offer hold cash and shares; the
+        // sale below brings the available cash to 4400
+        BuyOrder bid(symbol, 40, units(90));
+        CHECK(engine.executeOrder(&bid, base));
+        SellOrder offer(symbol, 20, units(105));
+        CHECK(engine.executeOrder(&offer, base));
+        
+        PortfolioOverlay overlay(base);
+        CHECK(overlay.getAvailableCash() == base.getAvailableCash());
+        CHECK(!overlay.sellStock(symbol, 11, units(100)));
+        CHECK(overlay.sellStock(symbol, 10, units(100)));
+        CHECK(!overlay.buyStock(symbol, 45, units(100)));
+    }
+    
+    void testPreview() {
+        TradingEngine engine;
+        SymbolId a = TestSupport::listStock(engine, "OVA", units(50));
+        SymbolId b = TestSupport::listStock(engine, "OVB", units(200));
+        SymbolId unlisted = SymbolTable::instance().intern("OVX");
+        
+        Portfolio portfolio("preview", units(5000));
+        BuyOrder opening(a, 40, units(50));
+        CHECK(engine.executeOrder(&opening, portfolio));
+        
+        OrderPool pool;
+        std::vector<OrderPtr> signals;
+        signals.push_back(pool.createSell(a, 25, units(50)));   // Fills
+        signals.push_back(pool.createBuy(b, 10, units(200)));   // Fills
+        signals.push_back(pool.createBuy(b, 10, units(200)));   // The sale's cash is not counted
+        signals.push_back(pool.createSell(a, 20, units(50)));   // Only 15 left uncommitted
+        signals.push_back(pool.createBuy(a, 5, units(48)));     // Rests
+        signals.push_back(pool.createBuy(unlisted, 1, units(1)));
+        
+        PortfolioOverlay projected(portfolio);
+        std::vector<ExecutionResult> preview;
+        CHECK(engine.previewBatch(signals, projected, preview) == 2);
+        CHECK(portfolio.getPosition(a)->quantity == 40);
+        
+        std::vector<ExecutionResult> results;
+        CHECK(engine.executeBatch(signals, portfolio, results) == 2);
+        for (size_t i = 0; i < signals.size(); i++) {
+            CHECK(preview[i].error == results[i].error);
+            CHECK(preview[i].filledQuantity == results[i].filledQuantity);
+            CHECK(preview[i].restingQuantity == results[i].restingQuantity);
+        }
+        CHECK(preview[2].error == ExecutionError::InsufficientFunds);
+        CHECK(preview[3].error == ExecutionError::InsufficientShares);
+        CHECK(preview[5].error == ExecutionError::UnknownSymbol);
+        
+        CHECK(projected.getCashBalance() == portfolio.getCashBalance());
+        CHECK(projected.getRealizedProfitLoss() == portfolio.getRealizedProfitLoss());
+        CHECK(projected.getPosition(a)->quantity == portfolio.getPosition(a)->quantity);
+        CHECK(projected.getPosition(b)->quantity == portfolio.getPosition(b)->quantity);
+    }
+}
+
+int main() {
+    TestSupport::quietConsole();
+    checkSales(LotMethod::Fifo);
+    checkSales(LotMethod::Lifo);
+    testReservations();
+    testPreview();
+    return TEST_RESULT("PortfolioOverlayTest");
+}
@@ -0,0 +1,59 @@
+// Risk limits belong to the portfolio, survive detaching and
+// re-attaching, and round-trip through their saved form
+#include "TestSupport.h"
+#include "../services/TradingEngine.h"
+
+namespace {
+    using TestSupport::units;
+    
+    void testLimitsFollowPortfolio() {
+        TradingEngine engine;
+        SymbolId symbol = TestSupport::listStock(engine, "LIM", units(100));
+        
+        Portfolio capped("capped", units(100000));
+        Portfolio open("open", units(100000));
+        RiskLimits limits = RiskLimits::defaults();
+        limits.maxPosition = 10;
+        
+        // Set before the portfolio ever attaches
+        engine.setRiskLimits(capped, limits);
+        CHECK(engine.hasRiskLimits(capped));
+        CHECK(!engine.hasRiskLimits(open));
+        
+        BuyOrder tooMany(symbol, 11, units(100));
+        CHECK(!engine.executeOrder(&tooMany, capped));
+        BuyOrder allowed(symbol, 11, units(100));
+        CHECK(engine.executeOrder(&allowed, open));
+        
+        // Re-attaching, even into a reused owner id, keeps each one's limits
+        uint32_t owner = capped.getAccountId();
+        CHECK(owner != Portfolio::NO_ACCOUNT);
+        engine.detachAccount(capped);
+        CHECK(capped.getAccountId() == Portfolio::NO_ACCOUNT);
+        engine.detachAccount(open);
+        engine.watchPortfolio(open);
+        engine.watchPortfolio(capped);
+        CHECK(capped.getAccountId() != Portfolio::NO_ACCOUNT);
+        
+        BuyOrder stillTooMany(symbol, 11, units(100));
+        CHECK(!engine.executeOrder(&stillTooMany, capped));
+        BuyOrder stillAllowed(symbol, 11, units(100));
+        CHECK(engine.executeOrder(&stillAllowed, open));
+        
+        // Saved and loaded limits match; clearing returns to the defaults
+        TradingEngine reloaded;
+        reloaded.deserializeRiskLimits(engine.serializeRiskLimits());
+        CHECK(reloaded.getRiskLimits(capped).maxPosition == 10);
+        CHECK(reloaded.getRiskLimits(capped).maxOrderNotional == limits.maxOrderNotional);
+        engine.clearRiskLimits(capped);
+        CHECK(engine.getRiskLimits(capped).maxPosition == RiskLimits::defaults().maxPosition);
+        BuyOrder afterClear(symbol, 11, units(100));
+        CHECK(engine.executeOrder(&afterClear, capped));
+    }
+}
+
+int main() {
+    TestSupport::quietConsole();
+    testLimitsFollowPortfolio();
+    return TEST_RESULT("RiskLimitsTest");
+}
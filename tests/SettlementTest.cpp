@@ -0,0 +1,213 @@
+// Resting orders reserve what they need to settle, and every fill settles
+// both legs or neither
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "TestSupport.h"
+#include "../services/TradingEngine.h"
+
+namespace {
+    struct Placed {
+        size_t account;
+        SymbolId symbol;
+        uint64_t orderId;
+        OrderSide side;
+        Price price;
+    };
+    
+    using TestSupport::units;
+    
+    void testReservations() {
+        TradingEngine engine;
+        SymbolId symbol = TestSupport::listStock(engine, "RSV", units(100));
+        
+        Portfolio buyer("buyer", units(10000));
+        Portfolio seller("seller", units(20000));
+        
+        // A bid below the market rests and holds its notional
+        BuyOrder bid(symbol, 50, units(95));
+        CHECK(engine.executeOrder(&bid, buyer));
+        CHECK(buyer.getReservedCash() == units(4750));
+        CHECK(buyer.getAvailableCash() == units(5250));
+        
+        BuyOrder tooLarge(symbol, 60, units(100));
+        CHECK(!engine.executeOrder(&tooLarge, buyer));
+        CHECK(buyer.getCashBalance() == units(10000));
+        
+        // Selling into the bid settles both sides at the bid
+        BuyOrder stock(symbol, 100, units(100));
+        CHECK(engine.executeOrder(&stock, seller));
+        SellOrder hit(symbol, 30, units(95));
+        CHECK(engine.executeOrder(&hit, seller));
+        CHECK(buyer.getPosition(symbol) && buyer.getPosition(symbol)->quantity == 30);
+        CHECK(buyer.getCashBalance() == units(10000 - 2850));
+        CHECK(buyer.getReservedCash() == units(20 * 95));
+        CHECK(seller.getCashBalance() == units(20000 - 10000 + 2850));
+        
+        // An offer above the market rests and holds its shares
+        SellOrder offer(symbol, 60, units(110));
+        CHECK(engine.executeOrder(&offer, seller));
+        CHECK(seller.getAvailableShares(symbol) == 10);
+        SellOrder oversell(symbol, 20, units(100));
+        CHECK(!engine.executeOrder(&oversell, seller));
+        
+        CHECK(engine.amendOrder(symbol, offer.getId(), 40, seller));
+        CHECK(seller.getAvailableShares(symbol) == 30);
+        CHECK(engine.cancelOrder(symbol, offer.getId(), seller));
+        CHECK(seller.getAvailableShares(symbol) == 70);
+        
+        engine.detachAccount(buyer);
+        CHECK(buyer.getReservedCash() == 0);
+        CHECK(buyer.getCashBalance() == units(10000 - 2850));
+    }
+    
+    void testOwnershipAndReplace() {
+        TradingEngine engine;
+        SymbolId symbol = TestSupport::listStock(engine, "RPL", units(100));
+        
+        Portfolio owner("owner", units(10000));
+        Portfolio other("other", units(10000));
+        engine.watchPortfolio(other);
+        
+        BuyOrder bid(symbol, 50, units(90));
+        CHECK(engine.executeOrder(&bid, owner));
+        CHECK(!engine.cancelOrder(symbol, bid.getId(), other));
+        CHECK(!engine.amendOrder(symbol, bid.getId(), 10, other));
+        BuyOrder stolen(symbol, 10, units(91));
+        CHECK(!engine.replaceOrder(symbol, bid.getId(), &stolen, other));
+        CHECK(engine.findBook(symbol)->getRestingQuantity(bid.getId()) == 50);
+        
+        // A replacement the cash cannot cover leaves the original in place
+        BuyOrder tooLarge(symbol, 200, units(90));
+        CHECK(!engine.replaceOrder(symbol, bid.getId(), &tooLarge, owner));
+        CHECK(engine.findBook(symbol)->getRestingQuantity(bid.getId()) == 50);
+        CHECK(owner.getReservedCash() == units(4500));
+        
+        // The original's reservation counts toward the replacement
+        BuyOrder larger(symbol, 110, units(90));
+        CHECK(engine.replaceOrder(symbol, bid.getId(), &larger, owner));
+        CHECK(!engine.findBook(symbol)->isResting(bid.getId()));
+        CHECK(owner.getReservedCash() == units(9900));
+    }
+    
+    // Passes at most `budget` shares in total
+    class BudgetGate : public FillGate {
+    public:
+        int32_t budget;
+        
+        explicit BudgetGate(int32_t budget) : budget(budget) {}
+        
+        int32_t allowFill(SymbolId, OrderSide, uint32_t, Price, int32_t quantity) override {
+            int32_t allowed = std::min(quantity, budget);
+            budget -= allowed;
+            return allowed;
+        }
+    };
+    
+    void testGateKeepsMaker() {
+        OrderBook book(SymbolTable::instance().intern("GTE"));
+        std::vector<OrderBook::Fill> fills;
+        book.submit(1, OrderSide::Sell, units(104), 100, 1, true, fills);
+        book.submit(2, OrderSide::Sell, units(105), 100, 2, true, fills);
+        
+        // A fill the gate refuses leaves the maker's order whole
+        BudgetGate none(0);
+        CHECK(book.submit(3, OrderSide::Buy, OrderBook::marketLimit(OrderSide::Buy), 10, 0, false,
+                          fills, &none) == 10);
+        CHECK(fills.empty());
+        CHECK(book.getRestingQuantity(1) == 100);
+        
+        // A fill cut short stops the match there
+        BudgetGate some(100);
+        CHECK(book.submit(4, OrderSide::Buy, OrderBook::marketLimit(OrderSide::Buy), 150, 0, false,
+                          fills, &some) == 50);
+        CHECK(fills.size() == 1 && fills[0].quantity == 100);
+        fills.clear();
+        BudgetGate part(30);
+        CHECK(book.submit(5, OrderSide::Buy, OrderBook::marketLimit(OrderSide::Buy), 50, 0, false,
+                          fills, &part) == 20);
+        CHECK(fills.size() == 1 && fills[0].quantity == 30);
+        CHECK(book.getRestingQuantity(2) == 70);
+    }
+    
+    void testRandomFlow() {
+        const size_t ACCOUNTS = 12;
+        const int SYMBOLS = 3;
+        
+        TradingEngine engine;
+        std::vector<SymbolId> symbols;
+        for (int i = 0; i < SYMBOLS; i++) {
+            symbols.push_back(TestSupport::listStock(engine, "RSV" + std::to_string(i), units(100)));
+        }
+        
+        std::vector<Portfolio> accounts;
+        for (size_t i = 0; i < ACCOUNTS; i++) {
+            accounts.push_back(Portfolio("acct" + std::to_string(i), units(20000)));
+        }
+        std::vector<Placed> placed;
+        std::mt19937 rng(17);
+        
+        for (int step = 0; step < 20000; step++) {
+            size_t account = rng() % ACCOUNTS;
+            SymbolId symbol = symbols[rng() % SYMBOLS];
+            Price price = units(90) + static_cast<Price>(rng() % 2000) * FixedPoint::TICKS_PER_UNIT / 100;
+            int quantity = 1 + static_cast<int>(rng() % 40);
+            int action = static_cast<int>(rng() % 10);
+            
+            if (action < 4) {
+                BuyOrder order(symbol, quantity, price);
+                engine.executeOrder(&order, accounts[account]);
+                placed.push_back({account, symbol, order.getId(), OrderSide::Buy, price});
+            } else if (action < 8) {
+                SellOrder order(symbol, quantity, price);
+                engine.executeOrder(&order, accounts[account]);
+                placed.push_back({account, symbol, order.getId(), OrderSide::Sell, price});
+            } else if (action < 9 && !placed.empty()) {
+                const Placed& victim = placed[rng() % placed.size()];
+                engine.cancelOrder(victim.symbol, victim.orderId, accounts[victim.account]);
+            } else {
+                engine.updateStockPrice(symbol, price);
+            }
+        }
+        
+        // Every account's reservations match what it has resting in the books
+        std::vector<Money> restingCash(ACCOUNTS, 0);
+        std::vector<std::vector<int>> restingShares(ACCOUNTS, std::vector<int>(symbols.back() + 1, 0));
+        for (const Placed& order : placed) {
+            const OrderBook* book = engine.findBook(order.symbol);
+            int32_t open = book ? book->getRestingQuantity(order.orderId) : 0;
+            if (order.side == OrderSide::Buy) {
+                restingCash[order.account] += FixedPoint::notional(order.price, open);
+            } else {
+                restingShares[order.account][order.symbol] += open;
+            }
+        }
+        for (size_t i = 0; i < ACCOUNTS; i++) {
+            CHECK(accounts[i].getReservedCash() == restingCash[i]);
+            CHECK(accounts[i].getAvailableCash() >= 0);
+            for (SymbolId symbol : symbols) {
+                const Position* pos = accounts[i].getPosition(symbol);
+                CHECK((pos ? pos->reserved : 0) == restingShares[i][symbol]);
+                CHECK(accounts[i].getAvailableShares(symbol) >= 0);
+            }
+        }
+        
+        for (Portfolio& account : accounts) {
+            engine.detachAccount(account);
+            CHECK(account.getReservedCash() == 0);
+            for (SymbolId symbol : symbols) {
+                CHECK(account.getAvailableShares(symbol) ==
+                      (account.getPosition(symbol) ? account.getPosition(symbol)->quantity : 0));
+            }
+        }
+    }
+}
+
+int main() {
+    TestSupport::quietConsole();
+    testReservations();
+    testOwnershipAndReplace();
+    testGateKeepsMaker();
+    testRandomFlow();
+    return TEST_RESULT("SettlementTest");
+}
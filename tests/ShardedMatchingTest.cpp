@@ -0,0 +1,97 @@
+// The sharded engine matches exactly like one OrderBook per symbol, for
+// any shard count, and parked workers wake for new commands
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TestSupport.h"
+#include "../services/ShardedMatchingEngine.h"
+
+namespace {
+    const int SYMBOLS = 8;
+    
+    std::vector<OrderRecord> makeStream(const std::vector<SymbolId>& symbols, size_t count,
+                                        uint64_t firstId) {
+        std::mt19937 rng(static_cast<unsigned>(firstId));
+        std::vector<OrderRecord> stream(count, OrderRecord());
+        for (size_t i = 0; i < count; i++) {
+            OrderRecord& order = stream[i];
+            order.orderId = firstId + i;
+            order.symbolId = symbols[rng() % symbols.size()];
+            order.side = (rng() & 1) ? OrderSide::Buy : OrderSide::Sell;
+            order.price = FixedPoint::fromUnits(100) + static_cast<Price>(rng() % 10) * 100 - 500;
+            order.quantity = 1 + static_cast<int32_t>(rng() % 50);
+        }
+        return stream;
+    }
+    
+    void testMatchesReference(size_t shardCount) {
+        std::vector<std::string> tickers;
+        std::vector<SymbolId> symbols;
+        for (int i = 0; i < SYMBOLS; i++) {
+            tickers.push_back("SMT" + std::to_string(i));
+            symbols.push_back(SymbolTable::instance().intern(tickers.back()));
+        }
+        std::vector<OrderRecord> first = makeStream(symbols, 20000, 1);
+        std::vector<OrderRecord> second = makeStream(symbols, 20000, 100000);
+        
+        std::vector<std::unique_ptr<OrderBook>> reference(symbols.back() + 1);
+        for (SymbolId symbol : symbols) {
+            reference[symbol].reset(new OrderBook(symbol));
+        }
+        std::vector<OrderBook::Fill> fills;
+        uint64_t referenceTrades = 0;
+        
+        ShardedMatchingEngine engine(shardCount, 1024, true);
+        for (const std::string& ticker : tickers) {
+            CHECK(engine.addSymbol(Stock(ticker, ticker, FixedPoint::fromUnits(100))));
+        }
+        CHECK(engine.getShardCount() == shardCount);
+        engine.start();
+        
+        std::vector<TradeEvent> trades;
+        for (const std::vector<OrderRecord>* stream : {&first, &second}) {
+            for (const OrderRecord& order : *stream) {
+                fills.clear();
+                reference[order.symbolId]->submit(order.orderId, order.side, order.price,
+                                                  order.quantity, OrderBook::NONE, true, fills);
+                referenceTrades += fills.size();
+                CHECK(engine.submit(order));
+                engine.pollTrades(trades);
+                
+                // Every tenth order is cut back, every seventh cancelled
+                if (order.orderId % 10 == 0) {
+                    reference[order.symbolId]->amend(order.orderId - 5, 1);
+                    engine.amend(order.symbolId, order.orderId - 5, 1);
+                } else if (order.orderId % 7 == 0) {
+                    reference[order.symbolId]->cancel(order.orderId - 3);
+                    engine.cancel(order.symbolId, order.orderId - 3);
+                }
+            }
+            engine.waitIdle();
+            
+            // Idle long enough for every worker to park; the second stream
+            // has to wake them
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        engine.stop();
+        engine.pollTrades(trades);
+        
+        CHECK(engine.getTradeCount() == referenceTrades);
+        CHECK(trades.size() == referenceTrades);
+        for (SymbolId symbol : symbols) {
+            const OrderBook& book = *engine.findBook(symbol);
+            CHECK(book.getRestingOrderCount() == reference[symbol]->getRestingOrderCount());
+            CHECK(book.getBestBid() == reference[symbol]->getBestBid());
+            CHECK(book.getBestAsk() == reference[symbol]->getBestAsk());
+        }
+    }
+}
+
+int main() {
+    TestSupport::quietConsole();
+    testMatchesReference(1);
+    testMatchesReference(3);
+    return TEST_RESULT("ShardedMatchingTest");
+}
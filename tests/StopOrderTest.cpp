@@ -0,0 +1,138 @@
+// Stops are listed and cancelled per owner, and triggered stops are
+// queued until drained
+#include <vector>
+#include "TestSupport.h"
+#include "../services/TradingEngine.h"
+
+namespace {
+    using TestSupport::units;
+    
+    void testOwnershipAndDrain() {
+        TradingEngine engine;
+        SymbolId symbol = TestSupport::listStock(engine, "STP", units(100));
+        
+        Portfolio owner("owner", units(100000));
+        Portfolio other("other", units(100000));
+        BuyOrder stock(symbol, 20, units(100));
+        CHECK(engine.executeOrder(&stock, owner));
+        engine.watchPortfolio(other);
+        
+        SellOrder stop(symbol, 10, units(100));
+        CHECK(engine.placeStopOrder(&stop, owner, StopType::Stop, units(95)));
+        SellOrder trailing(symbol, 10, units(100));
+        CHECK(engine.placeTrailingStop(&trailing, owner, units(5)));
+        
+        std::vector<StopIndex::StopOrder> stops;
+        CHECK(engine.getStopOrders(owner, stops) == 2);
+        CHECK(engine.getStopOrders(other, stops) == 0);
+        
+        // Only the owner can cancel
+        CHECK(!engine.cancelStopOrder(symbol, stop.getId(), other));
+        CHECK(engine.cancelStopOrder(symbol, stop.getId(), owner));
+        
+        // The trailing stop follows 110 up, then fires on the way back to 104
+        engine.updateStockPrice(symbol, units(110));
+        stops.clear();
+        CHECK(engine.getStopOrders(owner, stops) == 1);
+        CHECK(!stops.empty() && stops[0].stopPrice == units(105));
+        engine.updateStockPrice(symbol, units(104));
+        
+        std::vector<ExecutionResult> executions;
+        CHECK(engine.drainStopExecutions(executions) == 1);
+        CHECK(!executions.empty() && executions[0].filledQuantity == 10);
+        CHECK(engine.drainStopExecutions(executions) == 0);
+        CHECK(owner.getPosition(symbol) && owner.getPosition(symbol)->quantity == 10);
+    }
+    
+    void testTriggeredBuyIsCapped() {
+        TradingEngine engine;
+        SymbolId symbol = TestSupport::listStock(engine, "STC", units(100));
+        Price half = FixedPoint::TICKS_PER_UNIT / 2;
+        
+        Portfolio maker("maker", units(100000));
+        BuyOrder stock(symbol, 105, units(100));
+        CHECK(engine.executeOrder(&stock, maker));
+        SellOrder near(symbol, 5, units(102) + half);
+        CHECK(engine.executeOrder(&near, maker));
+        SellOrder far(symbol, 100, units(104));
+        CHECK(engine.executeOrder(&far, maker));
+        
+        // $1030 pays for 10 shares at up to $103, so the stop takes the $102.50
+        // offer and the rest at the market, leaving the $104 offer alone
+        Portfolio taker("taker", units(1030));
+        BuyOrder stop(symbol, 10, units(101));
+        CHECK(engine.placeStopOrder(&stop, taker, StopType::Stop, units(101)));
+        engine.updateStockPrice(symbol, units(102));
+        
+        std::vector<ExecutionResult> executions;
+        CHECK(engine.drainStopExecutions(executions) == 1);
+        CHECK(!executions.empty() && executions[0].filledQuantity == 10);
+        CHECK(!executions.empty() && executions[0].status == OrderStatus::Executed);
+        CHECK(!executions.empty() && executions[0].error == ExecutionError::None);
+        CHECK(taker.getCashBalance() == units(1030 - 510 - 510) - 5 * half);
+        CHECK(!engine.findBook(symbol)->isResting(near.getId()));
+        CHECK(engine.findBook(symbol)->getRestingQuantity(far.getId()) == 100);
+        CHECK(maker.getPosition(symbol) && maker.getPosition(symbol)->quantity == 100);
+        CHECK(maker.getAvailableShares(symbol) == 0);
+    }
+    
+    // Trailing groups that trigger or are cancelled do not stay behind
+    void testEmptyGroupsRetire() {
+        StopIndex index(SymbolTable::instance().intern("STG"));
+        std::vector<StopIndex::StopOrder> triggered;
+        
+        // A falling price opens a group per sell placed at each new low
+        StopIndex::StopOrder stop = StopIndex::StopOrder();
+        stop.order.side = OrderSide::Sell;
+        stop.order.quantity = 1;
+        stop.type = StopType::TrailingStop;
+        stop.owner = 0;
+        for (int i = 0; i < 1000; i++) {
+            stop.order.orderId = 1 + i;
+            stop.trailAmount = (i % 2 == 0) ? units(5000) : units(1);
+            index.add(stop, units(20000 - i));
+        }
+        CHECK(index.getTrailGroupCount() == 1000);
+        
+        // Cancelling every other one leaves groups that still hold a stop
+        for (int i = 0; i < 1000; i += 2) {
+            CHECK(index.cancel(1 + i));
+        }
+        CHECK(index.getTrailGroupCount() <= 1000);
+        
+        // The tight trails fire on a bounce back down, emptying the rest
+        index.onPrice(units(10000), triggered);
+        CHECK(triggered.size() == 500);
+        CHECK(index.empty());
+        CHECK(index.getTrailGroupCount() == 0);
+        
+        // Place and cancel at new lows; the stack does not grow with them
+        for (int i = 0; i < 1000; i++) {
+            stop.order.orderId = 2000 + i;
+            index.add(stop, units(9000 - i));
+            CHECK(index.cancel(2000 + i));
+        }
+        CHECK(index.getTrailGroupCount() == 0);
+        
+        // Groups emptied beneath a live one are compacted away
+        stop.trailAmount = units(5000);
+        for (int i = 0; i <= 10; i++) {
+            stop.order.orderId = 5000 + i;
+            index.add(stop, units(8000 - i));
+        }
+        CHECK(index.getTrailGroupCount() == 11);
+        for (int i = 0; i < 10; i++) {
+            CHECK(index.cancel(5000 + i));
+            CHECK(index.getTrailGroupCount() <= 2 * index.size());
+        }
+        CHECK(index.getTrailGroupCount() <= 2);
+    }
+}
+
+int main() {
+    TestSupport::quietConsole();
+    testOwnershipAndDrain();
+    testTriggeredBuyIsCapped();
+    testEmptyGroupsRetire();
+    return TEST_RESULT("StopOrderTest");
+}
@@ -0,0 +1,47 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <iostream>
+#include <string>
+#include "../services/TradingEngine.h"
+
+// Minimal checks for the programs under tests/ and bench/: a failed
+// CHECK is reported with its line and counted, and TEST_RESULT() turns the
+// count into the exit status `make test` looks at.
+namespace TestSupport {
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+    
+    // The engine reports to std::cout; tests only want their own output
+    inline void quietConsole() {
+        std::cout.setstate(std::ios::failbit);
+    }
+    
+    inline Price units(int dollars) {
+        return FixedPoint::fromUnits(dollars);
+    }
+    
+    // Lists `ticker` at `price` and returns its id
+    inline SymbolId listStock(TradingEngine& engine, const std::string& ticker, Price price) {
+        engine.addStock(Stock(ticker, ticker + " Test", price));
+        return SymbolTable::instance().find(ticker);
+    }
+}
+
+#define CHECK(condition)                                                        \
+    do {                                                                        \
+        if (!(condition)) {                                                     \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition   \
+                      << ") failed" << std::endl;                               \
+            TestSupport::failures()++;                                          \
+        }                                                                       \
+    } while (0)
+
+#define TEST_RESULT(name)                                                       \
+    (std::cerr << (TestSupport::failures() == 0 ? "PASS " : "FAIL ") << (name)  \
+               << std::endl,                                                    \
+     TestSupport::failures() == 0 ? 0 : 1)
+
+#endif
@@ -0,0 +1,155 @@
+// History queries by symbol and time match a full scan across spilled and
+// resident segments, after a reattach reads the index file, and after a
+// lost index block is rebuilt from the spill file. Spilled bytes depend
+// only on the records.
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include "TestSupport.h"
+#include "../models/TransactionLog.h"
+
+namespace {
+    const char* PATH = "test_history.log";
+    const char* TICKERS[] = {"TLA", "TLB", "TLC", "TLD", "TLE", "TLR"};
+    const size_t SYMBOLS = 6;
+    
+    // Deterministic record `i`: three per second, symbols spread unevenly,
+    // with the last ticker only in the third segment
+    Transaction record(size_t i) {
+        unsigned mix = static_cast<unsigned>(i) * 2654435761u;
+        bool rare = i / TransactionLog::SEGMENT_SIZE == 2 && i % 500 == 7;
+        Transaction txn(mix & 1 ? OrderSide::Sell : OrderSide::Buy,
+                        SymbolTable::instance().intern(TICKERS[rare ? 5 : (mix >> 3) % 5]),
+                        1 + static_cast<int>(i % 50), FixedPoint::fromUnits(1 + static_cast<int>(i % 97)));
+        txn.timestamp = 1000 + static_cast<int64_t>(i / 3);
+        return txn;
+    }
+    
+    void removeFiles() {
+        std::remove(PATH);
+        std::remove((std::string(PATH) + ".idx").c_str());
+        std::remove((std::string(PATH) + ".symbols").c_str());
+    }
+    
+    bool sameRecords(const std::vector<Transaction>& a, const std::vector<Transaction>& b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].symbolId != b[i].symbolId || a[i].timestamp != b[i].timestamp ||
+                a[i].price != b[i].price || a[i].quantity != b[i].quantity) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Every symbol over a spread of ranges, against a scan of the whole log
+    void checkQueries(const TransactionLog& log) {
+        std::vector<Transaction> all;
+        log.read(0, log.size(), all);
+        
+        int64_t last = all.back().timestamp;
+        for (int64_t from = 900; from <= last; from += 1237) {
+            for (size_t s = 0; s <= SYMBOLS; s++) {
+                SymbolId symbol = s < SYMBOLS ? SymbolTable::instance().find(TICKERS[s]) : INVALID_SYMBOL;
+                int64_t to = from + 2000;
+                
+                std::vector<Transaction> found, expected;
+                log.query(symbol, from, to, found);
+                for (const Transaction& txn : all) {
+                    if (txn.timestamp >= from && txn.timestamp <= to &&
+                        (symbol == INVALID_SYMBOL || txn.symbolId == symbol)) {
+                        expected.push_back(txn);
+                    }
+                }
+                CHECK(sameRecords(found, expected));
+            }
+        }
+        
+        size_t expected = 0;
+        for (const Transaction& txn : all) {
+            if (txn.symbolId == SymbolTable::instance().find(TICKERS[5])) expected++;
+        }
+        std::vector<Transaction> rare;
+        CHECK(expected > 0);
+        CHECK(log.query(SymbolTable::instance().find(TICKERS[5]), 0, INT64_MAX, rare) == expected);
+    }
+    
+    void testQueries() {
+        removeFiles();
+        const size_t COUNT = 5 * TransactionLog::SEGMENT_SIZE + 100;
+        
+        TransactionLog writer;
+        CHECK(writer.attachSpillFile(PATH));
+        for (size_t i = 0; i < COUNT; i++) {
+            writer.append(record(i));
+        }
+        CHECK(writer.getSpilledSize() == 5 * TransactionLog::SEGMENT_SIZE);
+        checkQueries(writer);
+        
+        // Spilled segments come back from the index file
+        TransactionLog reader;
+        CHECK(reader.attachSpillFile(PATH));
+        CHECK(reader.size() == 5 * TransactionLog::SEGMENT_SIZE);
+        for (size_t i = reader.size(); i < COUNT; i++) {
+            reader.append(record(i));
+        }
+        checkQueries(reader);
+        
+        // A torn index loses its last blocks; attaching rebuilds them
+        std::ifstream index(std::string(PATH) + ".idx", std::ios::binary);
+        std::vector<char> blocks((std::istreambuf_iterator<char>(index)), std::istreambuf_iterator<char>());
+        index.close();
+        std::ofstream torn(std::string(PATH) + ".idx", std::ios::binary | std::ios::trunc);
+        torn.write(blocks.data(), blocks.size() / 2);
+        torn.close();
+        
+        TransactionLog rebuilt;
+        CHECK(rebuilt.attachSpillFile(PATH));
+        CHECK(rebuilt.size() == 5 * TransactionLog::SEGMENT_SIZE);
+        checkQueries(rebuilt);
+        
+        removeFiles();
+    }
+    
+    // The same records spill to the same bytes, with the reserved tail zero
+    void testSpillBytes() {
+        const char* OTHER = "test_history_other.log";
+        const size_t COUNT = 2 * TransactionLog::SEGMENT_SIZE;
+        std::vector<std::vector<char>> files;
+        
+        for (const char* path : {PATH, OTHER}) {
+            TransactionLog log;
+            CHECK(log.attachSpillFile(path));
+            for (size_t i = 0; i < COUNT; i++) {
+                log.append(record(i));
+            }
+            
+            std::ifstream file(path, std::ios::binary);
+            files.push_back(std::vector<char>((std::istreambuf_iterator<char>(file)),
+                                              std::istreambuf_iterator<char>()));
+            std::remove(path);
+            std::remove((std::string(path) + ".idx").c_str());
+            std::remove((std::string(path) + ".symbols").c_str());
+        }
+        
+        CHECK(files[0].size() == COUNT * sizeof(Transaction));
+        CHECK(files[0] == files[1]);
+        size_t nonzero = 0;
+        for (size_t i = 0; i + sizeof(Transaction) <= files[0].size(); i += sizeof(Transaction)) {
+            for (size_t b = offsetof(Transaction, reserved); b < sizeof(Transaction); b++) {
+                if (files[0][i + b] != 0) nonzero++;
+            }
+        }
+        CHECK(nonzero == 0);
+    }
+}
+
+int main() {
+    TestSupport::quietConsole();
+    testQueries();
+    testSpillBytes();
+    return TEST_RESULT("TransactionLogTest");
+}
@@ -1,12 +1,14 @@
 #include "FileHandler.h"
+#include "WorkStealingPool.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <stdexcept>
 #include <sys/stat.h>
 #include <sys/types.h>
 
 FileHandler::FileHandler(const std::string& dataDir)
-    : dataDirectory(dataDir) {
+    : dataDirectory(dataDir), journalSymbolCount(0), journalSymbolsLoaded(false) {
     ensureDataDirectory();
 }
 
@@ -18,10 +20,26 @@ std::string FileHandler::getStocksFilePath() const {
     return dataDirectory + "/stocks.txt";
 }
 
+std::string FileHandler::getRiskLimitsFilePath() const {
+    return dataDirectory + "/risk_limits.txt";
+}
+
 std::string FileHandler::getPortfolioFilePath(const std::string& username) const {
     return dataDirectory + "/portfolio_" + username + ".txt";
 }
 
+std::string FileHandler::getHistoryFilePath(const std::string& username) const {
+    return dataDirectory + "/history_" + username + ".log";
+}
+
+std::string FileHandler::getOrderJournalFilePath() const {
+    return dataDirectory + "/orders.journal";
+}
+
+std::string FileHandler::getJournalSymbolsFilePath() const {
+    return dataDirectory + "/orders.journal.symbols";
+}
+
 void FileHandler::ensureDataDirectory() {
     struct stat info;
     if (stat(dataDirectory.c_str(), &info) != 0) {
@@ -136,6 +154,41 @@ bool FileHandler::loadStocks(TradingEngine& engine) {
     return true;
 }
 
+bool FileHandler::saveRiskLimits(const TradingEngine& engine) {
+    std::ofstream file(getRiskLimitsFilePath());
+    
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open risk limits file for writing." << std::endl;
+        return false;
+    }
+    
+    file << engine.serializeRiskLimits();
+    file.close();
+    
+    return true;
+}
+
+bool FileHandler::loadRiskLimits(TradingEngine& engine) {
+    if (!fileExists(getRiskLimitsFilePath())) {
+        // Every trader starts on the default limits
+        return true;
+    }
+    
+    std::ifstream file(getRiskLimitsFilePath());
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open risk limits file for reading." << std::endl;
+        return false;
+    }
+    
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    file.close();
+    
+    engine.deserializeRiskLimits(buffer.str());
+    
+    return true;
+}
+
 bool FileHandler::savePortfolio(const Trader& trader) {
     std::ofstream file(getPortfolioFilePath(trader.getUsername()));
     
@@ -151,25 +204,162 @@ bool FileHandler::savePortfolio(const Trader& trader) {
 }
 
 bool FileHandler::loadPortfolio(Trader& trader) {
-    std::string filepath = getPortfolioFilePath(trader.getUsername());
+    // A new trader has no portfolio file yet
+    if (fileExists(getPortfolioFilePath(trader.getUsername())) &&
+        !readPortfolio(trader.getUsername(), trader.getPortfolio())) {
+        return false;
+    }
     
-    if (!fileExists(filepath)) {
-        // New trader, no portfolio file yet
-        return true;
+    // History saved in older files is all inline; attaching spills its
+    // sealed segments, so later saves only carry the open one
+    return trader.getPortfolio().attachHistoryFile(getHistoryFilePath(trader.getUsername()));
+}
+
+bool FileHandler::readPortfolio(const std::string& username, Portfolio& portfolio) {
+    std::ifstream file(getPortfolioFilePath(username));
+    if (!file.is_open()) {
+        return false;
     }
     
-    std::ifstream file(filepath);
+    std::string line;
+    if (!std::getline(file, line) || line.empty()) {
+        return false;
+    }
+    file.close();
+    
+    // The parser throws on malformed numbers; that only fails this file,
+    // which matters on the pool's workers, where it would end the process
+    try {
+        portfolio = Portfolio::deserialize(line);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+size_t FileHandler::readPortfolios(const std::vector<Trader*>& traders,
+                                   std::vector<Trader*>& failed) {
+    // 0 not read, 1 read, 2 no file; each task writes only its own slot
+    std::vector<uint8_t> outcome(traders.size(), 0);
+    
+    WorkStealingPool pool;
+    pool.run(traders.size(), [&](size_t task, size_t) {
+        Trader& trader = *traders[task];
+        if (!fileExists(getPortfolioFilePath(trader.getUsername()))) {
+            outcome[task] = 2;
+        } else if (readPortfolio(trader.getUsername(), trader.getPortfolio())) {
+            outcome[task] = 1;
+        }
+    });
+    
+    size_t read = 0;
+    for (size_t i = 0; i < traders.size(); i++) {
+        if (outcome[i] == 1) read++;
+        if (outcome[i] == 0) failed.push_back(traders[i]);
+    }
+    return read;
+}
+
+bool FileHandler::loadJournalSymbols(std::vector<std::string>& tickers) const {
+    std::ifstream file(getJournalSymbolsFilePath());
     if (!file.is_open()) {
-        std::cerr << "Error: Could not open portfolio file for reading." << std::endl;
         return false;
     }
     
     std::string line;
-    if (std::getline(file, line)) {
-        Portfolio portfolio = Portfolio::deserialize(line);
-        trader.getPortfolio() = portfolio;
+    while (std::getline(file, line)) {
+        if (!line.empty()) {
+            tickers.push_back(line);
+        }
+    }
+    
+    file.close();
+    return true;
+}
+
+bool FileHandler::mapJournalSymbol(SymbolId symbol, uint32_t& index) {
+    if (!journalSymbolsLoaded) {
+        std::vector<std::string> tickers;
+        loadJournalSymbols(tickers);
+        for (const std::string& ticker : tickers) {
+            SymbolId id = SymbolTable::instance().intern(ticker);
+            if (id >= journalIndex.size()) {
+                journalIndex.resize(id + 1, 0);
+            }
+            journalIndex[id] = ++journalSymbolCount;
+        }
+        journalSymbolsLoaded = true;
+    }
+    
+    if (symbol >= journalIndex.size()) {
+        journalIndex.resize(symbol + 1, 0);
+    }
+    if (journalIndex[symbol] == 0) {
+        std::ofstream file(getJournalSymbolsFilePath(), std::ios::app);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open order journal symbols for writing." << std::endl;
+            return false;
+        }
+        file << SymbolTable::instance().name(symbol) << std::endl;
+        if (!file) {
+            std::cerr << "Error: Could not write order journal symbols." << std::endl;
+            return false;
+        }
+        journalIndex[symbol] = ++journalSymbolCount;
+    }
+    
+    index = journalIndex[symbol] - 1;
+    return true;
+}
+
+bool FileHandler::journalOrders(const OrderRecord* records, size_t count) {
+    if (count == 0) return true;
+    
+    // Tickers are listed before the records that refer to them
+    std::vector<OrderRecord> mapped(records, records + count);
+    for (OrderRecord& record : mapped) {
+        if (!mapJournalSymbol(record.symbolId, record.symbolId)) {
+            return false;
+        }
     }
     
+    std::ofstream file(getOrderJournalFilePath(), std::ios::binary | std::ios::app);
+    
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open order journal for writing." << std::endl;
+        return false;
+    }
+    
+    file.write(reinterpret_cast<const char*>(mapped.data()), count * sizeof(OrderRecord));
     file.close();
+    
     return true;
 }
+
+bool FileHandler::journalOrder(const OrderRecord& record) {
+    return journalOrders(&record, 1);
+}
+
+std::vector<OrderRecord> FileHandler::loadOrderJournal() {
+    std::vector<OrderRecord> records;
+    
+    std::ifstream file(getOrderJournalFilePath(), std::ios::binary);
+    if (!file.is_open()) {
+        return records;
+    }
+    
+    std::vector<std::string> tickers;
+    loadJournalSymbols(tickers);
+    
+    // A torn final record from an interrupted write is ignored, as is a
+    // record whose ticker never made it into the list
+    OrderRecord record;
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(OrderRecord))) {
+        if (record.symbolId >= tickers.size()) continue;
+        record.symbolId = SymbolTable::instance().intern(tickers[record.symbolId]);
+        records.push_back(record);
+    }
+    
+    file.close();
+    return records;
+}
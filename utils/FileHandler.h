@@ -5,6 +5,7 @@
 #include <vector>
 #include <memory>
 #include "../models/User.h"
+#include "../models/Order.h"
 #include "../services/TradingEngine.h"
 
 // FileHandler manages data persistence
@@ -15,7 +16,20 @@ private:
     // File paths
     std::string getUsersFilePath() const;
     std::string getStocksFilePath() const;
+    std::string getRiskLimitsFilePath() const;
     std::string getPortfolioFilePath(const std::string& username) const;
+    std::string getHistoryFilePath(const std::string& username) const;
+    std::string getOrderJournalFilePath() const;
+    std::string getJournalSymbolsFilePath() const;
+    
+    // Journal symbol index for each SymbolId (SymbolId -> index + 1, 0
+    // when the ticker is not in the journal yet), read on first use
+    std::vector<uint32_t> journalIndex;
+    uint32_t journalSymbolCount;
+    bool journalSymbolsLoaded;
+    
+    bool loadJournalSymbols(std::vector<std::string>& tickers) const;
+    bool mapJournalSymbol(SymbolId symbol, uint32_t& index);
 
 public:
     // Constructor
@@ -30,10 +44,33 @@ public:
     bool saveStocks(const TradingEngine& engine);
     bool loadStocks(TradingEngine& engine);
     
-    // Portfolio management
+    // Per-trader risk limits set by an admin
+    bool saveRiskLimits(const TradingEngine& engine);
+    bool loadRiskLimits(TradingEngine& engine);
+    
+    // Portfolio management. Loading also attaches the trader's history
+    // file, to which sealed transaction segments are spilled as they fill.
     bool savePortfolio(const Trader& trader);
     bool loadPortfolio(Trader& trader);
     
+    // Read a saved portfolio without attaching its history, e.g. for
+    // reports; false when the user has no portfolio file or it is empty
+    bool readPortfolio(const std::string& username, Portfolio& portfolio);
+    
+    // Read many traders' saved portfolios in parallel, one file per task
+    // on a work-stealing pool. A trader without a portfolio file keeps the
+    // one it has. Traders whose file exists but cannot be read are
+    // appended to `failed`; returns how many portfolios were read.
+    size_t readPortfolios(const std::vector<Trader*>& traders, std::vector<Trader*>& failed);
+    
+    // Order journal: OrderRecords appended in binary. SymbolIds are only
+    // meaningful within one process, so records carry an index into a
+    // ticker list kept beside the journal, appended to before any record
+    // that needs a new entry. Loading maps the indices back to SymbolIds.
+    bool journalOrders(const OrderRecord* records, size_t count);
+    bool journalOrder(const OrderRecord& record);
+    std::vector<OrderRecord> loadOrderJournal();
+    
     // Utility methods
     bool fileExists(const std::string& filepath) const;
     void ensureDataDirectory();
@@ -0,0 +1,103 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <cstdint>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+// Integer price in ticks of 1/10000 of a currency unit
+typedef int64_t Price;
+
+// Cash amounts on the same 1/10000 scale, so price * quantity is Money
+typedef int64_t Money;
+
+namespace FixedPoint {
+    const int64_t TICKS_PER_UNIT = 10000;
+    const int DECIMALS = 4;
+    
+    inline Price toTicks(double price) {
+        return static_cast<Price>(std::llround(price * TICKS_PER_UNIT));
+    }
+    
+    inline double toDouble(int64_t ticks) {
+        return static_cast<double>(ticks) / TICKS_PER_UNIT;
+    }
+    
+    inline Money fromUnits(int64_t units) {
+        return units * TICKS_PER_UNIT;
+    }
+    
+    inline Money notional(Price price, int64_t quantity) {
+        return price * quantity;
+    }
+    
+    // Integer division rounded half away from zero, e.g. an average price
+    inline int64_t divide(int64_t amount, int64_t divisor) {
+        if (divisor == 0) return 0;
+        if (divisor < 0) {
+            amount = -amount;
+            divisor = -divisor;
+        }
+        return amount >= 0 ? (amount + divisor / 2) / divisor
+                           : -((-amount + divisor / 2) / divisor);
+    }
+    
+    // Exact decimal text, e.g. 1234500 -> "123.4500"
+    inline std::string toString(int64_t ticks) {
+        char buffer[32];
+        uint64_t magnitude = ticks < 0 ? 0 - static_cast<uint64_t>(ticks)
+                                       : static_cast<uint64_t>(ticks);
+        std::snprintf(buffer, sizeof(buffer), "%s%llu.%04llu", ticks < 0 ? "-" : "",
+                      static_cast<unsigned long long>(magnitude / TICKS_PER_UNIT),
+                      static_cast<unsigned long long>(magnitude % TICKS_PER_UNIT));
+        return std::string(buffer);
+    }
+    
+    // Parses decimal text without going through floating point. Digits past
+    // the fourth decimal are rounded; exponent forms written by older
+    // versions fall back to strtod.
+    inline int64_t parse(const std::string& text) {
+        const char* p = text.c_str();
+        while (*p == ' ') p++;
+        
+        bool negative = (*p == '-');
+        if (*p == '-' || *p == '+') p++;
+        
+        int64_t units = 0;
+        while (*p >= '0' && *p <= '9') {
+            units = units * 10 + (*p++ - '0');
+        }
+        
+        int64_t fraction = 0;
+        int digits = 0;
+        bool roundUp = false;
+        if (*p == '.') {
+            p++;
+            while (*p >= '0' && *p <= '9') {
+                if (digits < DECIMALS) {
+                    fraction = fraction * 10 + (*p - '0');
+                    digits++;
+                } else if (digits == DECIMALS) {
+                    roundUp = (*p >= '5');
+                    digits++;
+                }
+                p++;
+            }
+        }
+        
+        if (*p == 'e' || *p == 'E') {
+            return toTicks(std::strtod(text.c_str(), nullptr));
+        }
+        
+        for (int i = digits; i < DECIMALS; i++) {
+            fraction *= 10;
+        }
+        
+        int64_t ticks = units * TICKS_PER_UNIT + fraction + (roundUp ? 1 : 0);
+        return negative ? -ticks : ticks;
+    }
+}
+
+#endif
@@ -0,0 +1,55 @@
+#include "OrderIdGenerator.h"
+#include <chrono>
+
+const unsigned OrderIdGenerator::SEQUENCE_BITS;
+const uint64_t OrderIdGenerator::SEQUENCE_MASK;
+const uint64_t OrderIdGenerator::BLOCK_SIZE;
+
+namespace {
+    // The calling thread's claimed block: [next, end)
+    struct SequenceBlock {
+        uint64_t next;
+        uint64_t end;
+    };
+    
+    thread_local SequenceBlock localBlock = {0, 0};
+}
+
+OrderIdGenerator::OrderIdGenerator() : node(0) {
+    using namespace std::chrono;
+    uint64_t micros = duration_cast<microseconds>(
+        system_clock::now().time_since_epoch()).count();
+    nextBlock.store(micros & SEQUENCE_MASK);
+}
+
+OrderIdGenerator& OrderIdGenerator::instance() {
+    static OrderIdGenerator generator;
+    return generator;
+}
+
+uint64_t OrderIdGenerator::next() {
+    if (localBlock.next == localBlock.end) {
+        localBlock.next = nextBlock.fetch_add(BLOCK_SIZE, std::memory_order_relaxed);
+        localBlock.end = localBlock.next + BLOCK_SIZE;
+    }
+    
+    uint64_t sequence = localBlock.next++ & SEQUENCE_MASK;
+    uint64_t prefix = static_cast<uint64_t>(node.load(std::memory_order_relaxed));
+    return (prefix << SEQUENCE_BITS) | sequence;
+}
+
+void OrderIdGenerator::setNode(uint8_t nodeId) {
+    node.store(nodeId, std::memory_order_relaxed);
+}
+
+uint8_t OrderIdGenerator::getNode() const {
+    return static_cast<uint8_t>(node.load(std::memory_order_relaxed));
+}
+
+uint8_t OrderIdGenerator::nodeOf(uint64_t id) {
+    return static_cast<uint8_t>(id >> SEQUENCE_BITS);
+}
+
+uint64_t OrderIdGenerator::sequenceOf(uint64_t id) {
+    return id & SEQUENCE_MASK;
+}
@@ -0,0 +1,41 @@
+#ifndef ORDER_ID_GENERATOR_H
+#define ORDER_ID_GENERATOR_H
+
+#include <atomic>
+#include <cstdint>
+
+// Process-wide source of 64-bit order ids: an 8-bit node prefix above a
+// 56-bit sequence. Threads claim sequence blocks with one atomic add and
+// hand ids out of their block without further synchronization, so ids
+// are unique across threads and strictly increasing within each thread.
+// The sequence starts at the current time in microseconds, which keeps
+// ids from a restarted process above those of the previous run.
+class OrderIdGenerator {
+public:
+    static const unsigned SEQUENCE_BITS = 56;
+    static const uint64_t SEQUENCE_MASK = (uint64_t(1) << SEQUENCE_BITS) - 1;
+    static const uint64_t BLOCK_SIZE = 1024;
+
+private:
+    std::atomic<uint64_t> nextBlock; // First sequence number not yet claimed
+    std::atomic<uint32_t> node;
+    
+    OrderIdGenerator();
+    OrderIdGenerator(const OrderIdGenerator&);
+    OrderIdGenerator& operator=(const OrderIdGenerator&);
+
+public:
+    static OrderIdGenerator& instance();
+    
+    // Lock-free; safe to call from any thread
+    uint64_t next();
+    
+    // Distinguishes ids minted by different processes or hosts
+    void setNode(uint8_t nodeId);
+    uint8_t getNode() const;
+    
+    static uint8_t nodeOf(uint64_t id);
+    static uint64_t sequenceOf(uint64_t id);
+};
+
+#endif
@@ -4,48 +4,53 @@
 
 PriceSimulator::PriceSimulator(double volatility, double drift)
     : gen(rd()), distribution(drift, volatility), 
-      volatility(volatility), drift(drift) {}
+      volatility(volatility), drift(drift), step(0) {}
 
-void PriceSimulator::simulatePriceChange(Stock& stock) {
-    double currentPrice = stock.getCurrentPrice();
-    
+Price PriceSimulator::nextPrice(Price currentPrice) {
     // Generate random price change percentage
     double changePercent = distribution(gen);
     
-    // Calculate new price
-    double newPrice = currentPrice * (1.0 + changePercent);
+    // Calculate new price, quantized to whole ticks
+    Price newPrice = FixedPoint::toTicks(FixedPoint::toDouble(currentPrice) * (1.0 + changePercent));
     
     // Ensure price doesn't go below a minimum threshold
-    if (newPrice < 1.0) {
-        newPrice = 1.0;
+    if (newPrice < FixedPoint::TICKS_PER_UNIT) {
+        newPrice = FixedPoint::TICKS_PER_UNIT;
     }
     
-    stock.setCurrentPrice(newPrice);
+    return newPrice;
 }
 
-void PriceSimulator::simulateMarket(std::map<std::string, Stock>& stocks) {
+void PriceSimulator::simulatePriceChange(Stock& stock) {
+    stock.setCurrentPrice(nextPrice(stock.getCurrentPrice()));
+}
+
+void PriceSimulator::simulateMarket(MarketDataStore& market) {
     std::cout << "\n=== Simulating Market Price Changes ===" << std::endl;
     
-    for (auto& pair : stocks) {
-        Stock& stock = pair.second;
-        double oldPrice = stock.getCurrentPrice();
+    for (size_t row = 0; row < market.size(); row++) {
+        Price oldPrice = market.getLastPrice(row);
+        Price newPrice = nextPrice(oldPrice);
         
-        simulatePriceChange(stock);
+        market.updatePrice(row, newPrice);
         
-        double newPrice = stock.getCurrentPrice();
-        double change = newPrice - oldPrice;
-        double changePercent = (change / oldPrice) * 100.0;
+        double changePercent = (static_cast<double>(newPrice - oldPrice) / oldPrice) * 100.0;
         
-        std::cout << stock.getSymbol() << ": $" 
-                  << std::fixed << std::setprecision(2) << oldPrice
-                  << " -> $" << newPrice
+        std::cout << market.getSymbol(row) << ": $" 
+                  << std::fixed << std::setprecision(2) << FixedPoint::toDouble(oldPrice)
+                  << " -> $" << FixedPoint::toDouble(newPrice)
                   << " (" << std::showpos << changePercent << std::noshowpos << "%)" 
                   << std::endl;
     }
     
+    step++;
     std::cout << "Market update complete." << std::endl;
 }
 
+uint64_t PriceSimulator::getStep() const {
+    return step;
+}
+
 void PriceSimulator::setVolatility(double vol) {
     volatility = vol;
     distribution = std::normal_distribution<double>(drift, volatility);
@@ -56,40 +61,40 @@ void PriceSimulator::setDrift(double d) {
     distribution = std::normal_distribution<double>(drift, volatility);
 }
 
-void PriceSimulator::simulateBullMarket(std::map<std::string, Stock>& stocks) {
+void PriceSimulator::simulateBullMarket(MarketDataStore& market) {
     std::cout << "\n=== Simulating BULL MARKET (Upward Trend) ===" << std::endl;
     
     // Temporarily increase drift for positive trend
     double originalDrift = drift;
     setDrift(0.03); // 3% average increase
     
-    simulateMarket(stocks);
+    simulateMarket(market);
     
     // Restore original drift
     setDrift(originalDrift);
 }
 
-void PriceSimulator::simulateBearMarket(std::map<std::string, Stock>& stocks) {
+void PriceSimulator::simulateBearMarket(MarketDataStore& market) {
     std::cout << "\n=== Simulating BEAR MARKET (Downward Trend) ===" << std::endl;
     
     // Temporarily decrease drift for negative trend
     double originalDrift = drift;
     setDrift(-0.03); // 3% average decrease
     
-    simulateMarket(stocks);
+    simulateMarket(market);
     
     // Restore original drift
     setDrift(originalDrift);
 }
 
-void PriceSimulator::simulateVolatileMarket(std::map<std::string, Stock>& stocks) {
+void PriceSimulator::simulateVolatileMarket(MarketDataStore& market) {
     std::cout << "\n=== Simulating VOLATILE MARKET (High Fluctuation) ===" << std::endl;
     
     // Temporarily increase volatility
     double originalVolatility = volatility;
     setVolatility(0.05); // 5% standard deviation
     
-    simulateMarket(stocks);
+    simulateMarket(market);
     
     // Restore original volatility
     setVolatility(originalVolatility);
@@ -2,8 +2,9 @@
 #define PRICE_SIMULATOR_H
 
 #include <random>
-#include <map>
+#include <cstdint>
 #include "../models/Stock.h"
+#include "../services/MarketDataStore.h"
 
 // PriceSimulator simulates realistic stock price movements
 class PriceSimulator {
@@ -14,6 +15,9 @@ private:
     
     double volatility;  // Standard deviation of price changes
     double drift;       // Average price drift (positive = upward trend)
+    uint64_t step;      // Market updates simulated so far: the simulation clock
+    
+    Price nextPrice(Price currentPrice);
 
 public:
     // Constructor
@@ -23,16 +27,19 @@ public:
     void simulatePriceChange(Stock& stock);
     
     // Simulate price changes for all stocks
-    void simulateMarket(std::map<std::string, Stock>& stocks);
+    void simulateMarket(MarketDataStore& market);
+    
+    // Simulation clock, advanced by one per market update
+    uint64_t getStep() const;
     
     // Setters
     void setVolatility(double vol);
     void setDrift(double d);
     
     // Simulate specific scenarios
-    void simulateBullMarket(std::map<std::string, Stock>& stocks);
-    void simulateBearMarket(std::map<std::string, Stock>& stocks);
-    void simulateVolatileMarket(std::map<std::string, Stock>& stocks);
+    void simulateBullMarket(MarketDataStore& market);
+    void simulateBearMarket(MarketDataStore& market);
+    void simulateVolatileMarket(MarketDataStore& market);
 };
 
 #endif
@@ -0,0 +1,159 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <vector>
+#include <cstddef>
+#include <iterator>
+
+// Read-only view over a circular block of values, ordered oldest -> newest.
+// Does not own the storage; used to hand out price history without copying.
+template <typename T>
+class RingView {
+private:
+    const T* data;
+    size_t capacity;
+    size_t head;   // Physical index of the oldest element
+    size_t count;
+
+public:
+    class const_iterator {
+    private:
+        const T* data;
+        size_t capacity;
+        size_t head;
+        size_t index;
+
+        const T& at(size_t i) const {
+            size_t pos = head + i;
+            if (pos >= capacity) pos -= capacity;
+            return data[pos];
+        }
+
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const T* pointer;
+        typedef const T& reference;
+
+        const_iterator() : data(nullptr), capacity(0), head(0), index(0) {}
+        const_iterator(const T* data, size_t capacity, size_t head, size_t index)
+            : data(data), capacity(capacity), head(head), index(index) {}
+
+        reference operator*() const { return at(index); }
+        pointer operator->() const { return &at(index); }
+        reference operator[](difference_type n) const { return at(index + n); }
+
+        const_iterator& operator++() { ++index; return *this; }
+        const_iterator operator++(int) { const_iterator tmp(*this); ++index; return tmp; }
+        const_iterator& operator--() { --index; return *this; }
+        const_iterator operator--(int) { const_iterator tmp(*this); --index; return tmp; }
+        const_iterator& operator+=(difference_type n) { index += n; return *this; }
+        const_iterator& operator-=(difference_type n) { index -= n; return *this; }
+        const_iterator operator+(difference_type n) const { return const_iterator(data, capacity, head, index + n); }
+        const_iterator operator-(difference_type n) const { return const_iterator(data, capacity, head, index - n); }
+        difference_type operator-(const const_iterator& other) const {
+            return static_cast<difference_type>(index) - static_cast<difference_type>(other.index);
+        }
+
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+        bool operator<(const const_iterator& other) const { return index < other.index; }
+        bool operator>(const const_iterator& other) const { return index > other.index; }
+        bool operator<=(const const_iterator& other) const { return index <= other.index; }
+        bool operator>=(const const_iterator& other) const { return index >= other.index; }
+    };
+
+    RingView() : data(nullptr), capacity(0), head(0), count(0) {}
+    RingView(const T* data, size_t capacity, size_t head, size_t count)
+        : data(data), capacity(capacity), head(head), count(count) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Logical index: 0 is the oldest element, size() - 1 the newest
+    const T& operator[](size_t i) const {
+        size_t pos = head + i;
+        if (pos >= capacity) pos -= capacity;
+        return data[pos];
+    }
+
+    const T& front() const { return (*this)[0]; }
+    const T& back() const { return (*this)[count - 1]; }
+
+    const_iterator begin() const { return const_iterator(data, capacity, head, 0); }
+    const_iterator end() const { return const_iterator(data, capacity, head, count); }
+};
+
+// Fixed-capacity circular buffer. Pushing into a full buffer overwrites the
+// oldest element in O(1) instead of shifting the remaining elements.
+template <typename T>
+class RingBuffer {
+private:
+    std::vector<T> storage;
+    size_t head;
+    size_t count;
+
+public:
+    typedef typename RingView<T>::const_iterator const_iterator;
+
+    explicit RingBuffer(size_t capacity = 1)
+        : storage(capacity > 0 ? capacity : 1), head(0), count(0) {}
+
+    size_t size() const { return count; }
+    size_t capacity() const { return storage.size(); }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == storage.size(); }
+
+    void push_back(const T& value) {
+        size_t cap = storage.size();
+        if (count < cap) {
+            size_t pos = head + count;
+            if (pos >= cap) pos -= cap;
+            storage[pos] = value;
+            ++count;
+        } else {
+            storage[head] = value;
+            if (++head == cap) head = 0;
+        }
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+    }
+
+    // Resize the buffer, keeping the newest elements that still fit
+    void setCapacity(size_t newCapacity) {
+        if (newCapacity == 0) newCapacity = 1;
+        if (newCapacity == storage.size()) return;
+
+        size_t keep = count < newCapacity ? count : newCapacity;
+        std::vector<T> resized(newCapacity);
+        for (size_t i = 0; i < keep; i++) {
+            resized[i] = (*this)[count - keep + i];
+        }
+
+        storage.swap(resized);
+        head = 0;
+        count = keep;
+    }
+
+    const T& operator[](size_t i) const {
+        size_t pos = head + i;
+        if (pos >= storage.size()) pos -= storage.size();
+        return storage[pos];
+    }
+
+    const T& front() const { return (*this)[0]; }
+    const T& back() const { return (*this)[count - 1]; }
+
+    const_iterator begin() const { return view().begin(); }
+    const_iterator end() const { return view().end(); }
+
+    RingView<T> view() const {
+        return RingView<T>(storage.data(), storage.size(), head, count);
+    }
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef ROLLING_WINDOW_H
+#define ROLLING_WINDOW_H
+
+#include <cstddef>
+#include "RingBuffer.h"
+
+// Running sum and sum of squares over the newest `period` prices of a
+// history buffer, so mean/variance queries cost O(1) instead of O(period).
+struct RollingWindow {
+    // Sums are rebuilt from the history this often to discard float drift
+    static const unsigned REBUILD_INTERVAL = 1024;
+
+    int period;          // Requested window length
+    size_t span;         // Effective length, limited by the history depth
+    double sum;
+    double sumSq;
+    unsigned updatesSinceRebuild;
+
+    explicit RollingWindow(int period = 1, size_t historyDepth = 1)
+        : period(period), span(0), sum(0.0), sumSq(0.0), updatesSinceRebuild(0) {
+        setDepth(historyDepth);
+    }
+
+    void setDepth(size_t historyDepth) {
+        size_t requested = period > 0 ? static_cast<size_t>(period) : 1;
+        span = requested < historyDepth ? requested : historyDepth;
+    }
+
+    // Must be called before `price` is appended to `history`
+    void push(double price, const RingView<double>& history) {
+        sum += price;
+        sumSq += price * price;
+
+        // The window is full, so its oldest price slides out
+        if (history.size() >= span) {
+            double leaving = history[history.size() - span];
+            sum -= leaving;
+            sumSq -= leaving * leaving;
+        }
+
+        ++updatesSinceRebuild;
+    }
+
+    // Recompute the sums exactly from the current history
+    void rebuild(const RingView<double>& history) {
+        sum = 0.0;
+        sumSq = 0.0;
+        size_t n = count(history.size());
+        for (size_t i = history.size() - n; i < history.size(); i++) {
+            sum += history[i];
+            sumSq += history[i] * history[i];
+        }
+        updatesSinceRebuild = 0;
+    }
+
+    bool needsRebuild() const {
+        return updatesSinceRebuild >= REBUILD_INTERVAL;
+    }
+
+    // Number of prices currently inside the window
+    size_t count(size_t historySize) const {
+        return historySize < span ? historySize : span;
+    }
+
+    double mean(size_t historySize) const {
+        size_t n = count(historySize);
+        return n > 0 ? sum / n : 0.0;
+    }
+
+    double variance(size_t historySize) const {
+        size_t n = count(historySize);
+        if (n == 0) return 0.0;
+        double m = sum / n;
+        double var = sumSq / n - m * m;
+        return var > 0.0 ? var : 0.0;
+    }
+};
+
+#endif
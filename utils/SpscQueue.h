@@ -0,0 +1,86 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Capacity is rounded up to a power of two so indices wrap with a
+// mask. Head and tail live on separate cache lines, and each side caches
+// the other's index so a push or pop touches shared state only when the
+// cached view says the queue looks full or empty.
+template <typename T>
+class SpscQueue {
+private:
+    static const size_t CACHE_LINE = 64;
+    
+    std::vector<T> slots;
+    size_t mask;
+    
+    // Padding keeps the consumer's and producer's indices off each other's
+    // cache line without relying on over-aligned allocation
+    char padHead[CACHE_LINE];
+    std::atomic<size_t> head; // Next slot to pop
+    size_t cachedTail;        // Consumer's view of tail
+    
+    char padTail[CACHE_LINE];
+    std::atomic<size_t> tail; // Next slot to push
+    size_t cachedHead;        // Producer's view of head
+    char padEnd[CACHE_LINE];
+    
+    SpscQueue(const SpscQueue&);
+    SpscQueue& operator=(const SpscQueue&);
+    
+    static size_t roundUp(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        return size;
+    }
+
+public:
+    explicit SpscQueue(size_t capacity = 1024)
+        : slots(roundUp(capacity)), mask(roundUp(capacity) - 1),
+          head(0), cachedTail(0), tail(0), cachedHead(0) {}
+    
+    // Producer side. Returns false when the queue is full.
+    bool tryPush(const T& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead > mask) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead > mask) return false;
+        }
+        
+        slots[t & mask] = value;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Consumer side. Returns false when the queue is empty.
+    bool tryPop(T& value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return false;
+        }
+        
+        value = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Approximate when called while the other side is active
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+    
+    bool empty() const {
+        return size() == 0;
+    }
+    
+    size_t capacity() const {
+        return mask + 1;
+    }
+};
+
+#endif
@@ -0,0 +1,41 @@
+#include "SymbolTable.h"
+
+SymbolTable::SymbolTable() {}
+
+SymbolTable& SymbolTable::instance() {
+    static SymbolTable table;
+    return table;
+}
+
+SymbolId SymbolTable::intern(const std::string& symbol) {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    auto it = ids.find(symbol);
+    if (it != ids.end()) {
+        return it->second;
+    }
+    
+    SymbolId id = static_cast<SymbolId>(names.size());
+    names.push_back(symbol);
+    ids[symbol] = id;
+    return id;
+}
+
+SymbolId SymbolTable::find(const std::string& symbol) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    auto it = ids.find(symbol);
+    return it != ids.end() ? it->second : INVALID_SYMBOL;
+}
+
+const std::string& SymbolTable::name(SymbolId id) const {
+    static const std::string unknown = "?";
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    return id < names.size() ? names[id] : unknown;
+}
+
+size_t SymbolTable::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return names.size();
+}
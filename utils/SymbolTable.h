@@ -0,0 +1,43 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+// Dense integer handle for an interned ticker symbol
+typedef uint32_t SymbolId;
+const SymbolId INVALID_SYMBOL = static_cast<SymbolId>(-1);
+
+// Process-wide symbol table. Tickers are interned once at the I/O edges
+// (user input, file loading) and every hot path keys on the SymbolId.
+// Ids are assigned 0, 1, 2, ... so they can index plain vectors.
+class SymbolTable {
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, SymbolId> ids;
+    std::deque<std::string> names; // Deque keeps references stable on growth
+    
+    SymbolTable();
+    SymbolTable(const SymbolTable&);
+    SymbolTable& operator=(const SymbolTable&);
+
+public:
+    static SymbolTable& instance();
+    
+    // Returns the id for a symbol, assigning a new one on first use
+    SymbolId intern(const std::string& symbol);
+    
+    // Returns INVALID_SYMBOL when the symbol was never interned
+    SymbolId find(const std::string& symbol) const;
+    
+    // Ticker text for display and serialization
+    const std::string& name(SymbolId id) const;
+    
+    size_t size() const;
+};
+
+#endif
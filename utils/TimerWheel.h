@@ -0,0 +1,138 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Hashed timer wheel. Timers hash into one of `SLOTS` buckets by expiry
+// tick; advancing the clock visits only the buckets for the ticks that
+// passed, so scheduling and cancelling are O(1) and firing costs O(due
+// timers) plus one bucket per elapsed tick (capped at one revolution).
+// Timers further out than one revolution stay in their bucket until due.
+class TimerWheel {
+public:
+    static const uint32_t NONE = static_cast<uint32_t>(-1);
+    static const size_t SLOTS = 256;
+
+private:
+    struct Timer {
+        uint64_t expiry;
+        uint32_t payload;
+        uint32_t prev;
+        uint32_t next;
+        uint32_t generation; // Bumped on reuse so stale ids never cancel
+        bool armed;
+    };
+    
+    std::vector<Timer> timers;
+    std::vector<uint32_t> freeTimers;
+    uint32_t buckets[SLOTS];
+    uint64_t now;
+    size_t armedCount;
+    
+    void link(uint32_t index) {
+        uint32_t& head = buckets[timers[index].expiry % SLOTS];
+        timers[index].prev = NONE;
+        timers[index].next = head;
+        if (head != NONE) timers[head].prev = index;
+        head = index;
+    }
+    
+    void unlink(uint32_t index) {
+        Timer& timer = timers[index];
+        if (timer.prev != NONE) {
+            timers[timer.prev].next = timer.next;
+        } else {
+            buckets[timer.expiry % SLOTS] = timer.next;
+        }
+        if (timer.next != NONE) timers[timer.next].prev = timer.prev;
+        
+        timer.armed = false;
+        timer.generation++;
+        freeTimers.push_back(index);
+        armedCount--;
+    }
+
+public:
+    explicit TimerWheel(uint64_t start = 0) : now(start), armedCount(0) {
+        for (size_t i = 0; i < SLOTS; i++) buckets[i] = NONE;
+    }
+    
+    // Fire `payload` once the clock reaches `expiry` (at the next advance
+    // when it is already in the past). Returns an id for cancel(); ids
+    // are never 0.
+    uint64_t schedule(uint64_t expiry, uint32_t payload) {
+        if (expiry <= now) expiry = now + 1;
+        
+        uint32_t index;
+        if (!freeTimers.empty()) {
+            index = freeTimers.back();
+            freeTimers.pop_back();
+        } else {
+            timers.push_back(Timer());
+            timers.back().generation = 1;
+            index = static_cast<uint32_t>(timers.size() - 1);
+        }
+        
+        Timer& timer = timers[index];
+        timer.expiry = expiry;
+        timer.payload = payload;
+        timer.armed = true;
+        link(index);
+        armedCount++;
+        
+        return (static_cast<uint64_t>(timer.generation) << 32) | index;
+    }
+    
+    bool cancel(uint64_t id) {
+        uint32_t index = static_cast<uint32_t>(id);
+        if (index >= timers.size()) return false;
+        
+        Timer& timer = timers[index];
+        if (!timer.armed || timer.generation != static_cast<uint32_t>(id >> 32)) return false;
+        
+        unlink(index);
+        return true;
+    }
+    
+    // Move the clock to `time`, appending the payload of every timer that
+    // came due; returns how many fired
+    size_t advance(uint64_t time, std::vector<uint32_t>& expired) {
+        if (time <= now) return 0;
+        
+        size_t fired = 0;
+        uint64_t elapsed = time - now;
+        size_t visits = elapsed < SLOTS ? static_cast<size_t>(elapsed) : SLOTS;
+        
+        for (size_t step = 1; step <= visits; step++) {
+            uint32_t index = buckets[(now + step) % SLOTS];
+            while (index != NONE) {
+                uint32_t next = timers[index].next;
+                if (timers[index].expiry <= time) {
+                    expired.push_back(timers[index].payload);
+                    unlink(index);
+                    fired++;
+                }
+                index = next;
+            }
+        }
+        
+        now = time;
+        return fired;
+    }
+    
+    uint64_t getTime() const {
+        return now;
+    }
+    
+    size_t size() const {
+        return armedCount;
+    }
+    
+    bool empty() const {
+        return armedCount == 0;
+    }
+};
+
+#endif
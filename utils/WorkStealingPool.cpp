@@ -0,0 +1,115 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(size_t threadCount)
+    : body(nullptr), generation(0), busy(0), stopping(false), steals(0) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    
+    for (size_t i = 0; i < threadCount; i++) {
+        workers.push_back(std::unique_ptr<Worker>(new Worker()));
+    }
+    for (size_t i = 1; i < threadCount; i++) {
+        threads.push_back(std::thread(&WorkStealingPool::runHelper, this, i));
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    started.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+bool WorkStealingPool::take(size_t worker, size_t& task) {
+    {
+        Worker& own = *workers[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    
+    for (size_t i = 1; i < workers.size(); i++) {
+        Worker& victim = *workers[(worker + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::work(size_t worker) {
+    // Tasks never add tasks, so every queue being empty means the batch
+    // has nothing left to start
+    size_t task;
+    while (take(worker, task)) {
+        (*body)(task, worker);
+    }
+}
+
+void WorkStealingPool::runHelper(size_t worker) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            started.wait(lock, [this, seen]() { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        
+        work(worker);
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0) {
+            finished.notify_one();
+        }
+    }
+}
+
+void WorkStealingPool::run(size_t taskCount, const Task& task) {
+    if (taskCount == 0) return;
+    
+    size_t count = workers.size();
+    for (size_t w = 0; w < count; w++) {
+        Worker& worker = *workers[w];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        for (size_t t = w * taskCount / count; t < (w + 1) * taskCount / count; t++) {
+            worker.tasks.push_back(t);
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        body = &task;
+        busy = threads.size();
+        generation++;
+    }
+    started.notify_all();
+    
+    work(0);
+    
+    // Helpers finishing their last task publish its results under `mutex`
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]() { return busy == 0; });
+    body = nullptr;
+}
+
+size_t WorkStealingPool::getThreadCount() const {
+    return workers.size();
+}
+
+uint64_t WorkStealingPool::getStealCount() const {
+    return steals.load(std::memory_order_relaxed);
+}
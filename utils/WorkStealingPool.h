@@ -0,0 +1,66 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// Fixed set of worker threads that runs batches of independent tasks.
+// run() deals a batch's task indices out to the workers in contiguous
+// chunks. Each worker takes its own tasks in order from the front of its
+// queue; once that is empty it steals from the back of another worker's
+// queue, so uneven tasks balance without a shared queue and owner and
+// thief rarely contend for the same end. The calling thread works as
+// worker 0, so a pool of one thread runs everything inline.
+class WorkStealingPool {
+public:
+    typedef std::function<void(size_t task, size_t worker)> Task;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+    
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    
+    // Batch state, guarded by `mutex`
+    std::mutex mutex;
+    std::condition_variable started;
+    std::condition_variable finished;
+    const Task* body;
+    uint64_t generation; // Bumped for every batch
+    size_t busy;         // Helper threads still working on the batch
+    bool stopping;
+    
+    std::atomic<uint64_t> steals;
+    
+    bool take(size_t worker, size_t& task);
+    void work(size_t worker);
+    void runHelper(size_t worker);
+
+public:
+    // `threads` 0 uses one worker per hardware thread
+    explicit WorkStealingPool(size_t threads = 0);
+    ~WorkStealingPool();
+    
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    
+    // Run task(t, worker) for every t in [0, taskCount) and return once
+    // all have finished. Tasks must not call run() on the same pool.
+    void run(size_t taskCount, const Task& task);
+    
+    size_t getThreadCount() const;
+    uint64_t getStealCount() const; // Tasks run by a worker other than the one dealt them
+};
+
+#endif